@@ -0,0 +1,54 @@
+/*
+ * Two threads pass a token back and forth through a mutex and a condition
+ * variable. Under lotto every pass is a handoff in the switcher, so the time
+ * per pass approximates the cost of a switch between tasks.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _cond   = PTHREAD_COND_INITIALIZER;
+static long _turn;
+static long _passes;
+
+static void *
+_player(void *arg)
+{
+    long me = (long)arg;
+    pthread_mutex_lock(&_mutex);
+    for (long i = 0; i < _passes; i++) {
+        while (_turn % 2 != me) {
+            pthread_cond_wait(&_cond, &_mutex);
+        }
+        _turn++;
+        pthread_cond_signal(&_cond);
+    }
+    pthread_mutex_unlock(&_mutex);
+    return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+    _passes = argc > 1 ? atol(argv[1]) : 10000;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t t[2];
+    for (long i = 0; i < 2; i++) {
+        pthread_create(&t[i], NULL, _player, (void *)i);
+    }
+    for (long i = 0; i < 2; i++) {
+        pthread_join(t[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = (double)(end.tv_sec - start.tv_sec) * 1e9 +
+                (double)(end.tv_nsec - start.tv_nsec);
+    printf("handoffs: %ld, ns/handoff: %.0f\n", 2 * _passes,
+           ns / (double)(2 * _passes));
+    return 0;
+}
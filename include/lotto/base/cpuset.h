@@ -0,0 +1,59 @@
+/**
+ * @file cpuset.h
+ * @brief Base declarations for spreading work over physical cores.
+ */
+#ifndef LOTTO_CPUSET_H
+#define LOTTO_CPUSET_H
+
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct cpu_order {
+    int cpu;
+    uint32_t core; /* index of the physical core, in order of first use */
+} cpu_order_t;
+
+/**
+ * Physical core of a CPU. CPUs sharing a core return the same key.
+ */
+typedef uint64_t(cpu_core_f)(int cpu);
+
+/**
+ * Physical core of `cpu` according to the sysfs topology, or a key of its own
+ * if the topology is unknown.
+ */
+uint64_t cpuset_core(int cpu);
+
+/**
+ * Lists the CPUs of `set` so that one CPU of every physical core comes before
+ * any of their SMT siblings.
+ *
+ * @param set CPUs to list
+ * @param core_of physical core of a CPU, eg, cpuset_core
+ * @param order array of at least CPU_COUNT(set) entries
+ * @return number of entries written to `order`
+ */
+size_t cpuset_spread(const cpu_set_t *set, cpu_core_f *core_of,
+                     cpu_order_t *order);
+
+/**
+ * Selects the CPUs of `job` out of `jobs`.
+ *
+ * With at most as many jobs as physical cores, every job gets a contiguous
+ * share of the cores with all their SMT siblings. Otherwise every job gets a
+ * single CPU, round-robin, with the first jobs on distinct cores.
+ *
+ * @param order CPUs listed by cpuset_spread
+ * @param n number of entries in `order`
+ * @param job index of the job in [0, jobs)
+ * @param jobs number of jobs
+ * @param mine CPUs of the job
+ */
+void cpuset_job(const cpu_order_t *order, size_t n, uint64_t job,
+                uint64_t jobs, cpu_set_t *mine);
+
+#endif
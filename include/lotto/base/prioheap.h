@@ -0,0 +1,130 @@
+/**
+ * @file prioheap.h
+ * @brief Base declarations for prioheap, an indexed max-heap of tasks.
+ *
+ * Nodes are embedded in the caller's task objects (e.g., tidmap items), so
+ * a priority change is an O(log n) sift instead of a full resort. The heap
+ * orders nodes by descending effective priority and then by ascending task
+ * id, which matches the order strategies used to obtain with tidset_sort().
+ *
+ * The effective priority of a node is `prio * mult^(epoch - node.epoch)`,
+ * where `epoch` is the heap epoch. prioheap_decay() therefore scales all
+ * priorities in O(1): relative order is preserved by construction and nodes
+ * are only rebased when their priority is next set.
+ */
+#ifndef LOTTO_PRIOHEAP_H
+#define LOTTO_PRIOHEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lotto/base/task_id.h>
+#include <lotto/base/tidset.h>
+
+#define PRIOHEAP_NONE ((size_t)-1)
+
+typedef struct prionode {
+    uint64_t prio;
+    uint64_t epoch;
+    task_id id;
+    size_t pos;
+} prionode_t;
+
+typedef struct prioheap {
+    prionode_t **nodes;
+    size_t size;
+    size_t capacity;
+    uint64_t mult;
+    uint64_t epoch;
+
+    /* scratch buffer of prioheap_first_in() */
+    size_t *frontier;
+} prioheap_t;
+
+/**
+ * Initializes an empty heap.
+ *
+ * @param heap heap object
+ * @param mult multiplier applied to all priorities by prioheap_decay()
+ */
+void prioheap_init(prioheap_t *heap, uint64_t mult);
+
+/**
+ * Releases the heap buffers. Nodes are owned by the caller.
+ *
+ * @param heap heap object
+ */
+void prioheap_fini(prioheap_t *heap);
+
+/**
+ * Inserts a node with task id and priority.
+ *
+ * @param heap heap object
+ * @param node node not currently in any heap
+ * @param id task id
+ * @param prio initial priority
+ */
+void prioheap_insert(prioheap_t *heap, prionode_t *node, task_id id,
+                     uint64_t prio);
+
+/**
+ * Removes a node from the heap.
+ *
+ * @param heap heap object
+ * @param node node currently in the heap
+ */
+void prioheap_remove(prioheap_t *heap, prionode_t *node);
+
+/**
+ * Sets the priority of a node and restores the heap order.
+ *
+ * @param heap heap object
+ * @param node node currently in the heap
+ * @param prio new priority (in the current epoch)
+ */
+void prioheap_update(prioheap_t *heap, prionode_t *node, uint64_t prio);
+
+/**
+ * Returns the effective priority of a node, saturated to UINT64_MAX.
+ *
+ * @param heap heap object
+ * @param node node currently in the heap
+ */
+uint64_t prioheap_prio(const prioheap_t *heap, const prionode_t *node);
+
+/**
+ * Multiplies every priority in the heap by the heap multiplier in O(1).
+ *
+ * @param heap heap object
+ */
+void prioheap_decay(prioheap_t *heap);
+
+/**
+ * Returns the number of nodes in the heap.
+ *
+ * @param heap heap object
+ */
+size_t prioheap_size(const prioheap_t *heap);
+
+/**
+ * Returns the node with the highest priority or NULL if the heap is empty.
+ *
+ * @param heap heap object
+ */
+prionode_t *prioheap_top(const prioheap_t *heap);
+
+/**
+ * Returns the highest-priority node whose task id is in `tset`.
+ *
+ * Nodes are visited best-first from the root, so only the higher-priority
+ * nodes not in `tset` are visited before the result, not the whole heap. Each
+ * visit is a tidset_has() lookup; `tset` is neither copied nor sorted.
+ *
+ * @param heap heap object
+ * @param tset candidate task ids
+ * @return the selected node or NULL if no node matches
+ */
+prionode_t *prioheap_first_in(prioheap_t *heap, const tidset_t *tset);
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file trace_footer.h
+ * @brief Base declarations for the trace footer index.
+ *
+ * A sealed trace file ends with a footer record of kind RECORD_NONE, which no
+ * record filter selects, so readers that scan the trace skip it. Its payload
+ * is a sparse clk→offset index followed by a fixed-size trailer, so the
+ * trailer is always the last bytes of the file. Readers find the EXIT record
+ * and seek close to a clock without scanning the whole trace.
+ */
+#ifndef LOTTO_TRACE_FOOTER_H
+#define LOTTO_TRACE_FOOTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lotto/base/clk.h>
+#include <lotto/base/record.h>
+#include <lotto/sys/stream.h>
+
+#define TRACE_FOOTER_MAGIC   0x3152544654544cULL /* "LTTFTR1" */
+#define TRACE_FOOTER_NO_EXIT UINT64_MAX
+#define TRACE_INDEX_CAPACITY 512
+
+typedef struct trace_index_entry_s {
+    clk_t clk;
+    uint64_t offset;
+} trace_index_entry_t;
+
+typedef struct trace_footer_s {
+    uint64_t exit_offset; /**< Offset of the EXIT record or NO_EXIT. */
+    uint64_t last_offset; /**< Offset of the last record. */
+    uint64_t count;       /**< Number of records before the footer. */
+    clk_t clk_min;        /**< Smallest record clock. */
+    clk_t clk_max;        /**< Largest record clock. */
+    uint64_t index_len;   /**< Index entries preceding the trailer. */
+    uint64_t magic;       /**< TRACE_FOOTER_MAGIC. */
+} trace_footer_t;
+
+/**
+ * Footer state collected while a trace is written.
+ *
+ * The index has a fixed capacity. When it fills up, every other entry is
+ * dropped and the stride doubles, so the entries stay evenly spread over the
+ * trace. Nothing is allocated after initialization, which keeps indexing safe
+ * in signal handlers.
+ */
+typedef struct trace_index_s {
+    uint64_t offset; /**< Bytes written so far. */
+    uint64_t stride; /**< Records between two index entries. */
+    trace_footer_t footer;
+    trace_index_entry_t entries[TRACE_INDEX_CAPACITY];
+} trace_index_t;
+
+/**
+ * Resets the index of an empty trace.
+ */
+void trace_index_init(trace_index_t *ix);
+
+/**
+ * Accounts for a record about to be written at the current offset.
+ */
+void trace_index_add(trace_index_t *ix, const record_t *r);
+
+/**
+ * Writes the footer record to the stream.
+ *
+ * @returns false if the stream refused a write
+ */
+bool trace_index_seal(trace_index_t *ix, stream_t *stream);
+
+typedef struct trace_reader_s trace_reader_t;
+
+/**
+ * Opens a sealed trace file.
+ *
+ * @param fn trace file name
+ * @returns a reader or NULL if the file has no valid footer
+ */
+trace_reader_t *trace_reader_open(const char *fn);
+
+/**
+ * Returns the footer of the trace.
+ */
+const trace_footer_t *trace_reader_footer(const trace_reader_t *tr);
+
+/**
+ * Reads the last record of the trace.
+ *
+ * @returns a record owned by the caller or NULL if the trace is empty
+ */
+record_t *trace_reader_last(trace_reader_t *tr);
+
+/**
+ * Positions the reader at the last indexed record whose clock is smaller than
+ * `clk`, or at the first record. Scanning from there reaches every record
+ * with a clock of at least `clk`.
+ */
+void trace_reader_seek(trace_reader_t *tr, clk_t clk);
+
+/**
+ * Reads the record at the current position and advances.
+ *
+ * @returns a record owned by the caller or NULL at the end of the trace
+ */
+record_t *trace_reader_next(trace_reader_t *tr);
+
+/**
+ * Closes the reader.
+ */
+void trace_reader_close(trace_reader_t *tr);
+
+#endif
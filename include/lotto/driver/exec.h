@@ -5,6 +5,8 @@
 #ifndef LOTTO_DRIVER_EXEC_H
 #define LOTTO_DRIVER_EXEC_H
 
+#include <stddef.h>
+
 #include <lotto/base/flags.h>
 #include <lotto/driver/args.h>
 
@@ -21,6 +23,10 @@ void execute_set_command_prefix(exec_command_prefix_f *prefix);
 void execute_set_replay_args_resolver(exec_replay_args_resolver_f *resolver);
 /** Set or clear stdin-detach hook used by `execute()`. */
 void execute_set_stdin_devnull(exec_stdin_devnull_f *hook);
+/** Keep the last `len` bytes of the child's output in memory (0 disables). */
+void execute_set_output_tail(size_t len);
+/** Copy up to `cap` bytes of the output tail of the last `execute()`. */
+size_t execute_output_tail(char *buf, size_t cap);
 /** Resolve replay args through the currently registered replay hook. */
 void execute_resolve_replay_args(args_t *args, const flags_t *flags);
 /** Spawn and supervise a command according to current driver settings. */
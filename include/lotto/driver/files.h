@@ -13,6 +13,8 @@ typedef struct driver_file_s {
     unsigned int len;
 } driver_file_t;
 
+/* Writes each file into `dir` unless a stamp shows that the same content was
+ * already written there. */
 bool driver_try_dump_files(const char *dir, const driver_file_t files[]);
 void driver_dump_files(const char *dir, const driver_file_t files[]);
 
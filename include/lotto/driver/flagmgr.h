@@ -138,6 +138,8 @@ flag_t flag_no_preload();
 flag_t flag_before_run();
 flag_t flag_after_run();
 flag_t flag_logger_file();
+flag_t flag_logger_binary();
+flag_t flag_jobs();
 
 static inline uint64_t
 flag_verbose_count(const flags_t *flags)
@@ -272,6 +274,10 @@ flag_verbose_logger_level_str(const flags_t *flags)
     DECLARE_COMMAND_FLAG(ROUNDS, "r", "rounds", "INT",                         \
                          "maximum number of rounds", flag_uval(MAX_ROUNDS))
 
+#define DECLARE_FLAG_JOBS                                                      \
+    DECLARE_COMMAND_FLAG(JOBS, "j", "jobs", "INT",                             \
+                         "number of rounds to run concurrently", flag_uval(1))
+
 #define DECLARE_FLAG_VERBOSE                                                   \
     DECLARE_COMMAND_FLAG(VERBOSE, "v", "verbose", "",                          \
                          "increase verbosity (repeat for more detail)",        \
@@ -285,6 +291,11 @@ flag_verbose_logger_level_str(const flags_t *flags)
     DECLARE_COMMAND_FLAG(LOGGER_FILE, "", "log", "FILE", "output log FILE",    \
                          flag_sval("stderr"))
 
+#define DECLARE_FLAG_LOGGER_BINARY                                             \
+    DECLARE_COMMAND_FLAG(LOGGER_BINARY, "", "log-binary", "FILE",              \
+                         "write hot-path events as binary log to FILE",        \
+                         flag_sval(""))
+
 #define DECLARE_FLAG_TEMPORARY_DIRECTORY                                       \
     DECLARE_COMMAND_FLAG(TEMPORARY_DIRECTORY, "t", "temporary-directory",      \
                          "DIR", "temporary directory to write Lotto files",    \
@@ -8,5 +8,7 @@
 #include <lotto/base/flag.h>
 
 flag_t flag_seed();
+flag_t flag_prng_stream();
+flag_t flag_prng_gen();
 
 #endif
@@ -0,0 +1,73 @@
+/**
+ * @file jobs.h
+ * @brief Driver declarations for running round loops as concurrent jobs.
+ */
+#ifndef LOTTO_DRIVER_JOBS_H
+#define LOTTO_DRIVER_JOBS_H
+
+#include <stdint.h>
+
+#include <lotto/driver/args.h>
+#include <lotto/driver/flagmgr.h>
+
+/**
+ * Round loop executed by each job.
+ *
+ * The loop reads its share of rounds, its first seed, its temporary directory
+ * and its output trace from `flags`, as a sequential command would.
+ *
+ * @param args command arguments
+ * @param flags per-job flags
+ * @param job index of the job in [0, jobs)
+ * @return 0 if all rounds passed, the error of the first failing round
+ * otherwise
+ */
+typedef int(run_job_f)(args_t *args, flags_t *flags, uint64_t job);
+
+/**
+ * Runs `loop` in `--jobs` concurrent worker processes.
+ *
+ * With one job, `loop` runs in the calling process. Otherwise each worker gets
+ * a disjoint share of the rounds, its own stream of the generator (see
+ * prng_stream()), a `job-K` subdirectory of the temporary directory, its own
+ * output trace, and a disjoint set of physical cores that the programs it
+ * starts inherit. The first failing worker stops the others, its trace
+ * becomes the output trace and its error is returned in full.
+ *
+ * @param args command arguments
+ * @param flags command flags
+ * @param loop round loop
+ * @return 0 if all workers passed, the error of the first failing worker
+ * otherwise
+ */
+int run_jobs(args_t *args, flags_t *flags, run_job_f *loop);
+
+/**
+ * Runs `loop` in `jobs` concurrent worker processes that do not split rounds.
+ *
+ * As run_jobs(), except that every worker keeps the rounds and stream of
+ * `flags`, so that loops distributing work by themselves still report the
+ * rounds of the command.
+ *
+ * @param args command arguments
+ * @param flags command flags
+ * @param loop worker loop
+ * @param jobs number of workers
+ * @return 0 if all workers passed, the error of the first failing worker
+ * otherwise
+ */
+int run_workers(args_t *args, flags_t *flags, run_job_f *loop, uint64_t jobs);
+
+/**
+ * Moves the output trace of `job` to the output trace.
+ *
+ * `run_jobs` collects the trace of the failing or last worker itself; callers
+ * whose workers agree on another outcome collect that worker afterwards. A
+ * trace that was already collected is left alone.
+ *
+ * @param flags command flags, as passed to `run_jobs`
+ * @param job index of the job in [0, jobs)
+ */
+void collect_job_output(const flags_t *flags, uint64_t job);
+
+#endif
@@ -7,9 +7,14 @@
 
 #include <lotto/base/tidset.h>
 #include <lotto/base/trace.h>
+#include <lotto/base/trace_footer.h>
 
 trace_t *cli_trace_load(const char *fn);
 void cli_trace_save(const trace_t *rec, const char *fn);
+/* Opens the footer of a trace file, NULL if the trace has none. */
+trace_reader_t *cli_trace_reader(const char *fn);
+/* Returns a copy of the last record, using the footer when present. */
+record_t *cli_trace_load_last(const char *fn);
 uint64_t cli_trace_last_clk(const char *name);
 void cli_trace_trim_to_clk(trace_t *trace, clk_t clk);
 void cli_trace_trim_to_goal(trace_t *trace, clk_t goal, bool drop_old_config);
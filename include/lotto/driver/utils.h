@@ -20,6 +20,18 @@ typedef int(run_post_run_hook_f)(const args_t *args, const flags_t *flags,
 void run_set_post_run_hook(run_post_run_hook_f *hook);
 flags_t *run_default_flags();
 int cp(const char *from, const char *to);
+/**
+ * Copies a file, cloning its extents when the filesystem supports it.
+ *
+ * Tries the FICLONE ioctl, then copy_file_range(), and falls back to cp().
+ * On reflink-capable filesystems the cost is independent of the file size and
+ * the copy shares storage with the source until either side is written.
+ *
+ * @param from source path
+ * @param to destination path, truncated if it exists
+ * @return 0 on success, -1 on error with errno set
+ */
+int cp_clone(const char *from, const char *to);
 int run_once(args_t *args, flags_t *flags);
 
 #endif
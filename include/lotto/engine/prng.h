@@ -1,17 +1,34 @@
 /*******************************************************************************
  * @file prng.h
  * @brief Deterministic random generator for Lotto's engine.
+ *
+ * The engine draws from a 64-bit xoshiro256** generator seeded through
+ * splitmix64 from the root seed. The generator supports jump-ahead by 2^128
+ * draws, which is used to split one root seed into provably disjoint streams,
+ * e.g., one per parallel worker or forked probe. The generator id is part of
+ * the CONFIG record, so a trace always replays with the generator that
+ * recorded it.
  ******************************************************************************/
 #ifndef LOTTO_PRNG_H
 #define LOTTO_PRNG_H
 
 #include <stdint.h>
 
+#include <lotto/engine/state.h>
+
 /**
- * Returns the random generator seed.
+ * Returns the root seed of the random generator.
  */
 uint64_t prng_seed(void);
 
+/**
+ * Returns a digest of the current generator state.
+ *
+ * Two generators with equal digests produce the same sequence of numbers with
+ * overwhelming probability.
+ */
+uint64_t prng_digest(void);
+
 /**
  * Returns the next random number.
  */
@@ -19,6 +36,8 @@ uint64_t prng_next(void);
 
 /**
  * Returns the next random number adjusted to be in the range [min;max).
+ *
+ * The draw is free of modulo bias.
  */
 uint64_t prng_range(uint64_t min, uint64_t max);
 
@@ -27,6 +46,77 @@ uint64_t prng_range(uint64_t min, uint64_t max);
  */
 double prng_real(void);
 
+/**
+ * Advances the generator by 2^128 draws.
+ */
+void prng_jump(void);
+
+/**
+ * Reseeds the generator with root seed `seed` and selects stream `stream`.
+ *
+ * Stream `k` starts `k` jumps into the sequence of the root seed, so streams
+ * of the same root seed never overlap for less than 2^128 draws. The stream
+ * is part of the CONFIG record.
+ */
+void prng_stream(uint64_t seed, uint64_t stream);
+
+/**
+ * Generator owned by a component that must not consume the engine's draws,
+ * e.g., a sampler or a driver-side mutator.
+ */
+typedef struct prng_sub {
+    uint64_t s[4];
+} prng_sub_t;
+
+/**
+ * Substream ids, one per component.
+ */
+typedef enum prng_sub_id {
+    PRNG_SUB_NONE = 0,
+    PRNG_SUB_UAFCHECK,
+    PRNG_SUB_COVERAGE,
+} prng_sub_id_t;
+
+/**
+ * Derives substream `id` of stream `stream` of root seed `seed`.
+ *
+ * Substream `id` starts `id` long jumps of 2^192 draws into the stream, so it
+ * overlaps neither the engine generator nor other substreams. Substreams are
+ * always xoshiro256**, whatever the generator of the engine.
+ */
+void prng_sub_init(prng_sub_t *sub, uint64_t seed, uint64_t stream,
+                   prng_sub_id_t id);
+
+/**
+ * Returns the next random number of a substream.
+ */
+uint64_t prng_sub_next(prng_sub_t *sub);
+
+/**
+ * Returns the next random number of a substream in the range [min;max).
+ */
+uint64_t prng_sub_range(prng_sub_t *sub, uint64_t min, uint64_t max);
+
+/**
+ * Returns the next random number of a substream between 0.0 and 1.0.
+ */
+double prng_sub_real(prng_sub_t *sub);
+
+/**
+ * Parses a generator name, either `xoshiro256ss` or `rand_r`.
+ */
+prng_gen_t prng_gen_from(const char *str);
+
+/**
+ * Returns the name of a generator.
+ */
+const char *prng_gen_str(prng_gen_t gen);
+
+/**
+ * Writes all generator names separated by `|` into `output`.
+ */
+void prng_gen_all_str(char *output);
+
 // LCG from glibc
 // multiplier 1103515245
 // increment 12345
@@ -14,9 +14,22 @@
 
 #define STRATEGY_LEN 128
 
+#define PRNG_GEN_MAX_LEN 64
+
+typedef enum prng_gen {
+    PRNG_GEN_NONE = 0,
+    PRNG_GEN_XOSHIRO256SS,
+    PRNG_GEN_RAND_R,
+    PRNG_GEN_END_,
+    PRNG_GEN_SIZE_ = (1ULL << 62),
+} prng_gen_t;
+
 typedef struct prng {
     marshable_t m;
-    uint32_t seed;
+    uint64_t gen;    //< generator id, see prng_gen_t
+    uint64_t seed;   //< root seed
+    uint64_t stream; //< stream index derived from the root seed
+    uint64_t s[4];   //< generator state, all zero until first draw
 } prng_t;
 
 typedef struct sequencer_config {
@@ -28,6 +41,7 @@ typedef struct sequencer_config {
 } sequencer_config_t;
 
 prng_t *prng();
+void prng_reset(uint64_t seed);
 sequencer_config_t *sequencer_config();
 void engine_set_clk(clk_t clk);
 
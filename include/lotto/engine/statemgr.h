@@ -35,6 +35,31 @@ typedef enum state_type {
  */
 void statemgr_register(int slot, marshable_t *m, state_type_t type);
 
+/**
+ * Registers the initialization function of an ephemeral state, so that
+ * statemgr_reset() can restore it.
+ *
+ * Other states may register one too for the parts they do not marshal. It
+ * runs after their baseline is restored.
+ *
+ * @param m marshable object
+ * @param init initialization function called with m
+ */
+void statemgr_register_reset(marshable_t *m, void (*init)(marshable_t *));
+
+/**
+ * Saves the current CONFIG, PERSISTENT and FINAL states as the baseline of
+ * statemgr_reset(). Must be called before the first capture.
+ */
+void statemgr_checkpoint(void);
+
+/**
+ * Restores all states to the baseline saved by statemgr_checkpoint() and
+ * reinitializes ephemeral states, as if the process had just started. No
+ * AFTER_UNMARSHAL events are published.
+ */
+void statemgr_reset(void);
+
 size_t statemgr_size(state_type_t type);
 
 /*
@@ -129,6 +154,8 @@ void statemgr_record_unmarshal(const record_t *r);
         STATEMGR_INIT(type)((marshable_t *)&var);                              \
         statemgr_register(DICE_MODULE_SLOT, (marshable_t *)&var,               \
                           STATE_TYPE_##type);                                  \
+        if (STATE_TYPE_##type == STATE_TYPE_EPHEMERAL)                         \
+            statemgr_register_reset((marshable_t *)&var, STATEMGR_INIT(type)); \
     })
 
 #define REGISTER_PERSISTENT(var, ...)                                          \
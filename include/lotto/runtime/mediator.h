@@ -19,6 +19,7 @@ typedef struct mediator {
     task_id id;
     struct plan plan;
     bool finito;
+    uint64_t round;
     mediator_optimization_t optimization;
 
     struct mediator_stats {
@@ -31,6 +32,7 @@ typedef enum mediator_status {
     MEDIATOR_OK,
     MEDIATOR_ABORT,
     MEDIATOR_SHUTDOWN,
+    MEDIATOR_DORMANT, /* the round rolled over while the task waited */
 } mediator_status_t;
 
 /* return
@@ -65,4 +67,8 @@ bool mediator_in_capture(const mediator_t *m);
  * access */
 mediator_t *mediator_get(metadata_t *md, bool bootstrap);
 
+/* returns true if the task has a mediator from a round before the current one,
+ * which mediator_get() restarts */
+bool mediator_stale(metadata_t *md);
+
 #endif
@@ -5,10 +5,54 @@
 #ifndef LOTTO_RUNTIME_H
 #define LOTTO_RUNTIME_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <lotto/base/reason.h>
 #include <lotto/runtime/capture_point.h>
 #include <lotto/util/macros.h>
 
 void lotto_exit(capture_point *cp, reason_t reason) NORETURN;
 
+/**
+ * Decides whether the process survives the end of a round.
+ *
+ * Called once the engine has finished the round and the traces are closed.
+ * Returning true keeps the process alive: the runtime goes dormant until the
+ * host calls lotto_rollover_resume().
+ *
+ * @param reason termination reason of the round
+ * @param err exit code the round would have terminated with
+ */
+typedef bool(lotto_rollover_f)(reason_t reason, int err);
+
+/**
+ * Registers the rollover handler and saves the current state as the start
+ * state of every round. Must be called before the first capture.
+ */
+void lotto_rollover_register(lotto_rollover_f *rollover);
+
+/**
+ * Ends the round of a task that received a shutdown or abort plan.
+ *
+ * Behaves as lotto_exit() unless the rollover handler keeps the process
+ * alive, in which case the calling task returns and continues uncaptured.
+ */
+void lotto_round_end(capture_point *cp, reason_t reason);
+
+/**
+ * Starts the next round of a dormant runtime.
+ *
+ * Restores the start state, reopens the LOTTO_RECORD and LOTTO_REPLAY traces
+ * and restarts the engine. Must be called while no task runs, e.g., with all
+ * vCPUs stopped.
+ */
+void lotto_rollover_resume(void);
+
+/* returns true between the end of a rolled-over round and its resume */
+bool lotto_dormant(void);
+
+/* returns the number of rounds started in this process minus one */
+uint64_t lotto_round(void);
+
 #endif
@@ -0,0 +1,114 @@
+/**
+ * @file logger_bin.h
+ * @brief Binary event logger with per-thread ring buffers.
+ *
+ * The binary logger is an alternative to the formatted debug messages of the
+ * engine and runtime hot paths. Each thread appends fixed-size event records
+ * into its own ring buffer without locks or formatting. Rings are written to
+ * the log file on fini or crash and can be decoded offline with
+ * `lotto log decode FILE`.
+ *
+ * Rings keep only the most recent LOGGER_BIN_RING_SIZE events of each thread;
+ * older events are counted as dropped.
+ */
+#ifndef LOTTO_LOGGER_BIN_H
+#define LOTTO_LOGGER_BIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef LOGGER_BIN_RING_SIZE
+    #define LOGGER_BIN_RING_SIZE 8192
+#endif
+
+#define LOGGER_BIN_MAGIC   0x4e49424f54544f4cULL /* "LOTTOBIN" */
+#define LOGGER_BIN_VERSION 1
+
+#define FOR_EACH_LOGGER_BIN_KIND                                               \
+    GEN_LOGGER_BIN_KIND(CAPTURE)                                               \
+    GEN_LOGGER_BIN_KIND(CONTINUE)                                              \
+    GEN_LOGGER_BIN_KIND(RESUME)                                                \
+    GEN_LOGGER_BIN_KIND(RETURN)                                                \
+    GEN_LOGGER_BIN_KIND(SEQUENCE)                                              \
+    GEN_LOGGER_BIN_KIND(RECORD)                                                \
+    GEN_LOGGER_BIN_KIND(YIELD)                                                 \
+    GEN_LOGGER_BIN_KIND(RESUMED)                                               \
+    GEN_LOGGER_BIN_KIND(WAKE)                                                  \
+    GEN_LOGGER_BIN_KIND(FINI)
+
+#define GEN_LOGGER_BIN_KIND(kind) LOGGER_BIN_##kind,
+enum logger_bin_kind {
+    LOGGER_BIN_NONE = 0,
+    FOR_EACH_LOGGER_BIN_KIND LOGGER_BIN_END_,
+};
+#undef GEN_LOGGER_BIN_KIND
+
+/** Fixed-size event record as written to the log file. */
+typedef struct logger_bin_event {
+    uint64_t ts;   //< monotonic timestamp in nanoseconds
+    uint64_t tid;  //< task id
+    uint64_t clk;  //< engine clock, 0 if unknown
+    uint64_t pc;   //< program counter
+    uint64_t arg;  //< kind-specific argument
+    uint32_t kind; //< see enum logger_bin_kind
+    uint32_t type; //< event type id
+} logger_bin_event_t;
+
+/** File header followed by one chunk per ring. */
+typedef struct logger_bin_header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t event_size;
+} logger_bin_header_t;
+
+/** Ring chunk header followed by `count` events in chronological order. */
+typedef struct logger_bin_chunk {
+    uint64_t ring;
+    uint64_t count;
+    uint64_t dropped;
+} logger_bin_chunk_t;
+
+extern bool _logger_bin_enabled;
+
+/**
+ * Enables the binary logger writing to `path` on flush.
+ *
+ * @return 0 on success, -1 if the file cannot be opened.
+ */
+int logger_bin_open(const char *path);
+
+/**
+ * Writes all rings to the log file. Safe to call several times; each event
+ * is written at most once. Called on fini and from the signal handler. Waits
+ * for the flush of another thread to finish, but returns at once if the
+ * calling thread is itself flushing.
+ */
+void logger_bin_flush(void);
+
+/** Appends an event to the calling thread's ring. */
+void _logger_bin_log(enum logger_bin_kind kind, uint64_t tid, uint64_t clk,
+                     uint32_t type, uint64_t pc, uint64_t arg);
+
+/** Returns the name of an event kind. */
+const char *logger_bin_kind_str(enum logger_bin_kind kind);
+
+static inline bool
+logger_bin_enabled(void)
+{
+    return __builtin_expect(_logger_bin_enabled, 0);
+}
+
+/**
+ * Appends an event to the calling thread's ring if the binary logger is
+ * enabled.
+ *
+ * @return true if the event was logged, so that callers can fall back to a
+ * formatted message otherwise.
+ */
+#define logger_bin(kind, tid, clk, type, pc, arg)                              \
+    (logger_bin_enabled() ? (_logger_bin_log(LOGGER_BIN_##kind, (tid), (clk),  \
+                                             (type), (pc), (arg)),             \
+                             true)                                             \
+                          : false)
+
+#endif /* LOTTO_LOGGER_BIN_H */
@@ -1,21 +1,29 @@
 /**
  * @file mempool.h
  * @brief System wrapper declarations for mempool.
+ *
+ * Entries of up to LOTTO_MEMPOOL_CACHE_MAX bytes go through small per-thread
+ * magazines and only touch the shared stacks, under the pool lock, to refill
+ * or spill half a magazine at once.
  */
 #ifndef LOTTO_SYS_LOTTO_MEMPOOL_H
 #define LOTTO_SYS_LOTTO_MEMPOOL_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <vsync/spinlock/caslock.h>
 
-#define NSTACKS ((size_t)18)
+#define NSTACKS                 ((size_t)18)
+#define LOTTO_MEMPOOL_CACHE_MAX ((size_t)32 * 1024)
 
 typedef struct entry entry_t;
+typedef struct lotto_mempool_cache lotto_mempool_cache_t;
 
 typedef struct alloc {
     size_t capacity;
     size_t next;
+    size_t limit; /* thread caches are carved from above the limit */
     char *memory;
 } alloc_t;
 
@@ -25,6 +33,8 @@ typedef struct lotto_mempool {
     size_t allocated;
     struct alloc pool;
     entry_t *stack[NSTACKS];
+    uint64_t id;
+    lotto_mempool_cache_t *caches;
 } lotto_mempool_t;
 
 lotto_mempool_t *lotto_mempool_init(void *(*alloc)(size_t),
@@ -32,6 +42,12 @@ lotto_mempool_t *lotto_mempool_init(void *(*alloc)(size_t),
 void lotto_mempool_init_static(lotto_mempool_t *lotto_mempool, void *pool,
                                size_t cap);
 void lotto_mempool_fini(lotto_mempool_t *mp);
+/**
+ * Returns the entries cached by the calling thread to the pool and lets
+ * another thread take over its cache. Called when the thread exits; the
+ * thread may still use the pool afterwards.
+ */
+void lotto_mempool_thread_fini(lotto_mempool_t *mp);
 void *lotto_mempool_alloc(lotto_mempool_t *mp, size_t n);
 void *lotto_mempool_aligned_alloc(lotto_mempool_t *mp, size_t alignment,
                                   size_t size);
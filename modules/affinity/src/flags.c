@@ -0,0 +1,8 @@
+#include "state.h"
+#include <lotto/base/flags.h>
+#include <lotto/driver/flagmgr.h>
+
+NEW_CALLBACK_FLAG(AFFINITY_CPUS, "", LOTTO_MODULE_FLAG("cpus"), "N",
+                  "pin the program to N of the inherited CPUs, on distinct "
+                  "physical cores first, 0 to keep the inherited affinity",
+                  flag_uval(0), { affinity_config()->cpus = as_uval(v); })
@@ -0,0 +1,58 @@
+#include "state.h"
+#include <lotto/base/cpuset.h>
+#include <lotto/engine/sequencer.h>
+#include <lotto/runtime/events.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/sched.h>
+#include <lotto/util/macros.h>
+
+/*******************************************************************************
+ * @file handler.c
+ *
+ * Only the task picked by the sequencer runs, so every handoff wakes up a
+ * thread that the OS may have placed on another core, with cold caches. With
+ * `--affinity-cpus N`, every task pins itself when it starts to the same N
+ * CPUs, taken from the affinity inherited by the main thread. The runtime runs
+ * in the task threads, so it is pinned along with them.
+ ******************************************************************************/
+
+static cpu_set_t _cpus;
+static bool _ready;
+
+static void
+_affinity_init(void)
+{
+    cpu_set_t avail;
+    CPU_ZERO(&_cpus);
+    if (sched_getaffinity(0, sizeof(avail), &avail) != 0) {
+        logger_warnf("could not read the CPU affinity\n");
+        return;
+    }
+    cpu_order_t order[CPU_SETSIZE];
+    size_t n = cpuset_spread(&avail, cpuset_core, order);
+    for (size_t i = 0; i < n && i < affinity_config()->cpus; i++) {
+        CPU_SET(order[i].cpu, &_cpus);
+    }
+}
+
+STATIC void
+_affinity_handle(const capture_point *cp, event_t *e)
+{
+    (void)e;
+    ASSERT(cp);
+    if (cp->type_id != EVENT_TASK_INIT || affinity_config()->cpus == 0)
+        return;
+
+    if (!_ready) {
+        _affinity_init();
+        _ready = true;
+    }
+    if (CPU_COUNT(&_cpus) == 0)
+        return;
+
+    // the task is initialized by its own thread
+    if (sys_sched_setaffinity(0, sizeof(_cpus), &_cpus) != 0)
+        logger_warnf("could not pin task %lu\n", cp->id);
+}
+ON_SEQUENCER_CAPTURE(_affinity_handle)
@@ -0,0 +1,13 @@
+#include "state.h"
+#include <lotto/engine/statemgr.h>
+#include <lotto/sys/logger.h>
+
+static affinity_config_t _config;
+
+REGISTER_CONFIG(_config, { logger_infof("cpus = %lu\n", _config.cpus); })
+
+affinity_config_t *
+affinity_config(void)
+{
+    return &_config;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file state.h
+ * @brief Affinity module state declarations.
+ */
+#ifndef LOTTO_STATE_AFFINITY_H
+#define LOTTO_STATE_AFFINITY_H
+
+#include <stdint.h>
+
+#include <lotto/base/marshable.h>
+
+typedef struct affinity_config {
+    marshable_t m;
+    uint64_t cpus;
+} affinity_config_t;
+
+affinity_config_t *affinity_config(void);
+
+#endif
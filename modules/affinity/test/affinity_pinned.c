@@ -0,0 +1,35 @@
+// clang-format off
+// RUN: %lotto %stress -r 2 --affinity-cpus 1 -- %b | %check %s
+// CHECK: main: 1 cpu
+// CHECK: thread: 1 cpu
+// clang-format on
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+static void
+print_cpus(const char *who)
+{
+    cpu_set_t set;
+    sched_getaffinity(0, sizeof(set), &set);
+    printf("%s: %d cpu\n", who, CPU_COUNT(&set));
+}
+
+void *
+run(void *arg)
+{
+    print_cpus("thread");
+    return arg;
+}
+
+int
+main()
+{
+    print_cpus("main");
+    pthread_t t;
+    pthread_create(&t, 0, run, 0);
+    pthread_join(t, 0);
+    return 0;
+}
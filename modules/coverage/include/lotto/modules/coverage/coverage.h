@@ -0,0 +1,69 @@
+/**
+ * @file coverage.h
+ * @brief Coverage module declarations for interleaving coverage.
+ *
+ * The driver maps a file of COVERAGE_MAP_SIZE hit counters and passes its path
+ * to the runtime in COVERAGE_MAP_ENV. At every capture point the runtime
+ * counts the edge from the previous capture point, distinguishing whether the
+ * task switched, and every pair of conflicting accesses to the same address
+ * by different tasks. After each round the driver merges the counters into
+ * the buckets seen so far, AFL-style, and keeps the trace of any round that
+ * reached a new bucket in a corpus. Mutants replay a prefix of a corpus trace
+ * and force another available task at its last step.
+ */
+#ifndef LOTTO_MODULES_COVERAGE_H
+#define LOTTO_MODULES_COVERAGE_H
+
+#include <stdint.h>
+
+#define COVERAGE_MAP_BITS    16U
+#define COVERAGE_MAP_SIZE    (1U << COVERAGE_MAP_BITS)
+#define COVERAGE_MAP_ENV     "LOTTO_COVERAGE_MAP"
+#define COVERAGE_CORPUS_SIZE 256U
+
+typedef struct coverage coverage_t;
+
+/**
+ * Creates the coverage map in `dir` and exports it to the runtime.
+ */
+coverage_t *coverage_init(const char *dir);
+
+/**
+ * Unmaps the coverage map and removes it and the corpus.
+ */
+void coverage_fini(coverage_t *cov);
+
+/**
+ * Clears the counters before a round runs.
+ */
+void coverage_round_begin(coverage_t *cov);
+
+/**
+ * Merges the counters of the finished round and keeps `trace` in the corpus
+ * if the round reached something new.
+ *
+ * @return the number of entries that reached a new bucket
+ */
+uint64_t coverage_round_end(coverage_t *cov, const char *trace);
+
+/**
+ * Writes a mutant of a corpus trace.
+ *
+ * The trace, the step and the task are drawn from the coverage substream of
+ * stream `stream` of root seed `seed`, see prng_sub_init().
+ *
+ * @return the path of the mutant, or NULL if no corpus trace can be mutated
+ */
+const char *coverage_mutate(coverage_t *cov, uint64_t seed, uint64_t stream);
+
+/**
+ * Returns the number of entries hit so far.
+ */
+uint64_t coverage_entries(const coverage_t *cov);
+
+/**
+ * Returns the number of traces in the corpus.
+ */
+uint64_t coverage_corpus_size(const coverage_t *cov);
+
+#endif
@@ -0,0 +1,206 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <lotto/base/record.h>
+#include <lotto/base/tidset.h>
+#include <lotto/base/trace.h>
+#include <lotto/driver/trace.h>
+#include <lotto/driver/utils.h>
+#include <lotto/engine/prng.h>
+#include <lotto/engine/statemgr.h>
+#include <lotto/modules/available/state.h>
+#include <lotto/modules/coverage/coverage.h>
+#include <lotto/runtime/events.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct coverage {
+    char dir[PATH_MAX];
+    char path[PATH_MAX];   /* map shared with the runtime */
+    char mutant[PATH_MAX]; /* trace replayed by mutated rounds */
+    uint8_t *map;
+    uint8_t seen[COVERAGE_MAP_SIZE]; /* buckets reached so far */
+    uint64_t entries;
+    uint64_t ncorpus;
+    uint64_t next; /* corpus slot replaced next once the corpus is full */
+};
+
+coverage_t *
+coverage_init(const char *dir)
+{
+    coverage_t *cov = sys_calloc(1, sizeof(coverage_t));
+    ASSERT(cov);
+    sys_snprintf(cov->dir, PATH_MAX, "%s", dir);
+    sys_snprintf(cov->path, PATH_MAX, "%s/coverage.map", dir);
+    sys_snprintf(cov->mutant, PATH_MAX, "%s/mutant.trace", dir);
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        sys_fprintf(stderr, "error: could not create directory '%s': %s\n",
+                    dir, strerror(errno));
+    }
+    int fd = open(cov->path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0 || ftruncate(fd, COVERAGE_MAP_SIZE) != 0) {
+        sys_fprintf(stderr, "error: could not create coverage map '%s': %s\n",
+                    cov->path, strerror(errno));
+        ASSERT(0);
+    }
+    cov->map = mmap(NULL, COVERAGE_MAP_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT(cov->map != MAP_FAILED);
+
+    sys_setenv(COVERAGE_MAP_ENV, cov->path, true);
+    return cov;
+}
+
+static void
+_corpus_path(const coverage_t *cov, uint64_t i, char *path)
+{
+    sys_snprintf(path, PATH_MAX, "%s/corpus-%lu.trace", cov->dir, i);
+}
+
+void
+coverage_fini(coverage_t *cov)
+{
+    char path[PATH_MAX];
+    for (uint64_t i = 0; i < cov->ncorpus; i++) {
+        _corpus_path(cov, i, path);
+        (void)unlink(path);
+    }
+    (void)unlink(cov->mutant);
+    (void)unlink(cov->path);
+    munmap(cov->map, COVERAGE_MAP_SIZE);
+    sys_unsetenv(COVERAGE_MAP_ENV);
+    sys_free(cov);
+}
+
+void
+coverage_round_begin(coverage_t *cov)
+{
+    sys_memset(cov->map, 0, COVERAGE_MAP_SIZE);
+}
+
+/* Hit counts are compared in buckets, so that a loop running a few more times
+ * is not new while a first, second or third hit is. */
+static inline uint8_t
+_bucket(uint8_t count)
+{
+    if (count <= 2) {
+        return count;
+    }
+    if (count == 3) {
+        return 1U << 2;
+    }
+    if (count < 8) {
+        return 1U << 3;
+    }
+    if (count < 16) {
+        return 1U << 4;
+    }
+    if (count < 32) {
+        return 1U << 5;
+    }
+    return count < 128 ? 1U << 6 : 1U << 7;
+}
+
+uint64_t
+coverage_round_end(coverage_t *cov, const char *trace)
+{
+    uint64_t found = 0;
+    for (uint32_t i = 0; i < COVERAGE_MAP_SIZE; i++) {
+        uint8_t bucket = _bucket(cov->map[i]);
+        if (bucket == 0 || (cov->seen[i] & bucket) != 0) {
+            continue;
+        }
+        cov->entries += cov->seen[i] == 0;
+        cov->seen[i] |= bucket;
+        found++;
+    }
+    if (found == 0 || trace == NULL || access(trace, F_OK) != 0) {
+        return found;
+    }
+
+    // once the corpus is full, the oldest trace makes room
+    char path[PATH_MAX];
+    uint64_t slot;
+    if (cov->ncorpus < COVERAGE_CORPUS_SIZE) {
+        slot = cov->ncorpus++;
+    } else {
+        slot = cov->next++ % COVERAGE_CORPUS_SIZE;
+    }
+    _corpus_path(cov, slot, path);
+    if (cp_clone(trace, path) != 0) {
+        sys_fprintf(stderr, "warning: could not keep '%s' in the corpus\n",
+                    trace);
+    }
+    return found;
+}
+
+/* Trims the trace to the last scheduling step at or before `clk`. */
+static record_t *
+_last_step(trace_t *trace, clk_t clk)
+{
+    record_t *r;
+    for (r = trace_last(trace);
+         r && (r->clk > clk || !(r->kind & RECORD_SCHED) || r->type_id == 0 ||
+               r->type_id == EVENT_TASK_CREATE);
+         trace_forget(trace), r = trace_last(trace)) {}
+    return r;
+}
+
+const char *
+coverage_mutate(coverage_t *cov, uint64_t seed, uint64_t stream)
+{
+    if (cov->ncorpus == 0) {
+        return NULL;
+    }
+    prng_sub_t rng;
+    prng_sub_init(&rng, seed, stream, PRNG_SUB_COVERAGE);
+    char path[PATH_MAX];
+    _corpus_path(cov, prng_sub_range(&rng, 0, cov->ncorpus), path);
+    trace_t *trace = cli_trace_load(path);
+
+    // pick a step at random, walking back to one with an alternative
+    record_t *last = trace_last(trace);
+    clk_t clk      = last ? prng_sub_range(&rng, 0, last->clk + 1) : 0;
+    bool ok        = false;
+    tidset_t choices;
+    tidset_init(&choices);
+    for (record_t *r = _last_step(trace, clk); r;
+         trace_forget(trace), r = _last_step(trace, clk)) {
+        statemgr_unmarshal(r->data, STATE_TYPE_PERSISTENT, true);
+        tidset_copy(&choices, get_available_tasks());
+        tidset_remove(&choices, r->id);
+        if (tidset_size(&choices) == 0) {
+            continue;
+        }
+        task_id next = tidset_get(
+            &choices, prng_sub_range(&rng, 0, tidset_size(&choices)));
+        cli_trace_schedule_task(trace, next);
+        cli_trace_save(trace, cov->mutant);
+        ok = true;
+        break;
+    }
+    tidset_fini(&choices);
+    trace_destroy(trace);
+    return ok ? cov->mutant : NULL;
+}
+
+uint64_t
+coverage_entries(const coverage_t *cov)
+{
+    return cov->entries;
+}
+
+uint64_t
+coverage_corpus_size(const coverage_t *cov)
+{
+    return cov->ncorpus;
+}
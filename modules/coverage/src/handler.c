@@ -0,0 +1,118 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <lotto/engine/sequencer.h>
+#include <lotto/modules/coverage/coverage.h>
+#include <lotto/runtime/events.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/util/macros.h>
+#include <lotto/util/once.h>
+#include <sys/mman.h>
+
+/* Last access to each hashed address. A conflict only needs the most recent
+ * access of another task, so collisions merely drop a few pairs. */
+#define COVERAGE_ACCESS_SLOTS 4096U
+
+/* Salts keeping switches and conflicts apart from plain edges. */
+#define COVERAGE_SWITCH_SALT   0x5bd1e995U
+#define COVERAGE_CONFLICT_SALT 0x27d4eb2fU
+
+typedef struct coverage_access {
+    uintptr_t addr;
+    uintptr_t pc;
+    task_id id;
+    bool write;
+} coverage_access_t;
+
+static uint8_t *_map;
+static uintptr_t _prev_loc;
+static task_id _prev_id;
+static coverage_access_t _accesses[COVERAGE_ACCESS_SLOTS];
+
+static void
+_coverage_map(void)
+{
+    const char *path = sys_getenv(COVERAGE_MAP_ENV);
+    if (path == NULL || path[0] == '\0') {
+        return;
+    }
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        logger_warnf("could not open coverage map %s\n", path);
+        return;
+    }
+    void *map = mmap(NULL, COVERAGE_MAP_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        logger_warnf("could not map coverage map %s\n", path);
+        return;
+    }
+    _map = map;
+}
+
+static inline uintptr_t
+_coverage_hash(uintptr_t x)
+{
+    return (uintptr_t)(((uint64_t)x * 0x9e3779b97f4a7c15ULL) >>
+                       (64 - COVERAGE_MAP_BITS));
+}
+
+/* Counters saturate instead of wrapping, so a hot entry never reads as 0. */
+static inline void
+_coverage_hit(uintptr_t entry)
+{
+    uint8_t *c = &_map[entry & (COVERAGE_MAP_SIZE - 1)];
+    if (*c != UINT8_MAX) {
+        (*c)++;
+    }
+}
+
+STATIC void
+_coverage_handle(const capture_point *cp, event_t *e)
+{
+    (void)e;
+    once(_coverage_map());
+    if (_map == NULL) {
+        return;
+    }
+    ASSERT(cp);
+
+    // the previous location is shifted so that A->B and B->A differ
+    uintptr_t loc = _coverage_hash(cp->pc);
+    _coverage_hit(_prev_loc ^ loc ^
+                  (cp->id != _prev_id ? COVERAGE_SWITCH_SALT : 0));
+    _prev_loc = loc >> 1;
+    _prev_id  = cp->id;
+
+    bool write;
+    switch (cp->type_id) {
+        case EVENT_MA_READ:
+        case EVENT_MA_AREAD:
+            write = false;
+            break;
+        case EVENT_MA_WRITE:
+        case EVENT_MA_AWRITE:
+        case EVENT_MA_RMW:
+        case EVENT_MA_XCHG:
+        case EVENT_MA_CMPXCHG:
+        case EVENT_MA_CMPXCHG_WEAK:
+            write = true;
+            break;
+        default:
+            return;
+    }
+
+    uintptr_t addr       = memaccess_addr(cp);
+    coverage_access_t *a = &_accesses[_coverage_hash(addr) %
+                                      COVERAGE_ACCESS_SLOTS];
+    if (a->addr == addr && a->id != cp->id && (a->write || write)) {
+        _coverage_hit((_coverage_hash(a->pc) >> 1) ^ loc ^
+                      COVERAGE_CONFLICT_SALT);
+    }
+    *a = (coverage_access_t){
+        .addr = addr, .pc = cp->pc, .id = cp->id, .write = write};
+}
+ON_SEQUENCER_CAPTURE(_coverage_handle);
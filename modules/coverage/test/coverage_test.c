@@ -0,0 +1,32 @@
+// clang-format off
+// RUN: %lotto %stress -r 20 --stress-coverage -- %b | %check %s
+// CHECK: [lotto] coverage: {{[1-9][0-9]*}} entries, {{[1-9][0-9]*}} traces in corpus
+// clang-format on
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+atomic_int x = 0;
+
+void *
+run(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < 3; i++) {
+        int v = atomic_load(&x);
+        atomic_store(&x, v + 1);
+    }
+    return NULL;
+}
+
+int
+main()
+{
+    pthread_t t1, t2;
+    pthread_create(&t1, 0, run, 0);
+    pthread_create(&t2, 0, run, 0);
+
+    pthread_join(t1, 0);
+    pthread_join(t2, 0);
+    return 0;
+}
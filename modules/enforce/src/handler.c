@@ -21,7 +21,7 @@
     (pc = stable_address_get(cp->pc,                                           \
                              sequencer_config()->stable_address_method),       \
      stable_address_equals(&enforce_state()->pc, &pc))
-#define EQUAL_SEED (enforce_state()->seed == prng_seed())
+#define EQUAL_SEED (enforce_state()->seed == prng_digest())
 #define MODE(x)    (enforce_modes_has(enforce_config()->modes, ENFORCE_MODE_##x))
 #define EQUAL_ADDR (enforce_state()->addr == memaccess_addr(cp))
 
@@ -123,7 +123,7 @@ _report(const capture_point *cp)
         REPORT_CTX("%p", (void *), pc);
 
     if (MODE(SEED) && !EQUAL_SEED) {
-        REPORT("%lu", _, seed, enforce_state()->seed, prng_seed());
+        REPORT("%lu", _, seed, enforce_state()->seed, prng_digest());
     }
 }
 
@@ -157,7 +157,7 @@ _save(const capture_point *cp, const event_t *e)
             cp->pc, sequencer_config()->stable_address_method);
     }
     if (MODE(SEED)) {
-        enforce_state()->seed = prng_seed();
+        enforce_state()->seed = prng_digest();
     }
 }
 
@@ -11,43 +11,47 @@
 #include <lotto/util/casts.h>
 #include <lotto/util/macros.h>
 
+/* A task in a timed wait. Its deadline is only kept by the timeout module,
+ * which publishes EVENT_TIMEOUT_TRIGGER once it expires. */
 typedef struct {
     mapitem_t ti;
-    struct timespec deadline;
     enum lotto_timed_wait_status *ret;
-} deadline_t;
+} timed_wait_t;
 
-#define DEADLINE_ELEMENT MARSHABLE_STATIC(sizeof(deadline_t))
+#define TIMED_WAIT_ELEMENT MARSHABLE_STATIC(sizeof(timed_wait_t))
 
 struct evec {
     mapitem_t ti;
     tidset_t waiters;
-    map_t deadlines;
     int count;
 };
 
 struct handler_evec {
     map_t evecs;
     tidset_t waiters;
-    struct timespec now;
-    bool received_timeout;
+    map_t timed;
 };
 
 static struct handler_evec _state;
 
 REGISTER_STATE(EPHEMERAL, _state, {
+    map_clear(&_state.timed);
     map_init(&_state.evecs, MARSHABLE_STATIC(sizeof(struct evec)));
     tidset_init(&_state.waiters);
+    map_init(&_state.timed, TIMED_WAIT_ELEMENT);
 })
 
-static void _check_timeouts(bool should_publish);
 LOTTO_SUBSCRIBE(EVENT_TIMEOUT_TRIGGER, {
-    if (_state.received_timeout || !tidset_has(&_state.waiters, as_uval(v))) {
+    task_id id       = as_uval(v);
+    timed_wait_t *tw = (timed_wait_t *)map_find(&_state.timed, id);
+    if (tw == NULL) {
         return PS_OK;
     }
-    _state.received_timeout = true;
-    lotto_clock_time(&_state.now);
-    _check_timeouts(false);
+    ASSERT(tidset_has(&_state.waiters, id));
+    tidset_remove(&_state.waiters, id);
+    *(tw->ret) = TIMED_WAIT_TIMEOUT;
+    map_deregister(&_state.timed, id);
+    return PS_OK;
 })
 
 static struct evec *
@@ -64,7 +68,6 @@ _evec_init(uint64_t eid)
         evec = (struct evec *)map_register(&_state.evecs, eid);
         ASSERT(evec);
         tidset_init(&evec->waiters);
-        map_init(&evec->deadlines, DEADLINE_ELEMENT);
     }
     return evec;
 }
@@ -73,7 +76,6 @@ static void
 _evec_deinit(struct evec *evec)
 {
     tidset_fini(&evec->waiters);
-    map_clear(&evec->deadlines);
     map_deregister(&_state.evecs, evec->ti.key);
 }
 
@@ -139,21 +141,20 @@ _handle_timed_wait(task_id id, uint64_t eid,
     if (!tidset_has(&evec->waiters, id))
         return false;
 
-    deadline_t *deadline = (deadline_t *)map_register(&evec->deadlines, id);
     ASSERT(ret);
-    deadline->ret = ret;
     if (!abstime) {
         *ret = TIMED_WAIT_INVALID;
-        handler_timeout_deregister(id);
-        map_deregister(&evec->deadlines, id);
         return false;
     }
     // TODO other validity checks on abstime
-    // deadline->deadline = *abstime;
-    deadline->deadline = _state.now;
-    deadline->deadline.tv_sec += 20;
+    // deadline = *abstime;
+    struct timespec deadline;
+    lotto_clock_time(&deadline);
+    deadline.tv_sec += 20;
+    timed_wait_t *tw = (timed_wait_t *)map_register(&_state.timed, id);
+    tw->ret          = ret;
     tidset_insert(&_state.waiters, id);
-    handler_timeout_register(id, &deadline->deadline);
+    handler_timeout_register(id, &deadline);
     return true;
 }
 
@@ -171,11 +172,11 @@ _posthandle_wake(task_id id, uint64_t eid, uint32_t cnt)
                                   prng_range(0, tidset_size(&evec->waiters)));
         ASSERT(next != NO_TASK);
         tidset_remove(&evec->waiters, next);
-        deadline_t *d = (deadline_t *)map_find(&evec->deadlines, next);
-        if (d) {
-            *(d->ret) = TIMED_WAIT_INVALID;
+        timed_wait_t *tw = (timed_wait_t *)map_find(&_state.timed, next);
+        if (tw) {
+            *(tw->ret) = TIMED_WAIT_INVALID;
             handler_timeout_deregister(next);
-            map_deregister(&evec->deadlines, next);
+            map_deregister(&_state.timed, next);
         }
         tidset_remove(&_state.waiters, next);
     }
@@ -211,54 +212,11 @@ _posthandle_move(task_id id, uint64_t src, uint64_t dst)
     ASSERT(!tidset_has(&edst->waiters, id));
     ASSERT(!tidset_has(&esrc->waiters, id));
 
-    /* move deadlines to dst */
-    const mapitem_t *it = map_iterate(&esrc->deadlines);
-    for (; it; it = map_next(it)) {
-        deadline_t *s = (deadline_t *)it;
-        deadline_t *d = (deadline_t *)map_register(&edst->deadlines, it->key);
-        d->deadline   = s->deadline;
-        d->ret        = s->ret;
-        handler_timeout_register(it->key, &d->deadline);
-    }
-    map_clear(&esrc->deadlines);
-
     if (tidset_size(&esrc->waiters) == 0) {
         _evec_deinit(esrc);
     }
 }
 
-static bool
-_deadline_met(const mapitem_t *item)
-{
-    deadline_t *d = (deadline_t *)item;
-    if (timespec_compare(&d->deadline, &_state.now) <= 0)
-        return true;
-    return false;
-}
-
-static void
-_check_timeouts(bool should_publish)
-{
-    bool found = false;
-    for (const mapitem_t *i = map_iterate(&_state.evecs); i; i = map_next(i)) {
-        struct evec *e = (struct evec *)i;
-        for (mapitem_t *ii = map_find_first(&e->deadlines, _deadline_met); ii;
-             ii            = map_find_first(&e->deadlines, _deadline_met)) {
-            found      = true;
-            task_id id = ii->key;
-            ASSERT(tidset_has(&_state.waiters, id));
-            tidset_remove(&_state.waiters, id);
-            deadline_t *d = (deadline_t *)ii;
-            (*d->ret)     = TIMED_WAIT_TIMEOUT;
-            map_deregister(&e->deadlines, id);
-            if (should_publish) {
-                handler_timeout_deregister(id);
-            }
-        }
-    }
-    ASSERT(should_publish || found);
-}
-
 static bool
 _should_wait(task_id id)
 {
@@ -273,9 +231,6 @@ _evec_handle(const capture_point *cp, event_t *e)
     ASSERT(cp->id != NO_TASK);
 
     bool may_block = false;
-    lotto_clock_time(&_state.now);
-    _state.received_timeout = false;
-    _check_timeouts(true);
     switch (cp->type_id) {
         case EVENT_EVEC_WAIT: {
             struct evec_timed_wait_event *ev = CP_PAYLOAD(ev);
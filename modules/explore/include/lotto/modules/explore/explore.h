@@ -12,6 +12,12 @@ DECLARE_COMMAND_FLAG(EXPLORE_EXPECT_FAILURE, "", "explore-failure", "",
                      "expect all runs to fail", flag_off())
 DECLARE_COMMAND_FLAG(EXPLORE_MIN, "", "explore-min", "UINT",
                      "minimum clock for explore", flag_uval(0))
+DECLARE_COMMAND_FLAG(EXPLORE_DPOR, "", "explore-dpor", "",
+                     "only reorder dependent steps (dynamic partial-order "
+                     "reduction); makes every memory access and lock "
+                     "operation a change point, accesses skipped by other "
+                     "modules (e.g., -e locality) are not seen",
+                     flag_off())
 
 int explore(args_t *args, flags_t *flags);
 
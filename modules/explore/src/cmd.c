@@ -16,10 +16,12 @@ ON_DRIVER_REGISTER_COMMANDS({
     flag_t sel[] = {flag_output(),
                     flag_input(),
                     flag_verbose(),
+                    flag_jobs(),
                     flag_temporary_directory(),
                     flag_no_preload(),
                     FLAG_EXPLORE_EXPECT_FAILURE,
                     FLAG_EXPLORE_MIN,
+                    FLAG_EXPLORE_DPOR,
                     flag_logger_file(),
                     0};
     subcmd_register(explore, "explore", "", "Exhaustively explore a trace",
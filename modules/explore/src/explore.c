@@ -1,5 +1,13 @@
+#include <errno.h>
+#include <ftw.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
+#include "frontier.h"
+#include "state.h"
 #include <lotto/base/envvar.h>
 #include <lotto/base/record.h>
 #include <lotto/base/tidset.h>
@@ -11,6 +19,7 @@
 #include <lotto/driver/flagmgr.h>
 #include <lotto/driver/flags/memmgr.h>
 #include <lotto/driver/flags/sequencer.h>
+#include <lotto/driver/jobs.h>
 #include <lotto/driver/preload.h>
 #include <lotto/driver/record.h>
 #include <lotto/driver/subcmd.h>
@@ -21,8 +30,16 @@
 #include <lotto/modules/explore/explore.h>
 #include <lotto/runtime/events.h>
 #include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+#include <sys/stat.h>
+
+/* Idle workers poll the frontier at this interval. */
+#define FRONTIER_IDLE_US 1000
 
 static uint64_t round_index;
+static char _replay[PATH_MAX];
+static frontier_t *_frontier;
 static const type_id ignored_types[] = {EVENT_TASK_CREATE, 0};
 
 static bool
@@ -54,6 +71,18 @@ _get_last_record_smaller_or_equal_than_clock(trace_t *recorder, uint64_t clock)
     return result;
 }
 
+static uint64_t
+_next_round(void)
+{
+    return _frontier ? frontier_round(_frontier) : round_index++;
+}
+
+static bool
+_stopped(void)
+{
+    return _frontier && frontier_stopped(_frontier);
+}
+
 static int
 _explore_interval(args_t *args, flags_t *flags, trace_t *input, uint64_t from,
                   uint64_t to, bool expect_failure)
@@ -64,8 +93,8 @@ _explore_interval(args_t *args, flags_t *flags, trace_t *input, uint64_t from,
     tidset_init(&choices);
     record_t *current_record;
     current_record = _get_last_record_smaller_or_equal_than_clock(input, to);
-    for (; expect_failure == is_error && from <= to && current_record &&
-           current_record->clk >= from;
+    for (; expect_failure == is_error && !_stopped() && from <= to &&
+           current_record && current_record->clk >= from;
          trace_forget(input),
          current_record =
              _get_last_record_smaller_or_equal_than_clock(input, to)) {
@@ -80,11 +109,11 @@ _explore_interval(args_t *args, flags_t *flags, trace_t *input, uint64_t from,
         clk_t clk = current_record->clk;
         for (size_t i = 0;
              ((!expect_failure && !err) || (expect_failure && err)) &&
-             i < tidset_size(&choices);
+             !_stopped() && i < tidset_size(&choices);
              i++) {
             cli_trace_schedule_task(input, tidset_get(&choices, i));
-            cli_trace_save(input, "temp.trace");
-            round_print(flags, round_index++);
+            cli_trace_save(input, _replay);
+            round_print(flags, _next_round());
             is_error = (err = execute(args, flags, false)) != 0;
             if ((expect_failure != is_error) || (expect_failure && err == 130))
                 break;
@@ -100,6 +129,620 @@ _explore_interval(args_t *args, flags_t *flags, trace_t *input, uint64_t from,
     return err;
 }
 
+/*******************************************************************************
+ * parallel exploration
+ *
+ * Workers share a frontier of items that a sequential explore would visit in
+ * depth-first order. Expanding a range pushes the rest of the range and the
+ * alternatives of its last step; exploring an alternative runs it and pushes
+ * the range of steps after it in the new trace. Whenever the items do not fit,
+ * the worker explores the subtree sequentially instead.
+ ******************************************************************************/
+
+static bool _expect_failure;
+
+static bool
+_explore_found(int err)
+{
+    return _expect_failure ? err == 0 || err == 130 : err != 0;
+}
+
+static int
+_frontier_range(args_t *args, flags_t *flags, uint64_t worker,
+                frontier_item_t item)
+{
+    char path[PATH_MAX];
+    frontier_trace_path(_frontier, item.trace, path);
+    trace_t *trace = cli_trace_load(path);
+
+    tidset_t choices;
+    tidset_init(&choices);
+    record_t *r;
+    for (r = _get_last_record_smaller_or_equal_than_clock(trace, item.clk);
+         r && r->clk >= item.from; trace_forget(trace),
+        r = _get_last_record_smaller_or_equal_than_clock(trace, item.clk)) {
+        statemgr_unmarshal(r->data, STATE_TYPE_PERSISTENT, true);
+        tidset_copy(&choices, get_available_tasks());
+        tidset_remove(&choices, r->id);
+        if (tidset_size(&choices) > 0) {
+            break;
+        }
+    }
+
+    int err = _expect_failure;
+    if (r == NULL || r->clk < item.from) {
+        frontier_trace_put(_frontier, item.trace);
+    } else if (frontier_space(_frontier, worker) <=
+               tidset_size(&choices)) {
+        frontier_trace_put(_frontier, item.trace);
+        err = _explore_interval(args, flags, trace, item.from, r->clk,
+                                _expect_failure);
+    } else {
+        // the rest of the range is visited last, so it goes to the bottom
+        clk_t clk     = r->clk;
+        size_t nitems = tidset_size(&choices) + (clk > item.from);
+        frontier_trace_get(_frontier, item.trace, (uint32_t)nitems);
+        frontier_trace_put(_frontier, item.trace);
+        if (clk > item.from) {
+            frontier_push(_frontier, worker,
+                          (frontier_item_t){.trace = item.trace,
+                                            .from  = item.from,
+                                            .clk   = clk - 1,
+                                            .task  = NO_TASK});
+        }
+        for (size_t i = tidset_size(&choices); i-- > 0;) {
+            frontier_push(_frontier, worker,
+                          (frontier_item_t){.trace = item.trace,
+                                            .clk   = clk,
+                                            .task  = tidset_get(&choices, i)});
+        }
+    }
+    tidset_fini(&choices);
+    trace_destroy(trace);
+    return err;
+}
+
+static int
+_frontier_alternative(args_t *args, flags_t *flags, uint64_t worker,
+                      frontier_item_t item)
+{
+    char path[PATH_MAX];
+    frontier_trace_path(_frontier, item.trace, path);
+    trace_t *prefix = cli_trace_load(path);
+    frontier_trace_put(_frontier, item.trace);
+
+    record_t *r = _get_last_record_smaller_or_equal_than_clock(prefix, item.clk);
+    ASSERT(r && r->clk == item.clk);
+    cli_trace_schedule_task(prefix, item.task);
+    cli_trace_save(prefix, _replay);
+    trace_destroy(prefix);
+
+    round_print(flags, _next_round());
+    int err = execute(args, flags, false);
+    if (_explore_found(err)) {
+        return err;
+    }
+
+    const char *output = flags_get_sval(flags, flag_output());
+    uint32_t slot      = frontier_trace_new(_frontier, 1);
+    if (slot != FRONTIER_NO_TRACE) {
+        frontier_trace_path(_frontier, slot, path);
+        if (frontier_space(_frontier, worker) > 0 &&
+            cp_clone(output, path) == 0) {
+            frontier_push(_frontier, worker,
+                          (frontier_item_t){.trace = slot,
+                                            .from  = item.clk + 1,
+                                            .clk   = UINT64_MAX,
+                                            .task  = NO_TASK});
+            return err;
+        }
+        frontier_trace_put(_frontier, slot);
+    }
+    trace_t *trace = cli_trace_load(output);
+    err = _explore_interval(args, flags, trace, item.clk + 1, UINT64_MAX,
+                            _expect_failure);
+    trace_destroy(trace);
+    return err;
+}
+
+static int
+_explore_worker(args_t *args, flags_t *flags, uint64_t job)
+{
+    // every worker replays and records in its own directory
+    sys_snprintf(_replay, PATH_MAX, "%s/replay.trace",
+                 flags_get_sval(flags, flag_temporary_directory()));
+    sys_setenv("LOTTO_RECORD", flags_get_sval(flags, flag_output()), true);
+    sys_setenv("LOTTO_REPLAY", _replay, true);
+
+    int err = _expect_failure;
+    frontier_item_t item;
+    while (!frontier_stopped(_frontier)) {
+        if (!frontier_take(_frontier, job, &item)) {
+            if (frontier_idle(_frontier)) {
+                break;
+            }
+            usleep(FRONTIER_IDLE_US);
+            continue;
+        }
+        err = item.task == NO_TASK ?
+                  _frontier_range(args, flags, job, item) :
+                  _frontier_alternative(args, flags, job, item);
+        frontier_done(_frontier);
+        if (_explore_found(err)) {
+            frontier_stop(_frontier, job);
+            break;
+        }
+    }
+
+    // run_jobs stops all workers at the first error, which is the schedule
+    // sought unless a failure is expected
+    if (_expect_failure) {
+        return err == 130 ? err : 0;
+    }
+    return err;
+}
+
+static int
+_explore_parallel(args_t *args, flags_t *flags, const char *dir, uint64_t min)
+{
+    uint64_t jobs = flags_get_uval(flags, flag_jobs());
+    if (jobs == 0) {
+        jobs = 1;
+    }
+    if (jobs > FRONTIER_MAX_WORKERS) {
+        sys_fprintf(stderr, "warning: limiting --jobs to %u\n",
+                    FRONTIER_MAX_WORKERS);
+        jobs = FRONTIER_MAX_WORKERS;
+    }
+    _frontier = frontier_init(dir, jobs);
+
+    // the input is the root of the tree, its range covers all steps
+    char path[PATH_MAX];
+    uint32_t root = frontier_trace_new(_frontier, 1);
+    frontier_trace_path(_frontier, root, path);
+    cli_trace_copy(flags_get_sval(flags, flag_input()), path);
+    frontier_push(_frontier, 0,
+                  (frontier_item_t){.trace = root,
+                                    .from  = min,
+                                    .clk   = UINT64_MAX,
+                                    .task  = NO_TASK});
+
+    // workers take their rounds from the frontier, in job directories
+    flags_set_by_opt(flags, flag_temporary_directory(), sval(dir));
+    int err        = run_workers(args, flags, _explore_worker, jobs);
+    int64_t winner = frontier_winner(_frontier);
+    if (_expect_failure && err == 0) {
+        if (winner >= 0 && jobs > 1) {
+            collect_job_output(flags, (uint64_t)winner);
+        }
+        err = winner >= 0 ? 0 : 1;
+    }
+
+    frontier_fini(_frontier);
+    _frontier = NULL;
+    return err;
+}
+
+static int
+_remove_entry(const char *path, const struct stat *sb, int flag,
+              struct FTW *ftwbuf)
+{
+    (void)sb;
+    (void)flag;
+    (void)ftwbuf;
+    return remove(path);
+}
+
+/*******************************************************************************
+ * dynamic partial-order reduction
+ *
+ * Every step of a run is a frame holding the enabled tasks and their next
+ * operations, as recorded by the runtime side of this module. A run is
+ * analyzed with vector clocks: for each step, the last earlier step of another
+ * task that it depends on but does not happen after is a race, and a task that
+ * reverses the race is added to the backtrack set of the earlier frame. Only
+ * backtrack alternatives are scheduled, and sleep sets skip alternatives that
+ * merely commute with an already explored one.
+ ******************************************************************************/
+
+typedef struct dpor_op {
+    uint32_t kind;
+    uint32_t size;
+    uintptr_t addr;
+} dpor_op_t;
+
+typedef struct dpor_pending {
+    task_id id;
+    dpor_op_t op;
+} dpor_pending_t;
+
+typedef struct dpor_frame {
+    clk_t clk;
+    task_id id;   /* task scheduled at this step */
+    dpor_op_t op; /* operation it executes */
+    bool branch;  /* whether alternatives are scheduled here */
+    tidset_t enabled;
+    tidset_t backtrack;
+    tidset_t done;
+    tidset_t sleep;
+    dpor_pending_t *pending; /* next operation of each task */
+    size_t npending;
+    size_t cap_pending;
+} dpor_frame_t;
+
+static struct {
+    dpor_frame_t *frames;
+    size_t cap;
+    uint64_t explored;
+    uint64_t pruned;
+    tidset_t child_sleep;
+    tidset_t seen;
+} _dpor;
+
+static dpor_frame_t *
+_dpor_frame(size_t k)
+{
+    if (k >= _dpor.cap) {
+        size_t cap   = _dpor.cap == 0 ? 256 : 2 * _dpor.cap;
+        _dpor.frames = sys_realloc(_dpor.frames, cap * sizeof(dpor_frame_t));
+        ASSERT(_dpor.frames);
+        for (size_t i = _dpor.cap; i < cap; i++) {
+            dpor_frame_t *f = &_dpor.frames[i];
+            *f              = (dpor_frame_t){0};
+            tidset_init(&f->enabled);
+            tidset_init(&f->backtrack);
+            tidset_init(&f->done);
+            tidset_init(&f->sleep);
+        }
+        _dpor.cap = cap;
+    }
+    return &_dpor.frames[k];
+}
+
+static void
+_dpor_fini(void)
+{
+    for (size_t i = 0; i < _dpor.cap; i++) {
+        dpor_frame_t *f = &_dpor.frames[i];
+        tidset_fini(&f->enabled);
+        tidset_fini(&f->backtrack);
+        tidset_fini(&f->done);
+        tidset_fini(&f->sleep);
+        sys_free(f->pending);
+    }
+    sys_free(_dpor.frames);
+    tidset_fini(&_dpor.child_sleep);
+    tidset_fini(&_dpor.seen);
+    _dpor = (typeof(_dpor)){0};
+}
+
+static dpor_op_t
+_dpor_op_of(const dpor_frame_t *f, task_id id)
+{
+    for (size_t i = 0; i < f->npending; i++) {
+        if (f->pending[i].id == id) {
+            return f->pending[i].op;
+        }
+    }
+    return (dpor_op_t){.kind = EXPLORE_OP_NONE};
+}
+
+static bool
+_dpor_dependent(const dpor_op_t *a, const dpor_op_t *b)
+{
+    if (a->kind == EXPLORE_OP_NONE || b->kind == EXPLORE_OP_NONE) {
+        return true;
+    }
+    if (a->kind == EXPLORE_OP_READ && b->kind == EXPLORE_OP_READ) {
+        return false;
+    }
+    return a->addr < b->addr + b->size && b->addr < a->addr + a->size;
+}
+
+/* Keeps the tasks of `sleep` that are enabled in `next` and whose pending
+ * operation in `f` commutes with `op`. */
+static void
+_dpor_sleep_filter(tidset_t *sleep, const dpor_frame_t *f, const dpor_op_t *op,
+                   const tidset_t *enabled)
+{
+    for (size_t i = tidset_size(sleep); i-- > 0;) {
+        task_id q      = tidset_get(sleep, i);
+        dpor_op_t q_op = _dpor_op_of(f, q);
+        if (!tidset_has(enabled, q) || _dpor_dependent(&q_op, op)) {
+            tidset_remove(sleep, q);
+        }
+    }
+}
+
+static record_t *
+_dpor_last_step(trace_t *trace)
+{
+    record_t *r;
+    for (r = trace_last(trace);
+         r && (!(r->kind & RECORD_SCHED) || _record_effective_type(r) == 0);
+         trace_forget(trace), r = trace_last(trace)) {}
+    return r;
+}
+
+/* Loads the steps of a run whose first `depth` steps are already known. */
+static size_t
+_dpor_load(trace_t *trace, size_t depth, uint64_t min)
+{
+    size_t k       = 0;
+    bool redundant = false;
+    for (record_t *r; (r = trace_next(trace, RECORD_SCHED)) != NULL;
+         trace_advance(trace)) {
+        if (_record_effective_type(r) == 0) {
+            continue;
+        }
+        if (k < depth) {
+            k++;
+            continue;
+        }
+        dpor_frame_t *f = _dpor_frame(k);
+        statemgr_unmarshal(r->data, STATE_TYPE_PERSISTENT, true);
+        f->clk = r->clk;
+        f->id  = r->id;
+        tidset_copy(&f->enabled, get_available_tasks());
+        tidset_clear(&f->backtrack);
+        tidset_clear(&f->done);
+        tidset_insert(&f->done, r->id);
+
+        tidmap_t *ops = explore_pending_ops();
+        f->npending   = 0;
+        if (tidmap_size(ops) > f->cap_pending) {
+            f->cap_pending = tidmap_size(ops);
+            f->pending     = sys_realloc(f->pending,
+                                         f->cap_pending * sizeof(dpor_pending_t));
+            ASSERT(f->pending);
+        }
+        for (const tiditem_t *cur = tidmap_iterate(ops); cur;
+             cur                  = tidmap_next(cur)) {
+            const explore_op_t *op = (const explore_op_t *)cur;
+            f->pending[f->npending++] =
+                (dpor_pending_t){.id = cur->key,
+                                 .op = {op->kind, op->size, op->addr}};
+        }
+        f->op = _dpor_op_of(f, r->id);
+
+        if (k == depth) {
+            tidset_copy(&f->sleep, &_dpor.child_sleep);
+            tidset_intersect(&f->sleep, &f->enabled);
+        } else {
+            const dpor_frame_t *prev = &_dpor.frames[k - 1];
+            tidset_copy(&f->sleep, &prev->sleep);
+            tidset_remove(&f->sleep, prev->id);
+            _dpor_sleep_filter(&f->sleep, prev, &prev->op, &f->enabled);
+        }
+
+        f->branch = !redundant && r->clk >= min &&
+                    !_types_has(ignored_types, _record_effective_type(r));
+
+        // a sleeping task only leads to interleavings explored elsewhere, so
+        // the rest of the run is not branched on and an awake task is tried
+        if (!redundant && tidset_has(&f->sleep, f->id)) {
+            redundant = true;
+            for (size_t i = 0; i < tidset_size(&f->enabled); i++) {
+                task_id q = tidset_get(&f->enabled, i);
+                if (!tidset_has(&f->sleep, q)) {
+                    tidset_insert(&f->backtrack, q);
+                    break;
+                }
+            }
+        }
+        k++;
+    }
+    return k;
+}
+
+static size_t
+_dpor_tid_index(task_id *tids, size_t *ntids, task_id id)
+{
+    for (size_t i = 0; i < *ntids; i++) {
+        if (tids[i] == id) {
+            return i;
+        }
+    }
+    tids[*ntids] = id;
+    return (*ntids)++;
+}
+
+static inline bool
+_dpor_hb(const uint32_t *vc, const size_t *idx, size_t ntids, size_t a,
+         size_t b)
+{
+    return vc[b * ntids + idx[a]] >= vc[a * ntids + idx[a]];
+}
+
+/* Schedules a reversal of the race between steps i and j at frame i. The
+ * reversed run starts with the steps after i that do not happen after it,
+ * followed by j; a task whose first step there has no predecessor can start
+ * it. Nothing is added if such a task is already scheduled at frame i, and
+ * every enabled task is added if none of them is enabled there. */
+static void
+_dpor_backtrack(size_t i, size_t j, const uint32_t *vc, const size_t *idx,
+                size_t ntids)
+{
+    dpor_frame_t *fi = &_dpor.frames[i];
+    if (!fi->branch) {
+        return;
+    }
+    task_id initial = NO_TASK;
+    tidset_clear(&_dpor.seen);
+    for (size_t k = i + 1; k <= j; k++) {
+        if (k != j && _dpor_hb(vc, idx, ntids, i, k)) {
+            continue;
+        }
+        task_id q = _dpor.frames[k].id;
+        if (!tidset_insert(&_dpor.seen, q) || !tidset_has(&fi->enabled, q)) {
+            continue;
+        }
+        bool first = true;
+        for (size_t m = i + 1; m < k && first; m++) {
+            first = _dpor_hb(vc, idx, ntids, i, m) ||
+                    !_dpor_hb(vc, idx, ntids, m, k);
+        }
+        if (!first) {
+            continue;
+        }
+        if (tidset_has(&fi->backtrack, q) || tidset_has(&fi->done, q)) {
+            return;
+        }
+        if (initial == NO_TASK) {
+            initial = q;
+        }
+    }
+    if (initial != NO_TASK) {
+        tidset_insert(&fi->backtrack, initial);
+    } else {
+        tidset_union(&fi->backtrack, &fi->enabled);
+    }
+}
+
+static void
+_dpor_analyze(size_t n)
+{
+    task_id *tids = sys_malloc(n * sizeof(task_id) + 1);
+    size_t *idx   = sys_malloc(n * sizeof(size_t) + 1);
+    size_t ntids  = 0;
+    ASSERT(tids && idx);
+    for (size_t k = 0; k < n; k++) {
+        idx[k] = _dpor_tid_index(tids, &ntids, _dpor.frames[k].id);
+    }
+
+    uint32_t *vc = sys_calloc(n * ntids + 1, sizeof(uint32_t));
+    size_t *last = sys_malloc(ntids * sizeof(size_t) + 1);
+    ASSERT(vc && last);
+    for (size_t t = 0; t < ntids; t++) {
+        last[t] = SIZE_MAX;
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        size_t t     = idx[j];
+        uint32_t *vj = vc + j * ntids;
+        uint32_t own = 0;
+        if (last[t] != SIZE_MAX) {
+            sys_memcpy(vj, vc + last[t] * ntids, ntids * sizeof(uint32_t));
+            own = vj[t];
+        }
+
+        // every step that j depends on without happening after it races with
+        // j, so the analysis of a complete run misses no reversal
+        for (size_t i = j; i-- > 0;) {
+            size_t u           = idx[i];
+            const uint32_t *vi = vc + i * ntids;
+            if (u == t || vj[u] >= vi[u] ||
+                !_dpor_dependent(&_dpor.frames[i].op, &_dpor.frames[j].op)) {
+                continue;
+            }
+            _dpor_backtrack(i, j, vc, idx, ntids);
+            for (size_t v = 0; v < ntids; v++) {
+                vj[v] = vj[v] > vi[v] ? vj[v] : vi[v];
+            }
+        }
+        vj[t]   = own + 1;
+        last[t] = j;
+    }
+
+    sys_free(last);
+    sys_free(vc);
+    sys_free(idx);
+    sys_free(tids);
+}
+
+static task_id
+_dpor_next(const dpor_frame_t *f)
+{
+    for (size_t i = 0; i < tidset_size(&f->backtrack); i++) {
+        task_id q = tidset_get(&f->backtrack, i);
+        if (tidset_has(&f->enabled, q) && !tidset_has(&f->done, q) &&
+            !tidset_has(&f->sleep, q)) {
+            return q;
+        }
+    }
+    return NO_TASK;
+}
+
+static int
+_dpor_explore(args_t *args, flags_t *flags, const char *fn, size_t depth,
+              uint64_t min, bool expect_failure)
+{
+    trace_t *scan = cli_trace_load(fn);
+    size_t n      = _dpor_load(scan, depth, min);
+    trace_destroy(scan);
+    _dpor_analyze(n);
+
+    int err         = expect_failure;
+    trace_t *input  = cli_trace_load(fn);
+    const char *out = flags_get_sval(flags, flag_output());
+    tidset_t rest;
+    tidset_init(&rest);
+    size_t k = n;
+    for (record_t *r = _dpor_last_step(input); r && k > depth;
+         trace_forget(input), r = _dpor_last_step(input)) {
+        dpor_frame_t *f = &_dpor.frames[--k];
+        ASSERT(f->clk == r->clk);
+
+        for (task_id p; f->branch && (p = _dpor_next(f)) != NO_TASK;) {
+            tidset_insert(&f->done, p);
+            f->id = p;
+            f->op = _dpor_op_of(f, p);
+
+            // explored siblings sleep while the child commutes with them
+            tidset_copy(&_dpor.child_sleep, &f->sleep);
+            tidset_union(&_dpor.child_sleep, &f->done);
+            tidset_remove(&_dpor.child_sleep, p);
+            _dpor_sleep_filter(&_dpor.child_sleep, f, &f->op, &f->enabled);
+
+            cli_trace_schedule_task(input, p);
+            cli_trace_save(input, _replay);
+            round_print(flags, round_index++);
+            _dpor.explored++;
+            bool is_error = (err = execute(args, flags, false)) != 0;
+            if (expect_failure != is_error || (expect_failure && err == 130)) {
+                goto out;
+            }
+            err = _dpor_explore(args, flags, out, k + 1, min, expect_failure);
+            if (expect_failure != (err != 0)) {
+                goto out;
+            }
+        }
+
+        tidset_copy(&rest, &f->enabled);
+        tidset_subtract(&rest, &f->done);
+        _dpor.pruned += tidset_size(&rest);
+    }
+out:
+    tidset_fini(&rest);
+    trace_destroy(input);
+    return err;
+}
+
+static int
+_dpor_run(args_t *args, flags_t *flags, uint64_t min, bool expect_failure)
+{
+    // replay the input once so that its steps carry the pending operations
+    sys_setenv("LOTTO_EXPLORE_DPOR", "1", true);
+    explore_pending_ops_register();
+    cli_trace_copy(flags_get_sval(flags, flag_input()), _replay);
+    tidset_init(&_dpor.child_sleep);
+    tidset_init(&_dpor.seen);
+    round_print(flags, round_index++);
+    _dpor.explored = 1;
+
+    int err = execute(args, flags, false);
+    if (expect_failure == (err != 0) && !(expect_failure && err == 130)) {
+        err = _dpor_explore(args, flags, flags_get_sval(flags, flag_output()),
+                            0, min, expect_failure);
+    }
+    sys_fprintf(stdout,
+                "[lotto] dpor: %lu interleavings explored, %lu alternatives "
+                "pruned\n",
+                _dpor.explored, _dpor.pruned);
+    _dpor_fini();
+    return err;
+}
+
 int
 explore(args_t *args, flags_t *flags)
 {
@@ -110,11 +753,24 @@ explore(args_t *args, flags_t *flags)
             flags_get_sval(flags, flag_memmgr_runtime()),
             flags_get_sval(flags, flag_memmgr_user()));
 
+    // replayed prefixes go to a directory of this explore only, so that
+    // several explores can share a working directory
+    char dir[PATH_MAX];
+    sys_snprintf(dir, PATH_MAX, "%s/explore-XXXXXX",
+                 flags_get_sval(flags, flag_temporary_directory()));
+    if (mkdtemp(dir) == NULL) {
+        sys_fprintf(stderr,
+                    "error: could not create explore directory '%s': %s\n",
+                    dir, strerror(errno));
+        return 1;
+    }
+    sys_snprintf(_replay, PATH_MAX, "%s/replay.trace", dir);
+
     envvar_t vars[] = {
         {"LOTTO_LOGGER_FILE",
          .sval = flags_get_sval(flags, flag_logger_file())},
         {"LOTTO_RECORD", .sval = flags_get_sval(flags, flag_output())},
-        {"LOTTO_REPLAY", .sval = "temp.trace"},
+        {"LOTTO_REPLAY", .sval = _replay},
         NULL};
     envvar_set(vars, true);
 
@@ -129,11 +785,13 @@ explore(args_t *args, flags_t *flags)
 
     args = record_args(first);
 
-    round_index         = 0;
-    bool expect_failure = flags_is_on(flags, FLAG_EXPLORE_EXPECT_FAILURE);
-    uint64_t min        = flags_get_uval(flags, FLAG_EXPLORE_MIN);
-    int err =
-        _explore_interval(args, flags, trace, min, UINT64_MAX, expect_failure);
+    round_index     = 0;
+    _expect_failure = flags_is_on(flags, FLAG_EXPLORE_EXPECT_FAILURE);
+    uint64_t min    = flags_get_uval(flags, FLAG_EXPLORE_MIN);
+    int err = flags_is_on(flags, FLAG_EXPLORE_DPOR) ?
+                  _dpor_run(args, flags, min, _expect_failure) :
+                  _explore_parallel(args, flags, dir, min);
     trace_destroy(trace);
+    (void)nftw(dir, _remove_entry, 16, FTW_DEPTH | FTW_PHYS);
     return err;
 }
@@ -0,0 +1,214 @@
+#include <limits.h>
+#include <unistd.h>
+
+#include "frontier.h"
+#include <lotto/sys/assert.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/string.h>
+#include <sys/mman.h>
+#include <vsync/atomic.h>
+#include <vsync/spinlock/caslock.h>
+
+typedef struct frontier_deque {
+    caslock_t lock;
+    uint64_t top;
+    uint64_t bottom;
+    frontier_item_t items[FRONTIER_DEQUE_SIZE];
+} __attribute__((aligned(64))) frontier_deque_t;
+
+struct frontier {
+    char dir[PATH_MAX];
+    uint64_t workers;
+    size_t len;
+    vatomic64_t pending; /* pushed items not explored yet */
+    vatomic64_t rounds;
+    vatomic32_t winner; /* winning worker plus one */
+    vatomic32_t hint;
+    vatomic32_t refs[FRONTIER_TRACES];
+    frontier_deque_t deques[];
+};
+
+frontier_t *
+frontier_init(const char *dir, uint64_t workers)
+{
+    ASSERT(workers > 0 && workers <= FRONTIER_MAX_WORKERS);
+
+    // zero-filled shared pages hold empty, unlocked deques
+    size_t len    = sizeof(frontier_t) + workers * sizeof(frontier_deque_t);
+    frontier_t *f = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT(f != MAP_FAILED);
+
+    sys_snprintf(f->dir, PATH_MAX, "%s", dir);
+    f->workers = workers;
+    f->len     = len;
+    return f;
+}
+
+void
+frontier_fini(frontier_t *f)
+{
+    munmap(f, f->len);
+}
+
+/*******************************************************************************
+ * deques
+ ******************************************************************************/
+
+uint64_t
+frontier_space(frontier_t *f, uint64_t worker)
+{
+    frontier_deque_t *d = &f->deques[worker];
+    caslock_acquire(&d->lock);
+    uint64_t space = FRONTIER_DEQUE_SIZE - (d->bottom - d->top);
+    caslock_release(&d->lock);
+    return space;
+}
+
+bool
+frontier_push(frontier_t *f, uint64_t worker, frontier_item_t item)
+{
+    frontier_deque_t *d = &f->deques[worker];
+    caslock_acquire(&d->lock);
+    bool ok = d->bottom - d->top < FRONTIER_DEQUE_SIZE;
+    if (ok) {
+        // counted before it can be taken, so that the frontier never looks
+        // idle while an item is in flight
+        vatomic64_inc(&f->pending);
+        d->items[d->bottom++ % FRONTIER_DEQUE_SIZE] = item;
+    }
+    caslock_release(&d->lock);
+    return ok;
+}
+
+static bool
+_frontier_pop(frontier_deque_t *d, frontier_item_t *item)
+{
+    caslock_acquire(&d->lock);
+    bool ok = d->bottom != d->top;
+    if (ok) {
+        *item = d->items[--d->bottom % FRONTIER_DEQUE_SIZE];
+    }
+    caslock_release(&d->lock);
+    return ok;
+}
+
+static bool
+_frontier_steal(frontier_deque_t *d, frontier_item_t *item)
+{
+    caslock_acquire(&d->lock);
+    bool ok = d->bottom != d->top;
+    if (ok) {
+        *item = d->items[d->top++ % FRONTIER_DEQUE_SIZE];
+    }
+    caslock_release(&d->lock);
+    return ok;
+}
+
+bool
+frontier_take(frontier_t *f, uint64_t worker, frontier_item_t *item)
+{
+    if (_frontier_pop(&f->deques[worker], item)) {
+        return true;
+    }
+    // the top of a deque holds the shallowest alternatives, which are the
+    // largest subtrees left
+    for (uint64_t i = 1; i < f->workers; i++) {
+        if (_frontier_steal(&f->deques[(worker + i) % f->workers], item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+frontier_done(frontier_t *f)
+{
+    vatomic64_dec(&f->pending);
+}
+
+bool
+frontier_idle(frontier_t *f)
+{
+    return vatomic64_read(&f->pending) == 0;
+}
+
+/*******************************************************************************
+ * traces
+ ******************************************************************************/
+
+uint32_t
+frontier_trace_new(frontier_t *f, uint32_t refs)
+{
+    ASSERT(refs > 0);
+    uint32_t start = vatomic32_get_inc(&f->hint);
+    for (uint32_t i = 0; i < FRONTIER_TRACES; i++) {
+        uint32_t slot = (start + i) % FRONTIER_TRACES;
+        if (vatomic32_read(&f->refs[slot]) == 0 &&
+            vatomic32_cmpxchg(&f->refs[slot], 0, refs) == 0) {
+            return slot;
+        }
+    }
+    return FRONTIER_NO_TRACE;
+}
+
+void
+frontier_trace_get(frontier_t *f, uint32_t slot, uint32_t refs)
+{
+    vatomic32_add(&f->refs[slot], refs);
+}
+
+void
+frontier_trace_put(frontier_t *f, uint32_t slot)
+{
+    for (;;) {
+        uint32_t refs = vatomic32_read(&f->refs[slot]);
+        ASSERT(refs > 0);
+        if (refs == 1) {
+            // nobody else holds the slot, release it only once the file is
+            // gone so that a new trace cannot be removed in its place
+            char path[PATH_MAX];
+            frontier_trace_path(f, slot, path);
+            (void)unlink(path);
+            vatomic32_write(&f->refs[slot], 0);
+            return;
+        }
+        if (vatomic32_cmpxchg(&f->refs[slot], refs, refs - 1) == refs) {
+            return;
+        }
+    }
+}
+
+void
+frontier_trace_path(const frontier_t *f, uint32_t slot, char *path)
+{
+    sys_snprintf(path, PATH_MAX, "%s/frontier-%u.trace", f->dir, slot);
+}
+
+/*******************************************************************************
+ * rounds and early stop
+ ******************************************************************************/
+
+uint64_t
+frontier_round(frontier_t *f)
+{
+    return vatomic64_get_inc(&f->rounds);
+}
+
+bool
+frontier_stop(frontier_t *f, uint64_t worker)
+{
+    return vatomic32_cmpxchg(&f->winner, 0, (uint32_t)worker + 1) == 0;
+}
+
+bool
+frontier_stopped(frontier_t *f)
+{
+    return vatomic32_read(&f->winner) != 0;
+}
+
+int64_t
+frontier_winner(frontier_t *f)
+{
+    return (int64_t)vatomic32_read(&f->winner) - 1;
+}
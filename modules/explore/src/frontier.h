@@ -0,0 +1,107 @@
+/**
+ * @file frontier.h
+ * @brief Explore declarations for the shared frontier of schedule prefixes.
+ *
+ * The frontier lives in shared memory mapped before the workers are forked.
+ * An item is either an unexplored alternative, i.e., a prefix of a saved trace
+ * up to a clock and the task forced at that clock, or a range of steps of a
+ * saved trace whose alternatives are not expanded yet. Every worker owns a
+ * deque, pushing and popping its own items at the bottom, in the depth-first
+ * order of a sequential explore, while idle workers steal from the top of the
+ * others. Saved traces are reference counted by the items referring to them.
+ */
+#ifndef LOTTO_EXPLORE_FRONTIER_H
+#define LOTTO_EXPLORE_FRONTIER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lotto/base/clk.h>
+#include <lotto/base/task_id.h>
+
+#define FRONTIER_MAX_WORKERS 256U
+#define FRONTIER_DEQUE_SIZE  1024U
+#define FRONTIER_TRACES      4096U
+#define FRONTIER_NO_TRACE    UINT32_MAX
+
+typedef struct frontier_item {
+    uint32_t trace; /* slot of the saved trace */
+    clk_t from;     /* first step of a range */
+    clk_t clk;      /* last step of a range, or the step replaced */
+    task_id task;   /* task forced at `clk`, or NO_TASK for a range */
+} frontier_item_t;
+
+typedef struct frontier frontier_t;
+
+/**
+ * Maps a frontier for `workers` workers whose traces are saved in `dir`.
+ */
+frontier_t *frontier_init(const char *dir, uint64_t workers);
+void frontier_fini(frontier_t *f);
+
+/**
+ * Returns the number of items `worker` can still push.
+ */
+uint64_t frontier_space(frontier_t *f, uint64_t worker);
+
+/**
+ * Pushes an item to the bottom of the deque of `worker`.
+ */
+bool frontier_push(frontier_t *f, uint64_t worker, frontier_item_t item);
+
+/**
+ * Pops the bottom item of the deque of `worker`, or steals the top item of
+ * another deque if it is empty.
+ */
+bool frontier_take(frontier_t *f, uint64_t worker, frontier_item_t *item);
+
+/**
+ * Marks a taken item as explored, after its alternatives were pushed.
+ */
+void frontier_done(frontier_t *f);
+
+/**
+ * Returns whether every pushed item was explored.
+ */
+bool frontier_idle(frontier_t *f);
+
+/**
+ * Allocates a trace slot holding `refs` references, or returns
+ * FRONTIER_NO_TRACE if all slots are in use.
+ */
+uint32_t frontier_trace_new(frontier_t *f, uint32_t refs);
+
+/**
+ * Adds `refs` references to a trace slot.
+ */
+void frontier_trace_get(frontier_t *f, uint32_t slot, uint32_t refs);
+
+/**
+ * Drops a reference to a trace slot, removing the trace with the last one.
+ */
+void frontier_trace_put(frontier_t *f, uint32_t slot);
+
+/**
+ * Writes the path of the trace saved in `slot` to `path`.
+ */
+void frontier_trace_path(const frontier_t *f, uint32_t slot, char *path);
+
+/**
+ * Returns a round index unique among all workers.
+ */
+uint64_t frontier_round(frontier_t *f);
+
+/**
+ * Stops all workers. The first worker to stop wins.
+ *
+ * @return true if `worker` is the first one
+ */
+bool frontier_stop(frontier_t *f, uint64_t worker);
+bool frontier_stopped(frontier_t *f);
+
+/**
+ * Returns the worker that stopped the frontier, or -1.
+ */
+int64_t frontier_winner(frontier_t *f);
+
+#endif
@@ -0,0 +1,96 @@
+#include "state.h"
+#include <lotto/engine/sequencer.h>
+#include <lotto/engine/statemgr.h>
+#include <lotto/modules/mutex/events.h>
+#include <lotto/modules/rwlock/events.h>
+#include <lotto/runtime/events.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/util/macros.h>
+
+static bool _enabled;
+
+STATEMGR_REGISTER(PERSISTENT, {
+    _enabled = sys_getenv("LOTTO_EXPLORE_DPOR") != NULL;
+    if (_enabled)
+        explore_pending_ops_register();
+})
+
+static void
+_op_init(explore_op_t *op, uint32_t kind, uintptr_t addr, size_t size)
+{
+    op->kind = kind;
+    op->addr = addr;
+    op->size = size == 0 ? 1 : (uint32_t)size;
+}
+
+/* Captures the operation that the task executes when it is scheduled next.
+ * Every such operation is made a change point, so that a step executes a
+ * single operation and its pending operation describes all of it. */
+STATIC void
+_explore_handle(const capture_point *cp, event_t *e)
+{
+    if (!_enabled) {
+        return;
+    }
+    ASSERT(cp);
+
+    tidmap_t *ops = explore_pending_ops();
+    if (cp->type_id == EVENT_TASK_FINI) {
+        tidmap_deregister(ops, cp->id);
+        return;
+    }
+    explore_op_t *op = (explore_op_t *)tidmap_find(ops, cp->id);
+    if (op == NULL) {
+        op = (explore_op_t *)tidmap_register(ops, cp->id);
+        ASSERT(op);
+    }
+
+    switch (cp->type_id) {
+        case EVENT_MA_READ:
+        case EVENT_MA_AREAD:
+            _op_init(op, EXPLORE_OP_READ, memaccess_addr(cp),
+                     memaccess_size(cp));
+            break;
+        case EVENT_MA_WRITE:
+        case EVENT_MA_AWRITE:
+        case EVENT_MA_RMW:
+        case EVENT_MA_XCHG:
+        case EVENT_MA_CMPXCHG:
+        case EVENT_MA_CMPXCHG_WEAK:
+            _op_init(op, EXPLORE_OP_WRITE, memaccess_addr(cp),
+                     memaccess_size(cp));
+            break;
+        case EVENT_MUTEX_ACQUIRE:
+        case EVENT_MUTEX_TRYACQUIRE:
+        case EVENT_MUTEX_RELEASE:
+            _op_init(op, EXPLORE_OP_WRITE, mutex_event_addr(cp), 1);
+            break;
+        // read locks commute with each other, anything else on the lock
+        // does not
+        case EVENT_RWLOCK_RDLOCK:
+        case EVENT_RWLOCK_TRYRDLOCK:
+        case EVENT_RWLOCK_TIMEDRDLOCK:
+            _op_init(op, EXPLORE_OP_READ,
+                     (uintptr_t)CP_PAYLOAD(struct rwlock_rdlock_event *)->lock,
+                     1);
+            break;
+        case EVENT_RWLOCK_WRLOCK:
+        case EVENT_RWLOCK_TRYWRLOCK:
+        case EVENT_RWLOCK_TIMEDWRLOCK:
+        case EVENT_RWLOCK_UNLOCK:
+            _op_init(op, EXPLORE_OP_WRITE,
+                     (uintptr_t)CP_PAYLOAD(struct rwlock_wrlock_event *)->lock,
+                     1);
+            break;
+        default:
+            _op_init(op, EXPLORE_OP_NONE, 0, 0);
+            break;
+    }
+
+    if (op->kind != EXPLORE_OP_NONE && cp->chain_id != CHAIN_INGRESS_AFTER &&
+        !e->readonly && !e->is_chpt) {
+        e->reason  = REASON_DETERMINISTIC;
+        e->is_chpt = true;
+    }
+}
+ON_SEQUENCER_CAPTURE(_explore_handle);
@@ -0,0 +1,43 @@
+#include "state.h"
+#include <lotto/engine/statemgr.h>
+#include <lotto/sys/logger.h>
+#include <lotto/util/macros.h>
+
+#define MARSHABLE_OP MARSHABLE_STATIC(sizeof(explore_op_t))
+
+static tidmap_t _pending_ops;
+
+STATIC void
+_explore_print(const marshable_t *m)
+{
+    const tidmap_t *map = (const tidmap_t *)m;
+    logger_infof("pending operations (tid, kind, addr, size) = [");
+    bool first = true;
+    for (const tiditem_t *cur = tidmap_iterate(map); cur;
+         cur                  = tidmap_next(cur)) {
+        const explore_op_t *op = (const explore_op_t *)cur;
+        logger_printf("%s(%lu, %u, 0x%lx, %u)", first ? "" : ", ", cur->key,
+                      op->kind, op->addr, op->size);
+        first = false;
+    }
+    logger_println("]");
+}
+
+void
+explore_pending_ops_register(void)
+{
+    static bool registered = false;
+    if (registered)
+        return;
+    registered = true;
+    tidmap_init(&_pending_ops, MARSHABLE_OP);
+    _pending_ops.m.print = _explore_print;
+    statemgr_register(DICE_MODULE_SLOT, &_pending_ops.m,
+                      STATE_TYPE_PERSISTENT);
+}
+
+tidmap_t *
+explore_pending_ops(void)
+{
+    return &_pending_ops;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file state.h
+ * @brief Explore module state declarations.
+ *
+ * When LOTTO_EXPLORE_DPOR is set, every recorded change point carries the
+ * next operation of each task, which `lotto explore --explore-dpor` uses to
+ * decide whether two steps commute. Otherwise the pending operations are not
+ * registered and traces do not carry them.
+ */
+#ifndef LOTTO_STATE_EXPLORE_H
+#define LOTTO_STATE_EXPLORE_H
+
+#include <stdint.h>
+
+#include <lotto/base/tidmap.h>
+
+enum explore_op_kind {
+    EXPLORE_OP_NONE = 0, /* unknown operation, dependent on everything */
+    EXPLORE_OP_READ,
+    EXPLORE_OP_WRITE,
+};
+
+typedef struct explore_op {
+    tiditem_t t;
+    uint32_t kind;
+    uint32_t size;
+    uintptr_t addr;
+} explore_op_t;
+
+/**
+ * Registers the pending operations as persistent state. The runtime and the
+ * driver must both register them, and only when DPOR is on, so that they
+ * agree on the recorded states.
+ */
+void explore_pending_ops_register(void);
+tidmap_t *explore_pending_ops(void);
+
+#endif
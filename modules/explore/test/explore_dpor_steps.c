@@ -0,0 +1,42 @@
+// clang-format off
+// RUN: %lotto %stress --record-granularity CHPT -r 1 -- %b || true
+// RUN: (! %lotto %explore --explore-dpor 2>&1) | %check %s
+// CHECK: assert failed {{.*}}/explore_dpor_steps.c:{{[0-9]+}}: seen == 0
+// clang-format on
+
+#include <assert.h>
+#include <pthread.h>
+
+/* The write of b directly follows the write of a. If both were one step, the
+ * step would only be known by its write of a, which commutes with the read of
+ * b, and DPOR would never run the writer before the reader. */
+int a;
+int b;
+
+void *
+writer(void *arg)
+{
+    a = 1;
+    b = 1;
+    return arg;
+}
+
+void *
+reader(void *arg)
+{
+    int seen = b;
+    assert(seen == 0);
+    return arg;
+}
+
+int
+main()
+{
+    pthread_t t1, t2;
+    pthread_create(&t1, 0, reader, 0);
+    pthread_create(&t2, 0, writer, 0);
+
+    pthread_join(t1, 0);
+    pthread_join(t2, 0);
+    return 0;
+}
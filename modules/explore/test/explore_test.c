@@ -2,6 +2,14 @@
 // RUN: %lotto %stress --record-granularity CHPT -r 1 -- %b || true
 // RUN: (! %lotto %explore 3>&2 2>&1 1>&3) | tail | %check %s
 // CHECK: assert failed {{.*}}/explore_test.c:{{[0-9]+}}: x != 0b11
+// RUN: %lotto %stress --record-granularity CHPT -r 1 -- %b || true
+// RUN: (! %lotto %explore --explore-dpor 2>&1) | %check %s --check-prefix=DPOR
+// DPOR: assert failed {{.*}}/explore_test.c:{{[0-9]+}}: x != 0b11
+// DPOR: [lotto] dpor: {{[0-9]+}} interleavings explored, {{[0-9]+}} alternatives pruned
+// RUN: %lotto %stress --record-granularity CHPT -r 1 -- %b || true
+// RUN: (! %lotto %explore --jobs 2 2>&1) | %check %s
+// RUN: %lotto %explore --explore-failure --jobs 2
+// RUN: (! ls -d %T/explore-* 2>/dev/null)
 // clang-format on
 
 #include <assert.h>
@@ -33,8 +33,10 @@
 #include <lotto/engine/statemgr.h>
 #include <lotto/modules/explore/explore.h>
 #include <lotto/modules/qemu_snapshot/final.h>
+#include <lotto/sys/logger.h>
 #include <lotto/sys/now.h>
 #include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
 #include <lotto/sys/stream_file.h>
 #include <sys/stat.h>
 
@@ -420,10 +422,63 @@ _produce_full_trace_and_set_input(args_t *args, flags_t *flags)
     return true;
 }
 
+static void
+_dump_record(stream_t *st, trace_index_t *ix, const record_t *r)
+{
+    trace_index_add(ix, r);
+    if (stream_write(st, (const char *)r, sizeof(record_t) + r->size) == 0)
+        logger_fatalf("failed to dump record");
+}
+
+/* Copies the prefix of a sealed trace without loading the whole trace. */
+static clk_t
+_truncate_sealed(trace_reader_t *tr, const char *output, clk_t target)
+{
+    stream_t *st      = stream_file_alloc();
+    trace_index_t *ix = sys_malloc(sizeof(trace_index_t));
+    stream_file_out(st, output);
+    trace_index_init(ix);
+
+    record_t *r    = NULL;
+    clk_t last_clk = 0;
+    bool empty     = true;
+    while ((r = trace_reader_next(tr)) != NULL && r->clk <= target) {
+        _dump_record(st, ix, r);
+        last_clk = r->clk;
+        empty    = false;
+        sys_free(r);
+    }
+    sys_free(r);
+
+    clk_t result = 0;
+    if (!empty && last_clk < target) {
+        result  = last_clk;
+        r       = record_alloc(0);
+        r->kind = RECORD_OPAQUE;
+        r->clk  = target;
+        _dump_record(st, ix, r);
+        sys_free(r);
+    }
+    if (!trace_index_seal(ix, st))
+        logger_fatalf("failed to dump trace footer");
+
+    stream_close(st);
+    sys_free(st);
+    sys_free(ix);
+    return result;
+}
+
 static clk_t
 _truncate_trace(const char *input, const char *output,
                 clk_t target /* inclusive */)
 {
+    trace_reader_t *tr = cli_trace_reader(input);
+    if (tr != NULL) {
+        clk_t last_clk = _truncate_sealed(tr, output, target);
+        trace_reader_close(tr);
+        return last_clk;
+    }
+
     trace_t *rec   = cli_trace_load(input);
     record_t *r    = NULL;
     clk_t last_clk = 0;
@@ -442,11 +497,22 @@ _truncate_trace(const char *input, const char *output,
     return last_clk;
 }
 
+/* Returns the clock of the last record if it is after `clk`, or `clk`. */
 static clk_t
 _next_clock(const char *input, clk_t clk)
 {
+    clk_t ans          = clk;
+    trace_reader_t *tr = cli_trace_reader(input);
+    if (tr != NULL) {
+        record_t *r = trace_reader_last(tr);
+        if (r != NULL && r->clk > ans)
+            ans = r->clk;
+        sys_free(r);
+        trace_reader_close(tr);
+        return ans;
+    }
+
     trace_t *rec = cli_trace_load(input);
-    clk_t ans    = clk;
     for (record_t *r; (r = trace_last(rec)) && r->clk > ans; trace_forget(rec))
         ans = r->clk;
     trace_destroy(rec);
@@ -456,9 +522,22 @@ _next_clock(const char *input, clk_t clk)
 static clk_t
 _previous_clock(const char *input, clk_t clk)
 {
+    clk_t ans          = clk;
+    trace_reader_t *tr = cli_trace_reader(input);
+    if (tr != NULL) {
+        record_t *r = NULL;
+        trace_reader_seek(tr, clk);
+        while ((r = trace_reader_next(tr)) != NULL && r->clk < clk) {
+            ans = r->clk;
+            sys_free(r);
+        }
+        sys_free(r);
+        trace_reader_close(tr);
+        return ans;
+    }
+
     trace_t *rec = cli_trace_load(input);
     trace_next(rec, RECORD_START);
-    clk_t ans = clk;
     for (record_t *r; (r = trace_next(rec, RECORD_ANY)) && r->clk < clk;
          trace_advance(rec))
         ans = r->clk;
@@ -1,6 +1,8 @@
 #ifndef DISABLE_EXECINFO
     #include <execinfo.h>
 #endif
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <lotto/sys/assert.h>
@@ -8,26 +10,72 @@
 #include <lotto/sys/real.h>
 #include <lotto/sys/stdlib.h>
 #include <lotto/sys/string.h>
+#include <vsync/atomic.h>
 #include <vsync/spinlock/caslock.h>
 
 #define MAX_FRAMES 10
 
+/* Live allocations are kept in address-sharded, doubly linked lists so that
+ * a free unlinks its header in O(1) under the lock of a single shard. */
+#define ALLOC_SHARDS 64U
+#define ALLOC_MAGIC  0x1eacU
+
+/* Stacks are interned in a fixed-size depot; allocations only keep the id.
+ * Id 0 stands for an unknown stack, e.g., when the depot is full. */
+#define DEPOT_SIZE   (1U << 14)
+#define DEPOT_PROBES 64U
+
+/* Upper bound on a single stack frame while walking frame pointers. Code
+ * compiled without frame pointers leaves arbitrary values in the chain, so the
+ * walk stops at the first link that leaves the stack of the thread or does not
+ * point a little up the stack. */
+#define MAX_FRAME_SIZE (1UL << 16)
+
 struct alloc {
-    void *btrace[MAX_FRAMES];
-    int btsize;
+    struct alloc *prev;
     struct alloc *next;
     size_t size;
+    uint32_t stack_id;
+    uint16_t shard;
+    uint16_t magic;
     char data[0];
 };
 
-typedef struct leakcheck {
+typedef struct alloc_shard {
     caslock_t lock;
+    struct alloc *head;
+} __attribute__((aligned(64))) alloc_shard_t;
+
+enum stack_state {
+    STACK_FREE  = 0,
+    STACK_BUSY  = 1,
+    STACK_READY = 2,
+};
+
+typedef struct depot_stack {
+    vatomic32_t state;
+    uint32_t hash;
+    uint32_t depth;
+    uintptr_t pcs[MAX_FRAMES];
+    // leak aggregation, only used at fini
+    size_t leaked_size;
+    size_t leaked_count;
+    void *leaked_sample;
+} depot_stack_t;
+
+typedef struct leakcheck {
     bool fini;
-    struct alloc list;
+    alloc_shard_t shards[ALLOC_SHARDS];
+    depot_stack_t depot[DEPOT_SIZE];
 } leakcheck_t;
 
 static leakcheck_t _lc;
 
+/* Stack extent of the thread, [0, UINTPTR_MAX) if it cannot be found.
+ * _stack_hi is 0 until the extent is probed. */
+static __thread uintptr_t _stack_lo;
+static __thread uintptr_t _stack_hi;
+
 REAL_DECL(void *, memmgr_alloc, size_t n);
 REAL_DECL(void *, memmgr_realloc, void *p, size_t n);
 REAL_DECL(void, memmgr_free, void *p);
@@ -48,9 +96,143 @@ memmgr_init()
     ASSERT(REAL_NAME(memmgr_realloc) != NULL);
     ASSERT(REAL_NAME(memmgr_free) != NULL);
 
-    caslock_init(&_lc.lock);
+    // zero-initialized shards are unlocked and empty
     _lc.fini = false;
-    _lc.list = (struct alloc){};
+}
+
+/*******************************************************************************
+ * stack depot
+ ******************************************************************************/
+
+/* pthread_getattr_np allocates, so the extent is unbounded while probing and
+ * allocations meanwhile do not probe again. */
+static void
+_stack_bounds(uintptr_t *lo, uintptr_t *hi)
+{
+    if (_stack_hi == 0) {
+        _stack_hi = UINTPTR_MAX;
+        pthread_attr_t attr;
+        void *addr;
+        size_t size;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+            if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+                _stack_lo = (uintptr_t)addr;
+                _stack_hi = (uintptr_t)addr + size;
+            }
+            pthread_attr_destroy(&attr);
+        }
+    }
+    *lo = _stack_lo;
+    *hi = _stack_hi;
+}
+
+static inline __attribute__((always_inline)) uint32_t
+_stack_capture(uintptr_t *pcs)
+{
+    uintptr_t *fp  = __builtin_frame_address(0);
+    uint32_t depth = 0;
+    uintptr_t lo, hi;
+    _stack_bounds(&lo, &hi);
+
+    // a frame record is two words: the next frame pointer and the return pc
+    while (depth < MAX_FRAMES && fp != NULL &&
+           ((uintptr_t)fp & (sizeof(uintptr_t) - 1)) == 0 &&
+           (uintptr_t)fp >= lo && (uintptr_t)fp <= hi - 2 * sizeof(uintptr_t)) {
+        uintptr_t *next = (uintptr_t *)fp[0];
+        uintptr_t pc    = fp[1];
+        if (pc == 0)
+            break;
+        pcs[depth++] = pc;
+        if (next <= fp || (uintptr_t)next - (uintptr_t)fp > MAX_FRAME_SIZE)
+            break;
+        fp = next;
+    }
+    return depth;
+}
+
+static uint32_t
+_stack_hash(const uintptr_t *pcs, uint32_t depth)
+{
+    uint64_t h = depth;
+    for (uint32_t i = 0; i < depth; i++)
+        h = (h ^ pcs[i]) * 0x9e3779b97f4a7c15ULL;
+    return (uint32_t)(h >> 32);
+}
+
+static uint32_t
+_depot_put(const uintptr_t *pcs, uint32_t depth)
+{
+    uint32_t hash = _stack_hash(pcs, depth);
+
+    for (uint32_t i = 0; i < DEPOT_PROBES; i++) {
+        uint32_t slot    = (hash + i) & (DEPOT_SIZE - 1);
+        depot_stack_t *s = &_lc.depot[slot];
+
+        uint32_t state = vatomic32_read_acq(&s->state);
+        if (state == STACK_FREE) {
+            state = vatomic32_cmpxchg_acq(&s->state, STACK_FREE, STACK_BUSY);
+            if (state == STACK_FREE) {
+                s->hash  = hash;
+                s->depth = depth;
+                sys_memcpy(s->pcs, pcs, depth * sizeof(uintptr_t));
+                vatomic32_write_rel(&s->state, STACK_READY);
+                return slot + 1;
+            }
+        }
+        if (state == STACK_BUSY)
+            vatomic32_await_neq_acq(&s->state, STACK_BUSY);
+
+        if (s->hash == hash && s->depth == depth &&
+            sys_memcmp(s->pcs, pcs, depth * sizeof(uintptr_t)) == 0)
+            return slot + 1;
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * allocation table
+ ******************************************************************************/
+
+static inline struct alloc *
+_header(void *ptr)
+{
+    return (struct alloc *)((char *)ptr - sizeof(struct alloc));
+}
+
+static inline uint16_t
+_shard_of(const struct alloc *a)
+{
+    uint64_t h = ((uintptr_t)a >> 4) * 0x9e3779b97f4a7c15ULL;
+    return (uint16_t)((h >> 32) & (ALLOC_SHARDS - 1));
+}
+
+static void
+_link(struct alloc *a)
+{
+    alloc_shard_t *shard = &_lc.shards[a->shard];
+
+    caslock_acquire(&shard->lock);
+    a->prev = NULL;
+    a->next = shard->head;
+    if (shard->head)
+        shard->head->prev = a;
+    shard->head = a;
+    caslock_release(&shard->lock);
+}
+
+static void
+_unlink(struct alloc *a)
+{
+    alloc_shard_t *shard = &_lc.shards[a->shard];
+
+    caslock_acquire(&shard->lock);
+    if (a->prev)
+        a->prev->next = a->next;
+    else
+        shard->head = a->next;
+    if (a->next)
+        a->next->prev = a->prev;
+    caslock_release(&shard->lock);
 }
 
 void *
@@ -62,17 +244,14 @@ memmgr_alloc(size_t size)
     struct alloc *a = FORWARD(memmgr_alloc, size + sizeof(struct alloc));
     ASSERT(a);
 
-#ifndef DISABLE_EXECINFO
-    a->btsize = backtrace((void **)&a->btrace, MAX_FRAMES);
-#else
-    a->btsize = 0;
-#endif
-    a->size = size;
+    uintptr_t pcs[MAX_FRAMES];
+    uint32_t depth = _stack_capture(pcs);
 
-    caslock_acquire(&_lc.lock);
-    a->next       = _lc.list.next;
-    _lc.list.next = a;
-    caslock_release(&_lc.lock);
+    a->stack_id = depth > 0 ? _depot_put(pcs, depth) : 0;
+    a->size     = size;
+    a->shard    = _shard_of(a);
+    a->magic    = ALLOC_MAGIC;
+    _link(a);
     return a->data;
 }
 
@@ -94,17 +273,10 @@ memmgr_free(void *ptr)
         return;
     }
 
-    size_t sz          = sizeof(struct alloc);
-    struct alloc *a    = (struct alloc *)((char *)ptr - sz);
-    struct alloc *prev = &_lc.list;
-
-    caslock_acquire(&_lc.lock);
-    while (prev->next != a)
-        prev = prev->next;
-
-    ASSERT(prev->next == a);
-    prev->next = a->next;
-    caslock_release(&_lc.lock);
+    struct alloc *a = _header(ptr);
+    ASSERT(a->magic == ALLOC_MAGIC && "invalid or double free");
+    a->magic = 0;
+    _unlink(a);
 
     FORWARD(memmgr_free, a);
 }
@@ -116,43 +288,94 @@ memmgr_realloc(void *ptr, size_t size)
     if (_lc.fini)
         return sys_realloc(ptr, size);
 
-    struct alloc *a = memmgr_alloc(size);
-    if (!ptr || !a)
-        return a->data;
+    void *data = memmgr_alloc(size);
+    if (!ptr || !data)
+        return data;
 
-    size_t sz           = sizeof(struct alloc);
-    struct alloc *old_a = (struct alloc *)((char *)ptr - sz);
+    struct alloc *old_a = _header(ptr);
     size                = old_a->size < size ? old_a->size : size;
-    sys_memcpy(a->data, ptr, size);
+    sys_memcpy(data, ptr, size);
 
     memmgr_free(ptr);
-    return a->data;
+    return data;
+}
+
+/*******************************************************************************
+ * report
+ ******************************************************************************/
+
+static int
+_leak_cmp(const void *x, const void *y)
+{
+    const depot_stack_t *a = *(const depot_stack_t *const *)x;
+    const depot_stack_t *b = *(const depot_stack_t *const *)y;
+    if (a->leaked_size == b->leaked_size)
+        return 0;
+    return a->leaked_size < b->leaked_size ? 1 : -1;
+}
+
+static void
+_report(depot_stack_t *s)
+{
+    logger_printf("Memory leak: %lu bytes in %lu allocations, e.g. addr=%p\n",
+                  s->leaked_size, s->leaked_count, s->leaked_sample);
+#ifndef DISABLE_EXECINFO
+    char **strs = backtrace_symbols((void *const *)s->pcs, (int)s->depth);
+    for (uint32_t i = 0; strs && i < s->depth; i++) {
+        logger_printf("  %s\n", strs[i]);
+    }
+    free(strs);
+#else
+    for (uint32_t i = 0; i < s->depth; i++) {
+        logger_printf("  %p\n", (void *)s->pcs[i]);
+    }
+#endif
+    logger_printf("\n");
 }
 
 void
 memmgr_fini()
 {
-    struct alloc *n = &_lc.list;
+    depot_stack_t unknown = {0};
+    size_t nstacks        = 0;
 
     _lc.fini = true;
-    caslock_acquire(&_lc.lock);
 
-    if (_lc.list.next)
-        logger_printf("\n\n");
+    for (uint32_t i = 0; i < ALLOC_SHARDS; i++) {
+        alloc_shard_t *shard = &_lc.shards[i];
+        caslock_acquire(&shard->lock);
+        for (struct alloc *n; (n = shard->head) != NULL;) {
+            shard->head = n->next;
 
-    while ((n = _lc.list.next) != NULL) {
-        _lc.list.next = n->next;
-
-        logger_printf("Memory leak: addr=%p size=%lu\n", n->data, n->size);
-#ifndef DISABLE_EXECINFO
-        char **strs = backtrace_symbols(n->btrace, n->btsize);
-        for (int i = 0; i < n->btsize; i++) {
-            logger_printf("  %s\n", strs[i]);
+            depot_stack_t *s =
+                n->stack_id != 0 ? &_lc.depot[n->stack_id - 1] : &unknown;
+            if (s->leaked_count++ == 0) {
+                s->leaked_sample = n->data;
+                nstacks++;
+            }
+            s->leaked_size += n->size;
+            FORWARD(memmgr_free, n);
         }
-        logger_printf("\n");
-        free(strs);
-#endif
-        FORWARD(memmgr_free, n);
+        caslock_release(&shard->lock);
+    }
+
+    if (nstacks == 0)
+        return;
+
+    depot_stack_t **leaks = sys_malloc(nstacks * sizeof(depot_stack_t *));
+    ASSERT(leaks);
+    size_t n = 0;
+    if (unknown.leaked_count > 0)
+        leaks[n++] = &unknown;
+    for (uint32_t i = 0; i < DEPOT_SIZE && n < nstacks; i++) {
+        if (_lc.depot[i].leaked_count > 0)
+            leaks[n++] = &_lc.depot[i];
+    }
+    qsort(leaks, n, sizeof(depot_stack_t *), _leak_cmp);
+
+    logger_printf("\n\n");
+    for (size_t i = 0; i < n; i++) {
+        _report(leaks[i]);
     }
-    caslock_release(&_lc.lock);
+    sys_free(leaks);
 }
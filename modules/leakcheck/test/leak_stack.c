@@ -0,0 +1,32 @@
+// clang-format off
+// RUN: %lotto %stress -r 1 --memmgr-user leakcheck -- %b 2>&1 | %check %s
+// CHECK: Memory leak: 24 bytes in 1 allocations
+// CHECK: {{.*}}(leaky_alloc+0x{{[0-9a-f]+}})
+// CHECK: {{.*}}(leaky_caller+0x{{[0-9a-f]+}})
+// clang-format on
+
+#include <stdlib.h>
+
+void *leaked;
+
+/* The report names the frames that made the allocation, so neither of them
+ * may be inlined into main. */
+__attribute__((noinline)) void
+leaky_alloc(void)
+{
+    leaked = malloc(24);
+}
+
+__attribute__((noinline)) void
+leaky_caller(void)
+{
+    leaky_alloc();
+}
+
+int
+main()
+{
+    leaky_caller();
+    leaked = NULL;
+    return 0;
+}
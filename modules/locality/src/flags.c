@@ -0,0 +1,13 @@
+#include "state.h"
+#include <lotto/base/flags.h>
+#include <lotto/driver/flagmgr.h>
+#include <lotto/driver/flags/modules.h>
+
+REGISTER_RUNTIME_SWITCHABLE_CONFIG(locality_config(), false)
+
+NEW_CALLBACK_FLAG(LOCALITY_GRANULARITY, "", LOTTO_MODULE_FLAG("granularity"),
+                  "BYTES",
+                  "size of the memory granules owned by a task, rounded down "
+                  "to a power of two",
+                  flag_uval(LOCALITY_DEFAULT_GRANULARITY),
+                  { locality_config()->granularity = as_uval(v); })
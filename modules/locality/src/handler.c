@@ -0,0 +1,116 @@
+#include "state.h"
+#include <lotto/engine/pubsub.h>
+#include <lotto/engine/sequencer.h>
+#include <lotto/engine/statemgr.h>
+#include <lotto/runtime/events.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/string.h>
+#include <lotto/util/macros.h>
+
+/*******************************************************************************
+ * @file handler.c
+ *
+ * Shadow ownership of memory granules. The first task accessing a granule owns
+ * it, and its accesses are private until a second task touches the granule,
+ * which then stays shared. Private accesses are skipped like filtered events:
+ * they create no change point and reach no later handler, such as race or pos.
+ *
+ * Ownership only depends on the sequence of accesses, so replaying a schedule
+ * with the recorded configuration takes the same decisions.
+ ******************************************************************************/
+
+#define LOCALITY_SLOTS_BITS 16
+#define LOCALITY_SLOTS      (1U << LOCALITY_SLOTS_BITS)
+#define LOCALITY_PROBES     8U
+/* Accesses spanning more granules are taken as shared. */
+#define LOCALITY_SPAN 4U
+
+typedef struct {
+    uintptr_t key; /* granule + 1, or 0 if the slot is empty */
+    task_id owner; /* NO_TASK once shared */
+} entry_t;
+
+typedef struct {
+    entry_t entries[LOCALITY_SLOTS];
+} state_t;
+static state_t _state;
+
+REGISTER_EPHEMERAL(_state, { sys_memset(&_state, 0, sizeof(state_t)); })
+
+static inline uint32_t
+_locality_hash(uintptr_t key)
+{
+    return (uint32_t)(((uint64_t)key * 0x9e3779b97f4a7c15ULL) >>
+                      (64 - LOCALITY_SLOTS_BITS));
+}
+
+/* Returns whether `id` owns the granule, claiming it if it was never accessed.
+ * A granule that finds no free slot is taken as shared. */
+static bool
+_locality_owned(uintptr_t granule, task_id id)
+{
+    uintptr_t key = granule + 1;
+    uint32_t h    = _locality_hash(key);
+    for (uint32_t i = 0; i < LOCALITY_PROBES; i++) {
+        entry_t *en = &_state.entries[(h + i) & (LOCALITY_SLOTS - 1)];
+        if (en->key == 0) {
+            *en = (entry_t){.key = key, .owner = id};
+            return true;
+        }
+        if (en->key == key) {
+            if (en->owner != id) {
+                en->owner = NO_TASK;
+            }
+            return en->owner == id;
+        }
+    }
+    return false;
+}
+
+static inline uint32_t
+_locality_shift(void)
+{
+    uint64_t granularity = locality_config()->granularity;
+    return 63 - __builtin_clzll(granularity | 1);
+}
+
+/*******************************************************************************
+ * handler function
+ ******************************************************************************/
+STATIC void
+_locality_handle(const capture_point *cp, event_t *e)
+{
+    ASSERT(e);
+    if (e->skip || !locality_config()->enabled || !has_memaccess_addr(cp))
+        return;
+
+    ASSERT(cp);
+    ASSERT(cp->id != NO_TASK);
+
+    uintptr_t addr = memaccess_addr(cp);
+    size_t size    = memaccess_size(cp);
+    if (addr == 0)
+        return;
+
+    uint32_t shift  = _locality_shift();
+    uintptr_t first = addr >> shift;
+    uintptr_t last  = (addr + (size > 0 ? size - 1 : 0)) >> shift;
+    if (last - first >= LOCALITY_SPAN)
+        return;
+
+    // every granule is claimed, even once the access is known to be shared
+    task_id id = cp->vid != NO_TASK ? cp->vid : cp->id;
+    bool owned = true;
+    for (uintptr_t g = first; g <= last; g++) {
+        owned &= _locality_owned(g, id);
+    }
+
+    // change points set by earlier handlers are kept
+    if (!owned || e->is_chpt)
+        return;
+
+    e->next     = cp->id;
+    e->readonly = true;
+    e->skip     = true;
+}
+ON_SEQUENCER_CAPTURE(_locality_handle)
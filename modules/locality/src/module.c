@@ -0,0 +1,2 @@
+#include <lotto/engine/pubsub.h>
+LOTTO_MODULE_INIT()
@@ -0,0 +1,17 @@
+#include "state.h"
+#include <lotto/engine/statemgr.h>
+#include <lotto/sys/logger.h>
+
+static locality_config_t _config = {.granularity =
+                                        LOCALITY_DEFAULT_GRANULARITY};
+
+REGISTER_CONFIG(_config, {
+    logger_infof("enabled     = %s\n", _config.enabled ? "on" : "off");
+    logger_infof("granularity = %lu\n", _config.granularity);
+})
+
+locality_config_t *
+locality_config(void)
+{
+    return &_config;
+}
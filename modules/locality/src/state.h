@@ -0,0 +1,23 @@
+/**
+ * @file state.h
+ * @brief Locality module state declarations.
+ */
+#ifndef LOTTO_STATE_LOCALITY_H
+#define LOTTO_STATE_LOCALITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lotto/base/marshable.h>
+
+#define LOCALITY_DEFAULT_GRANULARITY 8
+
+typedef struct locality_config {
+    marshable_t m;
+    bool enabled;
+    uint64_t granularity;
+} locality_config_t;
+
+locality_config_t *locality_config(void);
+
+#endif
@@ -0,0 +1,49 @@
+// clang-format off
+// RUN: (! %lotto %stress -r 200 -e locality -- %b 2>&1) | %check %s
+// RUN: (! %lotto %replay 2>&1) | %check %s
+// CHECK: assert failed {{.*}}/locality_shared.c:{{[0-9]+}}: x == 2
+// RUN: %lotto %stress -r 1 -e locality --record-granularity CHPT -- %b || true
+// RUN: %lotto %show | %check %s --check-prefix=PRIVATE
+// RUN: %lotto %stress -r 1 --record-granularity CHPT -- %b || true
+// RUN: %lotto %show | %check %s --check-prefix=SHARED
+//
+// Without locality, every increment of a counter is a change point.
+// PRIVATE: RECORD 2
+// PRIVATE-NOT: RECORD 100
+// SHARED: RECORD 200
+// clang-format on
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+atomic_int x;
+
+/* Each task owns its counter, so only the accesses to x, shared since main
+ * initialized it, are change points. */
+void *
+run(void *arg)
+{
+    atomic_int counter = 0;
+    for (int i = 0; i < 100; i++) {
+        atomic_fetch_add(&counter, 1);
+    }
+    int v = atomic_load(&x);
+    atomic_store(&x, v + 1);
+    return arg;
+}
+
+int
+main()
+{
+    atomic_store(&x, 0);
+
+    pthread_t t1, t2;
+    pthread_create(&t1, 0, run, 0);
+    pthread_create(&t2, 0, run, 0);
+
+    pthread_join(t1, 0);
+    pthread_join(t2, 0);
+    assert(x == 2);
+    return 0;
+}
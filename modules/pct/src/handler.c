@@ -44,33 +44,17 @@ _pct_update(task_t *t, uint64_t rval)
         return;
 
     /* in the paper: p[t] = d - i */
-    t->priority = _pct_priority(rval);
+    prioheap_update(&pct_state()->heap, &t->node, _pct_priority(rval));
     if (pct_state()->counts.chpts < pct_config()->chpts)
         pct_state()->counts.chpts++;
 }
 
-static int
-_pct_cmp(const void *a, const void *b)
-{
-    const task_id *ta = (const task_id *)a;
-    const task_id *tb = (const task_id *)b;
-
-    const task_t *tta = (const task_t *)tidmap_find(&pct_state()->map, *ta);
-    const task_t *ttb = (const task_t *)tidmap_find(&pct_state()->map, *tb);
-    ASSERT(tta);
-    ASSERT(ttb);
-
-    return ttb->priority > tta->priority ? 1 :
-           ttb->priority < tta->priority ? -1 :
-           *ta > *tb                     ? 1 :
-           *ta < *tb                     ? -1 :
-                                           0;
-}
-
 static void
-_pct_sort(tidset_t *tset)
+_pct_select(tidset_t *tset)
 {
-    tidset_sort(tset, _pct_cmp);
+    prionode_t *n = prioheap_first_in(&pct_state()->heap, tset);
+    ASSERT(n);
+    tidset_make_first(tset, n->id);
 }
 
 /*******************************************************************************
@@ -86,6 +70,11 @@ _pct_handle(const capture_point *cp, event_t *e)
 
     /* initialization */
     if (cp->type_id == EVENT_TASK_FINI) {
+        t = (task_t *)tidmap_find(&pct_state()->map, cp->id);
+        if (t) {
+            prioheap_remove(&pct_state()->heap, &t->node);
+            t = NULL;
+        }
         tidmap_deregister(&pct_state()->map, cp->id);
         ASSERT(!tidset_has(&e->tset, cp->id));
     } else if (cp->type_id == EVENT_TASK_INIT) {
@@ -93,7 +82,8 @@ _pct_handle(const capture_point *cp, event_t *e)
         ASSERT(t == NULL);
         t = (task_t *)tidmap_register(&pct_state()->map, cp->id);
         ASSERT(t);
-        t->priority = _pct_priority(prng_next());
+        prioheap_insert(&pct_state()->heap, &t->node, cp->id,
+                        _pct_priority(prng_next()));
     } else {
         t = (task_t *)tidmap_find(&pct_state()->map, cp->id);
         ASSERT(t);
@@ -109,7 +99,7 @@ _pct_handle(const capture_point *cp, event_t *e)
         _pct_update(t, prng_next());
     }
     pct_state()->counts.kmax++;
-    _pct_sort(&e->tset);
+    _pct_select(&e->tset);
     e->selector = SELECTOR_FIRST;
     e->readonly = true;
     e->reason   = REASON_DETERMINISTIC;
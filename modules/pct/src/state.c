@@ -44,6 +44,21 @@ STATIC void _pct_print(const marshable_t *m);
 REGISTER_STATE(FINAL, _state, {
     _state.m = MARSHABLE_STATE;
     tidmap_init(&_state.map, MARSHABLE_TASK);
+    prioheap_init(&_state.heap, 1);
+})
+
+/* The task map and the heap are not part of the marshaled payload, so the
+ * baseline restored between resident rounds does not cover them. */
+static void
+_pct_reset(marshable_t *m)
+{
+    (void)m;
+    prioheap_fini(&_state.heap);
+    prioheap_init(&_state.heap, 1);
+    tidmap_clear(&_state.map);
+}
+STATEMGR_REGISTER(FINAL, {
+    statemgr_register_reset((marshable_t *)&_state, _pct_reset);
 })
 
 pct_state_t *
@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include <lotto/base/marshable.h>
+#include <lotto/base/prioheap.h>
 #include <lotto/base/tidmap.h>
 
 typedef struct pct_config {
@@ -24,12 +25,13 @@ typedef struct pct_config {
 
 typedef struct {
     tiditem_t t;
-    uint64_t priority;
+    prionode_t node;
 } task_t;
 
 typedef struct pct_state {
     marshable_t m;
     tidmap_t map;
+    prioheap_t heap;
 
     char payload[0];
     struct {
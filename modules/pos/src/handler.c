@@ -4,6 +4,7 @@
  * http://www.cs.columbia.edu/~junfeng/papers/pos-cav18.pdf
  ******************************************************************************/
 #include "state.h"
+#include <lotto/base/prioheap.h>
 #include <lotto/base/tidmap.h>
 #include <lotto/engine/prng.h>
 #include <lotto/engine/sequencer.h>
@@ -12,7 +13,6 @@
 #include <lotto/runtime/events.h>
 #include <lotto/sys/logger.h>
 #include <lotto/util/macros.h>
-#include <lotto/util/once.h>
 
 /*******************************************************************************
  * state
@@ -20,16 +20,38 @@
 
 typedef struct {
     tiditem_t t;
-    uint64_t priority;
+    prionode_t node;
     uintptr_t addr;
     bool is_write;
 } task_t;
 #define MARSHABLE_TASK MARSHABLE_STATIC(sizeof(task_t))
 STATIC void _pos_print(const marshable_t *m);
 static tidmap_t _state;
+static prioheap_t _heap;
+static uint64_t _wd_threshold;
+
+/* Derives the watchdog parameters from the configuration. The threshold is
+ * kept apart so that loading the configuration again does not divide it
+ * twice. */
+static void
+_pos_wd_config(void)
+{
+    const char *var          = getenv("LOTTO_POS_WD_THRESHOLD");
+    pos_config()->wd_divisor = var ? strtoull(var, NULL, 10) : 10;
+    _wd_threshold = pos_config()->wd_threshold / pos_config()->wd_divisor;
+}
+
 REGISTER_EPHEMERAL(_state, {
     tidmap_init(&_state, MARSHABLE_TASK);
     _state.m.print = _pos_print;
+    _pos_wd_config();
+    prioheap_fini(&_heap);
+    prioheap_init(&_heap, pos_config()->wd_divisor);
+})
+
+LOTTO_SUBSCRIBE(EVENT_ENGINE__AFTER_UNMARSHAL_CONFIG, {
+    _pos_wd_config();
+    _heap.mult = pos_config()->wd_divisor;
 })
 
 static uint64_t
@@ -38,28 +60,12 @@ _fresh_priority(uint64_t rval)
     return rval;
 }
 
-static int
-_pos_cmp(const void *a, const void *b)
-{
-    const task_id *ta = (const task_id *)a;
-    const task_id *tb = (const task_id *)b;
-
-    const task_t *tta = (const task_t *)tidmap_find(&_state, *ta);
-    const task_t *ttb = (const task_t *)tidmap_find(&_state, *tb);
-    ASSERT(tta);
-    ASSERT(ttb);
-
-    return ttb->priority > tta->priority ? 1 :
-           ttb->priority < tta->priority ? -1 :
-           *ta > *tb                     ? 1 :
-           *ta < *tb                     ? -1 :
-                                           0;
-}
-
 static void
-_pos_sort(tidset_t *tset)
+_pos_select(tidset_t *tset)
 {
-    tidset_sort(tset, _pos_cmp);
+    prionode_t *n = prioheap_first_in(&_heap, tset);
+    ASSERT(n);
+    tidset_make_first(tset, n->id);
 }
 
 static void
@@ -88,18 +94,16 @@ _reset_races(task_id id)
         if (t == other || t->addr != other->addr) {
             continue;
         }
-        other->priority = _fresh_priority(prng_next());
+        prioheap_update(&_heap, &other->node, _fresh_priority(prng_next()));
     }
 }
 
+/* Multiplies all priorities by the watchdog divisor. The heap applies the
+ * factor lazily, so this is O(1) regardless of the number of tasks. */
 static void
 _reset_wd()
 {
-    for (const tiditem_t *cur = tidmap_iterate(&_state); cur;
-         cur                  = tidmap_next(cur)) {
-        task_t *t = (task_t *)cur;
-        t->priority *= pos_config()->wd_divisor;
-    }
+    prioheap_decay(&_heap);
 }
 
 /*******************************************************************************
@@ -108,12 +112,6 @@ _reset_wd()
 STATIC void
 _pos_handle(const capture_point *cp, event_t *e)
 {
-    once({
-        const char *var          = getenv("LOTTO_POS_WD_THRESHOLD");
-        pos_config()->wd_divisor = var ? strtoull(var, NULL, 10) : 10;
-        pos_config()->wd_threshold =
-            pos_config()->wd_threshold / pos_config()->wd_divisor;
-    });
     ASSERT(e);
     if (e->skip)
         return;
@@ -125,6 +123,10 @@ _pos_handle(const capture_point *cp, event_t *e)
     task_t *t      = NULL;
 
     if (cp->type_id == EVENT_TASK_FINI) {
+        if ((t = (task_t *)tidmap_find(&_state, cp->id))) {
+            prioheap_remove(&_heap, &t->node);
+            t = NULL;
+        }
         tidmap_deregister(&_state, cp->id);
         ASSERT(!tidset_has(&e->tset, cp->id));
     } else if (cp->type_id == EVENT_TASK_INIT) {
@@ -134,7 +136,7 @@ _pos_handle(const capture_point *cp, event_t *e)
         ASSERT(t);
         t->is_write = false;
         t->addr     = 0;
-        t->priority = _fresh_priority(prng_next());
+        prioheap_insert(&_heap, &t->node, cp->id, _fresh_priority(prng_next()));
     } else {
         switch (cp->type_id) {
             case EVENT_MA_WRITE:
@@ -167,20 +169,21 @@ _pos_handle(const capture_point *cp, event_t *e)
     if ((t = (task_t *)tidmap_find(&_state, cp->id))) {
         t->is_write = is_write;
         t->addr     = addr;
-        if (t->priority < pos_config()->wd_threshold) {
+        if (prioheap_prio(&_heap, &t->node) < _wd_threshold) {
             _reset_wd();
         } else {
-            t->priority = _fresh_priority(prng_next());
+            prioheap_update(&_heap, &t->node, _fresh_priority(prng_next()));
         }
     } else if (cp->type_id != EVENT_TASK_FINI) {
         t = (task_t *)tidmap_register(&_state, cp->id);
         if (t) {
             t->is_write = is_write;
             t->addr     = addr;
-            t->priority = _fresh_priority(prng_next());
+            prioheap_insert(&_heap, &t->node, cp->id,
+                            _fresh_priority(prng_next()));
         }
     }
-    _pos_sort(&e->tset);
+    _pos_select(&e->tset);
     _reset_races(tidset_get(&e->tset, 0));
     e->selector = SELECTOR_FIRST;
     e->readonly = true;
@@ -203,7 +206,8 @@ _pos_print(const marshable_t *m)
             logger_printf(", ");
         first     = false;
         task_t *t = (task_t *)cur;
-        logger_printf("(%lu, %lu, %lu, %s)", cur->key, t->priority, t->addr,
+        logger_printf("(%lu, %lu, %lu, %s)", cur->key,
+                      prioheap_prio(&_heap, &t->node), t->addr,
                       t->is_write ? "true" : "false");
     }
     logger_println("]");
@@ -0,0 +1,25 @@
+/**
+ * @file elf.h
+ * @brief Guest ELF symbol lookup shared by the QEMU modules.
+ */
+#ifndef LOTTO_MODULES_QEMU_ELF_H
+#define LOTTO_MODULES_QEMU_ELF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Colon-separated list of unstripped guest ELF files. */
+#define QEMU_ELF_UNSTRIPPED_VAR "LOTTO_ELF_UNSTRIPPED"
+
+typedef void(qemu_elf_symbol_f)(const char *name, uint64_t addr,
+                                uint64_t size, bool is_func, void *arg);
+
+/**
+ * Calls `cb` for each sized function and object symbol of the ELF files listed
+ * in LOTTO_ELF_UNSTRIPPED.
+ *
+ * @return false if no ELF file is configured
+ */
+bool qemu_elf_foreach_symbol(qemu_elf_symbol_f *cb, void *arg);
+
+#endif
@@ -31,6 +31,8 @@ typedef struct qemu_translate_event {
     uintptr_t plugin_id;
     struct qemu_plugin_tb *tb;
     size_t insn_count;
+    /* instructions whose instrumentation decisions came from the cache */
+    size_t cache_hits;
 } qemu_translate_event_t;
 
 typedef struct qemu_vcpu_init_event {
@@ -57,6 +57,9 @@ register_mem_cb(capture_point *cp, struct qemu_plugin_insn *insn)
 
 void emit_memaccess(unsigned int cpu_index, qemu_plugin_meminfo_t info,
                     uint64_t vaddr, void *udata);
+void emit_memaccess_filtered(unsigned int cpu_index,
+                             qemu_plugin_meminfo_t info, uint64_t vaddr,
+                             void *udata);
 void emit_ma_read(capture_point *cp, uint64_t vaddr, uint64_t size);
 void emit_ma_write(capture_point *cp, uint64_t vaddr, uint64_t size);
 void emit_ma_aread(capture_point *cp, uint64_t vaddr, uint64_t size);
@@ -65,12 +68,34 @@ void emit_ma_rmw(capture_point *cp, uint64_t vaddr, uint64_t size);
 void emit_ma_xchg(capture_point *cp, uint64_t vaddr, uint64_t size);
 void emit_ma_cmpxchg(capture_point *cp, uint64_t vaddr, uint64_t size);
 
+/* The memaccess callback data carries the guest PC of the instruction, with
+ * bit 0 (always clear on AArch64) flagging atomic-like accesses. */
+#define QEMU_MEMACCESS_ATOMIC_LIKE ((uintptr_t)1)
+
+static inline void *
+memaccess_udata(struct qemu_plugin_insn *insn, bool is_atomic_like)
+{
+    return (void *)((uintptr_t)qemu_plugin_insn_vaddr(insn) |
+                    (is_atomic_like ? QEMU_MEMACCESS_ATOMIC_LIKE : 0));
+}
+
 static inline void
 bind_memaccess_callback(struct qemu_plugin_insn *insn, bool is_atomic_like)
 {
     qemu_plugin_register_vcpu_mem_cb(insn, emit_memaccess,
                                      QEMU_PLUGIN_CB_R_REGS, QEMU_PLUGIN_MEM_RW,
-                                     (void *)(uintptr_t)is_atomic_like);
+                                     memaccess_udata(insn, is_atomic_like));
+}
+
+/* Like bind_memaccess_callback, but drops accesses outside the configured
+ * shared address ranges before they are published. */
+static inline void
+bind_memaccess_filtered_callback(struct qemu_plugin_insn *insn,
+                                 bool is_atomic_like)
+{
+    qemu_plugin_register_vcpu_mem_cb(insn, emit_memaccess_filtered,
+                                     QEMU_PLUGIN_CB_R_REGS, QEMU_PLUGIN_MEM_RW,
+                                     memaccess_udata(insn, is_atomic_like));
 }
 
 static inline void
@@ -508,6 +508,7 @@ qemu(args_t *args, flags_t *flags)
 ON_DRIVER_REGISTER_COMMANDS({
     execute_set_replay_args_resolver(qemu_resolve_replay_args);
     flag_t sel[] = {flag_verbose(),
+                    flag_jobs(),
                     FLAG_QEMU_BIN,
                     FLAG_QEMU_PLUGIN_DEBUG,
                     FLAG_QEMU_PLUGINS,
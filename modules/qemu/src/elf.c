@@ -0,0 +1,84 @@
+#include <fcntl.h>
+#include <gelf.h>
+#include <libelf.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <lotto/modules/qemu/elf.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/stdlib.h>
+
+static void
+_foreach_in_file(const char *path, qemu_elf_symbol_f *cb, void *arg)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        logger_warnf("elf: could not open '%s'\n", path);
+        return;
+    }
+
+    Elf *e = elf_begin(fd, ELF_C_READ, NULL);
+    if (e == NULL || elf_kind(e) != ELF_K_ELF) {
+        logger_warnf("elf: '%s' is not an ELF file\n", path);
+        if (e != NULL) {
+            elf_end(e);
+        }
+        close(fd);
+        return;
+    }
+
+    Elf_Scn *scn = NULL;
+    GElf_Shdr shdr;
+    while ((scn = elf_nextscn(e, scn)) != NULL) {
+        if (gelf_getshdr(scn, &shdr) == NULL || shdr.sh_type != SHT_SYMTAB ||
+            shdr.sh_entsize == 0) {
+            continue;
+        }
+        Elf_Data *data = elf_getdata(scn, NULL);
+        size_t num     = shdr.sh_size / shdr.sh_entsize;
+        for (size_t i = 0; data != NULL && i < num; i++) {
+            GElf_Sym sym;
+            if (gelf_getsym(data, (int)i, &sym) == NULL || sym.st_size == 0) {
+                continue;
+            }
+            int type = GELF_ST_TYPE(sym.st_info);
+            if (type != STT_FUNC && type != STT_OBJECT) {
+                continue;
+            }
+            const char *name = elf_strptr(e, shdr.sh_link, sym.st_name);
+            if (name != NULL) {
+                cb(name, sym.st_value, sym.st_size, type == STT_FUNC, arg);
+            }
+        }
+    }
+
+    elf_end(e);
+    close(fd);
+}
+
+bool
+qemu_elf_foreach_symbol(qemu_elf_symbol_f *cb, void *arg)
+{
+    const char *elfs = sys_getenv(QEMU_ELF_UNSTRIPPED_VAR);
+    if (elfs == NULL || elfs[0] == '\0') {
+        return false;
+    }
+    if (elf_version(EV_CURRENT) == EV_NONE) {
+        logger_warnf("elf: %s\n", elf_errmsg(-1));
+        return false;
+    }
+
+    for (const char *cur = elfs; *cur != '\0';) {
+        const char *sep = strchr(cur, ':');
+        size_t len      = sep != NULL ? (size_t)(sep - cur) : strlen(cur);
+        char path[PATH_MAX];
+        if (len > 0 && len < sizeof(path)) {
+            memcpy(path, cur, len);
+            path[len] = '\0';
+            _foreach_in_file(path, cb, arg);
+        }
+        cur += len + (sep != NULL ? 1 : 0);
+    }
+    return true;
+}
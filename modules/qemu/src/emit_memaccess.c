@@ -2,6 +2,7 @@
 
 #include "translate_aarch64.h"
 #include "interceptors.h"
+#include "memfilter.h"
 #include <dice/chains/intercept.h>
 #include <dice/events/memaccess.h>
 #include <lotto/engine/pubsub.h>
@@ -97,8 +98,11 @@ emit_memaccess(unsigned int cpu_index, qemu_plugin_meminfo_t info,
         return;
     }
 
-    bool atomic_like = ((uintptr_t)udata) != 0;
-    capture_point cp = {.chain_id = INTERCEPT_EVENT, .func = __FUNCTION__};
+    uintptr_t data   = (uintptr_t)udata;
+    bool atomic_like = (data & QEMU_MEMACCESS_ATOMIC_LIKE) != 0;
+    capture_point cp = {.chain_id = INTERCEPT_EVENT,
+                        .pc       = data & ~QEMU_MEMACCESS_ATOMIC_LIKE,
+                        .func     = __FUNCTION__};
 #if defined(QLOTTO_ENABLED)
     cp.cpu_cost = qemu_instruction_icount();
 #endif
@@ -121,3 +125,13 @@ emit_memaccess(unsigned int cpu_index, qemu_plugin_meminfo_t info,
 
     emit_ma_read(&cp, vaddr, qemu_memaccess_size(info));
 }
+
+void
+emit_memaccess_filtered(unsigned int cpu_index, qemu_plugin_meminfo_t info,
+                        uint64_t vaddr, void *udata)
+{
+    if (!qemu_memfilter_match(vaddr, qemu_memaccess_size(info))) {
+        return;
+    }
+    emit_memaccess(cpu_index, info, vaddr, udata);
+}
@@ -0,0 +1,77 @@
+#include <glib.h>
+#include <string.h>
+
+#include "insn_cache.h"
+
+#define INSN_CACHE_SIZE  (1U << QEMU_INSN_CACHE_BITS)
+#define INSN_CACHE_LOCKS 64U
+
+typedef struct insn_cache_entry {
+    uint64_t key;
+    uint32_t opcode;
+    uint8_t decision;
+    bool valid;
+} insn_cache_entry_t;
+
+/* Direct-mapped: a colliding instruction simply evicts the previous one.
+ * vCPUs translate concurrently under MTTCG, so slots are guarded by striped
+ * locks; statically allocated GMutexes need no initialization. */
+static insn_cache_entry_t g_insn_cache[INSN_CACHE_SIZE];
+static GMutex g_insn_cache_locks[INSN_CACHE_LOCKS];
+
+static inline uint32_t
+_slot(uint64_t key)
+{
+    /* AArch64 instructions are 4-byte aligned */
+    return (uint32_t)(((key >> 2) * 0x9e3779b97f4a7c15ULL) >>
+                      (64 - QEMU_INSN_CACHE_BITS));
+}
+
+static inline GMutex *
+_lock(uint32_t slot)
+{
+    return &g_insn_cache_locks[slot % INSN_CACHE_LOCKS];
+}
+
+bool
+qemu_insn_cache_get(uint64_t key, uint32_t opcode, uint8_t *decision)
+{
+    uint32_t slot = _slot(key);
+    bool hit      = false;
+
+    g_mutex_lock(_lock(slot));
+    insn_cache_entry_t *e = &g_insn_cache[slot];
+    if (e->valid && e->key == key && e->opcode == opcode) {
+        *decision = e->decision;
+        hit       = true;
+    }
+    g_mutex_unlock(_lock(slot));
+    return hit;
+}
+
+void
+qemu_insn_cache_put(uint64_t key, uint32_t opcode, uint8_t decision)
+{
+    uint32_t slot = _slot(key);
+
+    g_mutex_lock(_lock(slot));
+    g_insn_cache[slot] = (insn_cache_entry_t){
+        .key      = key,
+        .opcode   = opcode,
+        .decision = decision,
+        .valid    = true,
+    };
+    g_mutex_unlock(_lock(slot));
+}
+
+void
+qemu_insn_cache_clear(void)
+{
+    for (uint32_t i = 0; i < INSN_CACHE_LOCKS; i++) {
+        g_mutex_lock(&g_insn_cache_locks[i]);
+    }
+    memset(g_insn_cache, 0, sizeof(g_insn_cache));
+    for (uint32_t i = 0; i < INSN_CACHE_LOCKS; i++) {
+        g_mutex_unlock(&g_insn_cache_locks[i]);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef LOTTO_QEMU_INSN_CACHE_H
+#define LOTTO_QEMU_INSN_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QEMU_INSN_CACHE_BITS 16
+
+/* Instrumentation decisions taken for one guest instruction. */
+#define QEMU_INSN_MEMACCESS   (1U << 0)
+#define QEMU_INSN_ATOMIC_LIKE (1U << 1)
+#define QEMU_INSN_UDF_TRAP    (1U << 2)
+#define QEMU_INSN_WFE         (1U << 3)
+#define QEMU_INSN_WFI         (1U << 4)
+
+/* Looks up the decisions cached for the instruction at `key` (the host address
+ * backing the guest code, i.e., its physical location). Entries whose opcode
+ * differs were overwritten by guest code writes and count as misses. */
+bool qemu_insn_cache_get(uint64_t key, uint32_t opcode, uint8_t *decision);
+
+/* Caches the decisions for the instruction at `key`, replacing any entry
+ * mapped to the same slot. */
+void qemu_insn_cache_put(uint64_t key, uint32_t opcode, uint8_t decision);
+
+/* Drops every entry, e.g., when the translation policy changes. */
+void qemu_insn_cache_clear(void);
+
+#endif
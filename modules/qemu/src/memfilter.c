@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "memfilter.h"
+#include <lotto/modules/qemu/elf.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/stdlib.h>
+
+#define MEMFILTER_LIST_MAX 4096
+
+qemu_memfilter_range_t g_qemu_memfilter_ranges[QEMU_MEMFILTER_MAX_RANGES];
+size_t g_qemu_memfilter_count = 0;
+
+static void
+_add_range(uint64_t start, uint64_t end)
+{
+    if (end <= start) {
+        return;
+    }
+    if (g_qemu_memfilter_count == QEMU_MEMFILTER_MAX_RANGES) {
+        logger_warnf("memfilter: ignoring range 0x%lx-0x%lx, limit is %d\n",
+                     start, end, QEMU_MEMFILTER_MAX_RANGES);
+        return;
+    }
+    g_qemu_memfilter_ranges[g_qemu_memfilter_count++] =
+        (qemu_memfilter_range_t){.start = start, .end = end};
+}
+
+/* Parses a comma-separated list of `START-END` or `START+SIZE` entries. */
+static void
+_parse_ranges(const char *spec)
+{
+    char buf[MEMFILTER_LIST_MAX];
+    char *save = NULL;
+
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (char *tok = strtok_r(buf, ",", &save); tok != NULL;
+         tok       = strtok_r(NULL, ",", &save)) {
+        char *end      = NULL;
+        uint64_t start = strtoull(tok, &end, 0);
+        if (end == tok || (*end != '-' && *end != '+')) {
+            logger_warnf("memfilter: malformed range '%s'\n", tok);
+            continue;
+        }
+        char sep       = *end;
+        char *tail     = end + 1;
+        uint64_t value = strtoull(tail, &end, 0);
+        if (end == tail || *end != '\0') {
+            logger_warnf("memfilter: malformed range '%s'\n", tok);
+            continue;
+        }
+        _add_range(start, sep == '+' ? start + value : value);
+    }
+}
+
+static bool
+_symbol_listed(const char *name, const char *symbols)
+{
+    size_t len = strlen(name);
+    for (const char *cur = symbols; cur != NULL;) {
+        const char *sep = strchr(cur, ',');
+        size_t n        = sep != NULL ? (size_t)(sep - cur) : strlen(cur);
+        if (n == len && strncmp(cur, name, n) == 0) {
+            return true;
+        }
+        cur = sep != NULL ? sep + 1 : NULL;
+    }
+    return false;
+}
+
+static void
+_add_symbol(const char *name, uint64_t addr, uint64_t size, bool is_func,
+            void *arg)
+{
+    if (!is_func && _symbol_listed(name, (const char *)arg)) {
+        _add_range(addr, addr + size);
+    }
+}
+
+/* Resolves the object symbols against the guest ELF files, the same files
+ * qemu_gdb reads its symbols from. */
+static void
+_parse_symbols(const char *symbols)
+{
+    if (!qemu_elf_foreach_symbol(_add_symbol, (void *)symbols)) {
+        logger_warnf("memfilter: LOTTO_QEMU_INSTR_SYMBOLS needs "
+                     "LOTTO_ELF_UNSTRIPPED\n");
+    }
+}
+
+static int
+_range_cmp(const void *a, const void *b)
+{
+    const qemu_memfilter_range_t *x = a;
+    const qemu_memfilter_range_t *y = b;
+    return x->start < y->start ? -1 : x->start > y->start;
+}
+
+/* Sorts and merges overlapping or adjacent ranges so that lookups can binary
+ * search on the range ends. */
+static void
+_normalize(void)
+{
+    if (g_qemu_memfilter_count == 0) {
+        return;
+    }
+    qsort(g_qemu_memfilter_ranges, g_qemu_memfilter_count,
+          sizeof(g_qemu_memfilter_ranges[0]), _range_cmp);
+
+    size_t n = 0;
+    for (size_t i = 1; i < g_qemu_memfilter_count; i++) {
+        qemu_memfilter_range_t *last = &g_qemu_memfilter_ranges[n];
+        qemu_memfilter_range_t cur   = g_qemu_memfilter_ranges[i];
+        if (cur.start <= last->end) {
+            if (cur.end > last->end) {
+                last->end = cur.end;
+            }
+        } else {
+            g_qemu_memfilter_ranges[++n] = cur;
+        }
+    }
+    g_qemu_memfilter_count = n + 1;
+}
+
+void
+qemu_memfilter_init(void)
+{
+    const char *ranges  = sys_getenv("LOTTO_QEMU_INSTR_RANGES");
+    const char *symbols = sys_getenv("LOTTO_QEMU_INSTR_SYMBOLS");
+    bool configured     = false;
+
+    g_qemu_memfilter_count = 0;
+    if (ranges != NULL && ranges[0] != '\0') {
+        _parse_ranges(ranges);
+        configured = true;
+    }
+    if (symbols != NULL && symbols[0] != '\0') {
+        _parse_symbols(symbols);
+        configured = true;
+    }
+    _normalize();
+
+    if (configured && !qemu_memfilter_enabled()) {
+        logger_warnf("memfilter: no shared range resolved, instrumenting "
+                     "all memory accesses\n");
+    } else if (qemu_memfilter_enabled()) {
+        logger_infof("memfilter: instrumenting %lu shared ranges\n",
+                     g_qemu_memfilter_count);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef LOTTO_QEMU_MEMFILTER_H
+#define LOTTO_QEMU_MEMFILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define QEMU_MEMFILTER_MAX_RANGES 256
+
+/* Half-open guest virtual address range [start, end). */
+typedef struct qemu_memfilter_range {
+    uint64_t start;
+    uint64_t end;
+} qemu_memfilter_range_t;
+
+/* Sorted, non-overlapping ranges of shared guest memory. Filled once by
+ * qemu_memfilter_init() before any translation happens. */
+extern qemu_memfilter_range_t g_qemu_memfilter_ranges[];
+extern size_t g_qemu_memfilter_count;
+
+/* Reads the configured ranges from LOTTO_QEMU_INSTR_RANGES and the ranges of
+ * the symbols listed in LOTTO_QEMU_INSTR_SYMBOLS. */
+void qemu_memfilter_init(void);
+
+/* Whether memory accesses are restricted to the configured ranges. */
+static inline bool
+qemu_memfilter_enabled(void)
+{
+    return g_qemu_memfilter_count > 0;
+}
+
+/* Whether the access [vaddr, vaddr + size) overlaps a configured range. */
+static inline bool
+qemu_memfilter_match(uint64_t vaddr, uint64_t size)
+{
+    size_t lo = 0;
+    size_t hi = g_qemu_memfilter_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (g_qemu_memfilter_ranges[mid].end <= vaddr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < g_qemu_memfilter_count &&
+           g_qemu_memfilter_ranges[lo].start < vaddr + size;
+}
+
+#endif
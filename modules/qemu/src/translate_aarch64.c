@@ -3,7 +3,9 @@
 #include <string.h>
 
 #include "translate_aarch64.h"
+#include "insn_cache.h"
 #include "interceptors.h"
+#include "memfilter.h"
 #include <dice/chains/intercept.h>
 #include <lotto/engine/pubsub.h>
 #include <lotto/modules/qemu/events.h>
@@ -15,6 +17,15 @@
 #define AARCH64_WFE_OPCODE 0xd503205fU
 #define AARCH64_WFI_OPCODE 0xd503207fU
 
+/* Loads and stores: op0 == x1x0 */
+#define AARCH64_LDST_MASK    0x0a000000U
+#define AARCH64_LDST_VAL     0x08000000U
+/* Load register (literal) is PC-relative and has no base register */
+#define AARCH64_LDR_LIT_MASK 0x3b000000U
+#define AARCH64_LDR_LIT_VAL  0x18000000U
+#define AARCH64_RN(opcode)   (((opcode) >> 5) & 0x1fU)
+#define AARCH64_RN_SP        31U
+
 static icounter_t g_inline_insn_count;
 static bool g_inline_insn_count_initialized = false;
 
@@ -23,6 +34,7 @@ typedef struct qemu_translation_policy {
     bool udf;
     bool yield;
     bool wf;
+    bool stack;
 } qemu_translation_policy_t;
 
 static bool
@@ -47,6 +59,7 @@ translation_policy(void)
             .udf       = env_enabled("LOTTO_QEMU_INSTR_UDF", true),
             .yield     = env_enabled("LOTTO_QEMU_INSTR_YIELD", true),
             .wf        = env_enabled("LOTTO_QEMU_INSTR_WF", true),
+            .stack     = env_enabled("LOTTO_QEMU_INSTR_STACK", true),
         };
         initialized = true;
     }
@@ -101,66 +114,109 @@ is_atomic_like_memaccess_insn(struct qemu_plugin_insn *insn)
     return atomic;
 }
 
-static void
-bind_udf_instruction(struct qemu_plugin_insn *insn, uint32_t opcode,
-                     const qemu_translation_policy_t *policy)
+/* Whether the instruction accesses memory through the stack pointer. Such
+ * accesses hit the private stack of the vCPU and can be dropped at
+ * translation time. */
+static bool
+is_stack_memaccess_insn(uint32_t opcode)
 {
-    if (!policy->udf || (opcode & UDF_MASK) != 0) {
-        return;
-    }
-    (void)insn;
-    (void)opcode;
+    return (opcode & AARCH64_LDST_MASK) == AARCH64_LDST_VAL &&
+           (opcode & AARCH64_LDR_LIT_MASK) != AARCH64_LDR_LIT_VAL &&
+           AARCH64_RN(opcode) == AARCH64_RN_SP;
 }
 
-static void
-bind_wf_instruction(struct qemu_plugin_insn *insn, uint32_t opcode,
-                    const qemu_translation_policy_t *policy)
+/* Takes the instrumentation decisions for one instruction. This is the
+ * expensive part of translation (atomic-like accesses need disassembly), so
+ * its result is cached per instruction. */
+static uint8_t
+decode_insn(struct qemu_plugin_insn *insn, uint32_t opcode,
+            const qemu_translation_policy_t *policy)
 {
-    if (!policy->wf) {
-        return;
+    uint8_t decision = 0;
+
+    if (policy->memaccess &&
+        (policy->stack || !is_stack_memaccess_insn(opcode))) {
+        decision |= QEMU_INSN_MEMACCESS;
+        if (is_atomic_like_memaccess_insn(insn)) {
+            decision |= QEMU_INSN_ATOMIC_LIKE;
+        }
     }
 
-    if (opcode == AARCH64_WFE_OPCODE) {
-        bind_wfe_callback(insn);
-        return;
+    if (policy->udf && opcode == LOTTO_TRAP_A64_VAL) {
+        return decision | QEMU_INSN_UDF_TRAP;
     }
 
-    if (opcode == AARCH64_WFI_OPCODE) {
-        bind_wfi_callback(insn);
+    if (policy->wf && opcode == AARCH64_WFE_OPCODE) {
+        decision |= QEMU_INSN_WFE;
+    } else if (policy->wf && opcode == AARCH64_WFI_OPCODE) {
+        decision |= QEMU_INSN_WFI;
     }
+    return decision;
 }
 
 static void
-decode_and_bind_insn(struct qemu_plugin_insn *insn,
-                     const qemu_translation_policy_t *policy)
+bind_insn(struct qemu_plugin_insn *insn, uint8_t decision)
 {
-    uint32_t opcode = get_instruction_data(insn);
     register_vcpu_insn_exec_inline(insn, QEMU_PLUGIN_INLINE_ADD_U64,
                                    &g_inline_insn_count, 1);
 
-    if (policy->memaccess) {
-        bind_memaccess_callback(insn, is_atomic_like_memaccess_insn(insn));
+    if (decision & QEMU_INSN_MEMACCESS) {
+        bool atomic_like = (decision & QEMU_INSN_ATOMIC_LIKE) != 0;
+        if (qemu_memfilter_enabled()) {
+            bind_memaccess_filtered_callback(insn, atomic_like);
+        } else {
+            bind_memaccess_callback(insn, atomic_like);
+        }
     }
 
-    if (policy->udf && opcode == LOTTO_TRAP_A64_VAL) {
+    if (decision & QEMU_INSN_UDF_TRAP) {
         bind_udf_trap_callback(insn);
-        return;
+    } else if (decision & QEMU_INSN_WFE) {
+        bind_wfe_callback(insn);
+    } else if (decision & QEMU_INSN_WFI) {
+        bind_wfi_callback(insn);
     }
+}
 
-    bind_wf_instruction(insn, opcode, policy);
-    bind_udf_instruction(insn, opcode, policy);
+/* The host address backing the guest code identifies its physical location,
+ * so the same code mapped at several virtual addresses shares an entry. */
+static uint64_t
+insn_cache_key(struct qemu_plugin_insn *insn)
+{
+    void *haddr = qemu_plugin_insn_haddr(insn);
+    return haddr != NULL ? (uint64_t)(uintptr_t)haddr :
+                           qemu_plugin_insn_vaddr(insn);
 }
 
-void
+static bool
+decode_and_bind_insn(struct qemu_plugin_insn *insn,
+                     const qemu_translation_policy_t *policy)
+{
+    uint32_t opcode = get_instruction_data(insn);
+    uint64_t key    = insn_cache_key(insn);
+    uint8_t decision;
+
+    bool hit = qemu_insn_cache_get(key, opcode, &decision);
+    if (!hit) {
+        decision = decode_insn(insn, opcode, policy);
+        qemu_insn_cache_put(key, opcode, decision);
+    }
+    bind_insn(insn, decision);
+    return hit;
+}
+
+size_t
 qemu_on_tb_translate(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
 {
     (void)id;
     qemu_translation_policy_t policy = translation_policy();
     size_t n                         = qemu_plugin_tb_n_insns(tb);
+    size_t hits                      = 0;
     for (size_t i = 0; i < n; i++) {
         struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
-        decode_and_bind_insn(insn, &policy);
+        hits += decode_and_bind_insn(insn, &policy) ? 1 : 0;
     }
+    return hits;
 }
 
 void
@@ -172,7 +228,7 @@ qemu_dispatch_tb_translate(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
         .insn_count = qemu_plugin_tb_n_insns(tb),
     };
 
-    qemu_on_tb_translate(id, tb);
+    ev.cache_hits = qemu_on_tb_translate(id, tb);
     PS_PUBLISH(CHAIN_QEMU_CONTROL, EVENT_QEMU_TRANSLATE, &ev, 0);
 }
 
@@ -186,6 +242,8 @@ qemu_on_plugin_start(qemu_plugin_id_t id, const qemu_info_t *info, int argc,
     (void)argv;
     icounter_init(&g_inline_insn_count);
     g_inline_insn_count_initialized = true;
+    qemu_memfilter_init();
+    qemu_insn_cache_clear();
     qemu_emit_start();
 }
 
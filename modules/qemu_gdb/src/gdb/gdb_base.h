@@ -5,7 +5,11 @@
 #ifndef LOTTO_QEMU_GDB_BASE_H
 #define LOTTO_QEMU_GDB_BASE_H
 
-#define GDB_MAX_MESSAGE_LENGTH 8192
-#define GDB_MAX_PACKET_LENGTH  16384
+// PacketSize advertised in qSupported: the largest payload the client may
+// send, and the largest read the client will request per packet.
+#define GDB_PACKET_SIZE        0x10000
+#define GDB_MAX_MESSAGE_LENGTH (GDB_PACKET_SIZE + 64)
+// escaping binary payloads may double their size, plus framing
+#define GDB_MAX_PACKET_LENGTH (2 * GDB_MAX_MESSAGE_LENGTH + 8)
 
 #endif // LOTTO_QEMU_GDB_BASE_H
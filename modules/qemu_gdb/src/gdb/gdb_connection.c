@@ -201,14 +201,16 @@ gdb_awaits_host_ack()
 int64_t
 gdb_srv_recv_pkt(struct pollfd *fds, int *nfds)
 {
-    char buffer[GDB_MAX_PACKET_LENGTH];
-    uint64_t pkt_len = 0;
+    // bytes of an incomplete packet are carried over to the next call, since
+    // large packets arrive split over several TCP segments
+    char *buffer     = _state.recv_buffer_cli;
+    uint64_t pkt_len = _state.recv_buffer_cli_idx;
     uint64_t pkt_idx = 0;
     int64_t rc;
 
-    rc         = recv(fds->fd, buffer, sizeof(buffer), 0);
-    buffer[rc] = '\0';
-    // logger_infof( "Received pkt from gdb client:\n%s\n", buffer);
+    ASSERT(pkt_len < sizeof(_state.recv_buffer_cli) - 1);
+    rc = recv(fds->fd, buffer + pkt_len,
+              sizeof(_state.recv_buffer_cli) - pkt_len - 1, 0);
 
     // connection closed
     if (rc == 0) {
@@ -216,13 +218,16 @@ gdb_srv_recv_pkt(struct pollfd *fds, int *nfds)
         fds->fd     = 0;
         fds->events = 0;
         (*nfds)--;
+        _state.recv_buffer_cli_idx = 0;
     }
 
-    pkt_len = rc;
-
     if (rc < 0)
         return rc;
 
+    pkt_len += rc;
+    buffer[pkt_len] = '\0';
+    // logger_infof( "Received pkt from gdb client:\n%s\n", buffer);
+
     while (pkt_idx < pkt_len) {
         switch (buffer[pkt_idx]) {
             case 0x03:
@@ -237,7 +242,13 @@ gdb_srv_recv_pkt(struct pollfd *fds, int *nfds)
                 pkt_idx++;
                 break;
             case '$': {
-                uint64_t actual_pkt_len = pkt_len - pkt_idx;
+                // '#' is always escaped inside the payload, so the first one
+                // ends the packet; two checksum characters follow
+                char *end = memchr(buffer + pkt_idx, '#', pkt_len - pkt_idx);
+                if (end == NULL || end + 3 > buffer + pkt_len) {
+                    goto incomplete;
+                }
+                uint64_t actual_pkt_len = end + 3 - (buffer + pkt_idx);
                 rc = gdb_srv_handle_pkt(fds->fd, (uint8_t *)buffer + pkt_idx,
                                         actual_pkt_len);
                 pkt_idx += actual_pkt_len;
@@ -252,6 +263,9 @@ gdb_srv_recv_pkt(struct pollfd *fds, int *nfds)
         }
     }
 
+incomplete:
+    _state.recv_buffer_cli_idx = pkt_len - pkt_idx;
+    memmove(buffer, buffer + pkt_idx, _state.recv_buffer_cli_idx);
     return 0;
 }
 
@@ -15,7 +15,8 @@ typedef struct packet_queue_s {
     mapitem_t ti;
     uint64_t pkt_len;
     int32_t fd;
-    uint8_t pkt[GDB_MAX_PACKET_LENGTH];
+    // sized to the packet: most queued packets are single-byte acks
+    uint8_t *pkt;
 } packet_queue_t;
 
 static struct gdb_srv_send {
@@ -24,6 +25,8 @@ static struct gdb_srv_send {
     uint64_t packet_num_dequeue;
     uint8_t srv_last_send_pkt[GDB_MAX_PACKET_LENGTH];
     uint64_t srv_last_send_pkt_len;
+    // framing buffer of gdb_send_msg, too large for the stack
+    uint8_t packet[GDB_MAX_PACKET_LENGTH];
 } _state;
 
 int64_t
@@ -43,10 +46,17 @@ gdb_dequeue_pkt()
 
     // logger_infof( "Sending packet:\n%s\n", dequeued_pkt->pkt);
 
-    rc = write(dequeued_pkt->fd, dequeued_pkt->pkt, dequeued_pkt->pkt_len);
+    // large binary replies may not fit the socket buffer in one write
+    for (uint64_t off = 0; off < dequeued_pkt->pkt_len; off += rc) {
+        rc = write(dequeued_pkt->fd, dequeued_pkt->pkt + off,
+                   dequeued_pkt->pkt_len - off);
+        if (rc <= 0)
+            break;
+    }
 
     rc = gdb_srv_save_last_send_pkt(dequeued_pkt->pkt, dequeued_pkt->pkt_len);
 
+    rl_free(dequeued_pkt->pkt);
     map_deregister(&_state.packet_queue, _state.packet_num_dequeue);
     return rc;
 }
@@ -73,6 +83,8 @@ gdb_enqueue_pkt(int fd, uint8_t *pkt, uint64_t pkt_len)
         &_state.packet_queue, _state.packet_num_enqueue);
     enqueued_pkt->fd      = fd;
     enqueued_pkt->pkt_len = pkt_len;
+    enqueued_pkt->pkt     = rl_malloc(pkt_len);
+    ASSERT(enqueued_pkt->pkt != NULL);
     rl_memcpy(enqueued_pkt->pkt, pkt, pkt_len);
 
     if (pkt_len > 1) {
@@ -94,12 +106,11 @@ gdb_send_pkt(int fd, uint8_t *pkt, uint64_t pkt_len)
 int64_t
 gdb_send_msg(int fd, uint8_t *msg, uint64_t msg_len)
 {
-    uint8_t packet[GDB_MAX_PACKET_LENGTH];
     uint64_t pkt_len = 0;
 
-    pkt_len = rsp_construct_pkt(packet, msg, msg_len);
+    pkt_len = rsp_construct_pkt(_state.packet, msg, msg_len);
 
-    return gdb_send_pkt(fd, packet, pkt_len);
+    return gdb_send_pkt(fd, _state.packet, pkt_len);
 }
 
 int64_t
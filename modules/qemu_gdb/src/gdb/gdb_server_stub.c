@@ -57,6 +57,12 @@ gdb_srv_handle_msg(int fd, uint8_t *msg, uint64_t msg_len)
         case 'v':
             return gdb_srv_handle_v(fd, msg, msg_len);
             break;
+        case 'x':
+            return gdb_srv_handle_x(fd, msg, msg_len);
+            break;
+        case 'X':
+            return gdb_srv_handle_X(fd, msg, msg_len);
+            break;
         case 'z':
             return gdb_srv_handle_z(fd, msg, msg_len);
             break;
@@ -79,7 +85,8 @@ gdb_srv_handle_pkt(int fd, uint8_t *pkt, uint64_t pkt_len)
     ASSERT(pkt != NULL);
     ASSERT(pkt_len > 0);
 
-    uint8_t msg[GDB_MAX_PACKET_LENGTH];
+    // one message is handled at a time, and it is too large for the stack
+    static uint8_t msg[GDB_MAX_PACKET_LENGTH];
 
     uint64_t msg_len = rsp_extract_pkt(msg, pkt, &pkt_len);
     return gdb_srv_handle_msg(fd, msg, msg_len);
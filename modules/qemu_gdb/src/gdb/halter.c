@@ -4,6 +4,7 @@
 #include "gdb/gdb_connection.h"
 #include "gdb/halter.h"
 #include "gdb/handling/execute.h"
+#include "gdb/handling/memory.h"
 #include "gdb/handling/query.h"
 #include "gdb/handling/stop_reason.h"
 #include <lotto/base/task_id.h>
@@ -117,6 +118,7 @@ gdb_execution_halt(task_id tid)
     _state.gdb_execution_tid = tid;
     vatomic32_xchg(&_state.gdb_execution_state, GDB_EXECUTION_HALTED);
     _state.gdb_halt_handled = false;
+    gdb_mem_snapshot_invalidate();
     // rl_fprintf(stderr, "Halting on tid %lx\n", tid);
     uint32_t val =
         vatomic32_await_neq(&_state.gdb_execution_state, GDB_EXECUTION_HALTED);
@@ -135,6 +137,7 @@ void
 gdb_execution_run()
 {
     _state.gdb_execution_tid = ANY_TASK;
+    gdb_mem_snapshot_invalidate();
     // lotto_execution_state = GDB_EXECUTION_RUNNING;
     vatomic32_xchg(&_state.gdb_execution_state, GDB_EXECUTION_RUNNING);
 }
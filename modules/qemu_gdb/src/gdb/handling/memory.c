@@ -5,67 +5,151 @@
 #include "gdb/arm_cpu.h"
 #include "gdb/gdb_base.h"
 #include "gdb/gdb_send.h"
+#include "gdb/handling/memory.h"
 #include "gdb/rsp_util.h"
 #include <lotto/unsafe/_sys.h>
+// vsync
+#include <vsync/atomic.h>
 
 int cpu_memory_rw_debug(/*CPUState*/ void *cpu, uint64_t addr, void *ptr,
                         size_t len, bool is_write);
 
-// read memory
-int64_t
-gdb_srv_handle_m(int fd, uint8_t *msg, uint64_t msg_len)
+#define GDB_MEM_PAGE_SIZE   4096UL
+#define GDB_MEM_CACHE_PAGES 512UL
+
+// Guest memory does not change while the execution is halted, so pages read
+// once during a stop are served from this snapshot until the execution
+// resumes. Pages are tagged with the epoch of the stop that read them;
+// bumping the epoch drops the whole snapshot at once.
+typedef struct mem_page_s {
+    uint64_t epoch;
+    uint64_t cpu_index;
+    uint64_t addr;
+    uint8_t data[GDB_MEM_PAGE_SIZE];
+} mem_page_t;
+
+static struct memory_state {
+    vatomic64_t epoch;
+    mem_page_t pages[GDB_MEM_CACHE_PAGES];
+} _state = {
+    .epoch = VATOMIC_INIT(1),
+};
+
+void
+gdb_mem_snapshot_invalidate(void)
 {
-    uint8_t memory_value[8192];
-    uint8_t msg_answer[GDB_MAX_MESSAGE_LENGTH];
-    uint64_t msg_answer_idx = 0;
-    uint64_t msg_answer_len = 0;
+    vatomic64_inc(&_state.epoch);
+}
 
-    uint64_t msg_idx = 0;
+static bool
+gdb_mem_addr_valid(uint64_t addr)
+{
+    return addr != 0 && addr <= 0xfffffffff0000000;
+}
 
-    int64_t rc = 0;
+static const uint8_t *
+gdb_mem_snapshot_page(void *cpu, uint64_t cpu_index, uint64_t page_addr)
+{
+    uint64_t epoch = vatomic64_read(&_state.epoch);
+    mem_page_t *page =
+        &_state.pages[(page_addr / GDB_MEM_PAGE_SIZE) % GDB_MEM_CACHE_PAGES];
 
-    uint64_t mem_addr = 0;
-    // uint64_t mem_value = 0;
-    uint64_t mem_size = 0; // in bytes
+    if (page->epoch == epoch && page->cpu_index == cpu_index &&
+        page->addr == page_addr) {
+        return page->data;
+    }
+    if (cpu_memory_rw_debug(cpu, page_addr, page->data, GDB_MEM_PAGE_SIZE,
+                            0) != 0) {
+        // partially mapped page, let the caller read what it needs directly
+        page->epoch = 0;
+        return NULL;
+    }
+    page->epoch     = epoch;
+    page->cpu_index = cpu_index;
+    page->addr      = page_addr;
+    return page->data;
+}
 
+// Returns the number of bytes read before the first inaccessible address.
+static uint64_t
+gdb_mem_read(uint64_t addr, uint8_t *buf, uint64_t len)
+{
     uint64_t cur_cpu = gdb_srv_get_cur_cpuindex();
+    void *cpu        = gdb_get_pcpu(cur_cpu);
+    uint64_t done    = 0;
+
+    while (done < len) {
+        uint64_t page_addr   = (addr + done) & ~(GDB_MEM_PAGE_SIZE - 1);
+        uint64_t page_offset = addr + done - page_addr;
+        uint64_t chunk = MIN(len - done, GDB_MEM_PAGE_SIZE - page_offset);
+
+        const uint8_t *data = gdb_mem_snapshot_page(cpu, cur_cpu, page_addr);
+        if (data != NULL) {
+            rl_memcpy(buf + done, data + page_offset, chunk);
+        } else if (cpu_memory_rw_debug(cpu, addr + done, buf + done, chunk,
+                                       0) != 0) {
+            break;
+        }
+        done += chunk;
+    }
+    return done;
+}
 
-    void *cpu = gdb_get_pcpu(cur_cpu);
-
-    ASSERT(msg[0] == 'm');
-    ASSERT(msg_len > 1);
-
-    // skip 'm'
-    msg_idx = 1;
+// Parses "<addr>,<len>" following the command character. Returns the index
+// of the first character after <len>.
+static uint64_t
+gdb_mem_parse_addr_len(uint8_t *msg, uint64_t msg_len, uint64_t *addr,
+                       uint64_t *len)
+{
+    // skip command character
+    uint64_t msg_idx = 1;
 
-    char *sep_ptr = strchr((char *)msg + msg_idx, ',');
+    uint8_t *sep_ptr = memchr(msg + msg_idx, ',', msg_len - msg_idx);
     ASSERT(sep_ptr != NULL);
 
-    uint64_t addr_len = sep_ptr - (char *)msg - msg_idx;
+    uint64_t addr_len = sep_ptr - msg - msg_idx;
     ASSERT(addr_len >= 1);
 
-    mem_addr = rsp_str_to_hex((char *)msg + msg_idx, addr_len);
-    msg_idx += addr_len;
+    *addr = rsp_str_to_hex((char *)msg + msg_idx, addr_len);
+    msg_idx += addr_len + 1;
 
-    ASSERT(msg[msg_idx] == ',');
-    msg_idx++;
+    uint8_t *end_ptr = memchr(msg + msg_idx, ':', msg_len - msg_idx);
+    uint64_t len_len = end_ptr != NULL ? (uint64_t)(end_ptr - msg - msg_idx) :
+                                         msg_len - msg_idx;
+
+    *len = rsp_str_to_hex((char *)msg + msg_idx, len_len);
+    return msg_idx + len_len;
+}
+
+// read memory
+int64_t
+gdb_srv_handle_m(int fd, uint8_t *msg, uint64_t msg_len)
+{
+    uint8_t memory_value[GDB_PACKET_SIZE / 2];
+    uint8_t msg_answer[GDB_MAX_MESSAGE_LENGTH];
+    uint64_t msg_answer_idx = 0;
+    uint64_t msg_answer_len = 0;
+
+    uint64_t mem_addr = 0;
+    uint64_t mem_size = 0; // in bytes
+
+    ASSERT(msg[0] == 'm');
+    ASSERT(msg_len > 1);
 
-    mem_size = rsp_str_to_hex((char *)msg + msg_idx, msg_len - msg_idx);
-    // ASSERT(mem_size % 4 == 0);
-    ASSERT(mem_size <= 8192);
+    gdb_mem_parse_addr_len(msg, msg_len, &mem_addr, &mem_size);
+    // a shorter reply is valid, the client asks again for the rest
+    mem_size = MIN(mem_size, sizeof(memory_value));
     // logger_infof("Reading %d bytes from 0x%lx\n", mem_size, mem_addr);
 
-    if (mem_addr == 0 || mem_addr > 0xfffffffff0000000) {
+    if (!gdb_mem_addr_valid(mem_addr)) {
         gdb_send_ack(fd);
         gdb_send_error(fd, 0x14);
         return 0;
-        // rl_memset(memory_value, 0, mem_size);
-    } else {
-        rc = cpu_memory_rw_debug(cpu, mem_addr, memory_value, mem_size, 0);
-        // ASSERT(rc == 0);
-        if (rc != 0) {
-            rl_memset(memory_value, 0, mem_size);
-        }
+    }
+
+    uint64_t read = gdb_mem_read(mem_addr, memory_value, mem_size);
+    if (read != mem_size) {
+        rl_memset(memory_value, 0, mem_size);
     }
 
     for (uint64_t i = 0; i < mem_size; i++) {
@@ -78,3 +162,70 @@ gdb_srv_handle_m(int fd, uint8_t *msg, uint64_t msg_len)
     gdb_send_ack(fd);
     return gdb_send_msg(fd, msg_answer, msg_answer_len);
 }
+
+// read memory, binary reply
+int64_t
+gdb_srv_handle_x(int fd, uint8_t *msg, uint64_t msg_len)
+{
+    uint8_t msg_answer[GDB_MAX_MESSAGE_LENGTH];
+
+    uint64_t mem_addr = 0;
+    uint64_t mem_size = 0; // in bytes
+
+    ASSERT(msg[0] == 'x');
+    ASSERT(msg_len > 1);
+
+    gdb_mem_parse_addr_len(msg, msg_len, &mem_addr, &mem_size);
+    mem_size = MIN(mem_size, GDB_PACKET_SIZE);
+
+    gdb_send_ack(fd);
+
+    if (!gdb_mem_addr_valid(mem_addr)) {
+        return gdb_send_error(fd, 0x14);
+    }
+
+    // the data is escaped when the packet is constructed
+    msg_answer[0] = 'b';
+    uint64_t read = gdb_mem_read(mem_addr, msg_answer + 1, mem_size);
+    if (read == 0 && mem_size > 0) {
+        return gdb_send_error(fd, 0x14);
+    }
+    return gdb_send_msg(fd, msg_answer, 1 + read);
+}
+
+// write memory, binary data
+int64_t
+gdb_srv_handle_X(int fd, uint8_t *msg, uint64_t msg_len)
+{
+    uint64_t mem_addr = 0;
+    uint64_t mem_size = 0; // in bytes
+
+    ASSERT(msg[0] == 'X');
+    ASSERT(msg_len > 1);
+
+    uint64_t msg_idx = gdb_mem_parse_addr_len(msg, msg_len, &mem_addr,
+                                              &mem_size);
+    ASSERT(msg[msg_idx] == ':');
+    msg_idx++;
+    ASSERT(msg_len - msg_idx == mem_size);
+
+    gdb_send_ack(fd);
+
+    // a zero-length write probes for X support
+    if (mem_size == 0) {
+        return gdb_send_ok(fd);
+    }
+
+    if (!gdb_mem_addr_valid(mem_addr)) {
+        return gdb_send_error(fd, 0x14);
+    }
+
+    void *cpu  = gdb_get_pcpu(gdb_srv_get_cur_cpuindex());
+    int64_t rc = cpu_memory_rw_debug(cpu, mem_addr, msg + msg_idx, mem_size, 1);
+    gdb_mem_snapshot_invalidate();
+
+    if (rc != 0) {
+        return gdb_send_error(fd, 0x14);
+    }
+    return gdb_send_ok(fd);
+}
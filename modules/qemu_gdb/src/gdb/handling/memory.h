@@ -8,5 +8,10 @@
 #include <stdint.h>
 
 int64_t gdb_srv_handle_m(int fd, uint8_t *msg, uint64_t msg_len);
+int64_t gdb_srv_handle_x(int fd, uint8_t *msg, uint64_t msg_len);
+int64_t gdb_srv_handle_X(int fd, uint8_t *msg, uint64_t msg_len);
+
+/* Drops the guest memory read since the last stop. */
+void gdb_mem_snapshot_invalidate(void);
 
 #endif // LOTTO_GDB_MEMORY_H
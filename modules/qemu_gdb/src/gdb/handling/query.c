@@ -18,21 +18,40 @@ static struct query_state {
     int64_t ti_idx;
 } _state;
 
+// Addresses outside this range are refused by the memory handlers. The map
+// lets the client skip them instead of issuing requests that fail.
+static const char memory_map_xml[] =
+    "<?xml version=\"1.0\"?>\n"
+    "<!DOCTYPE memory-map PUBLIC "
+    "\"+//IDN gnu.org//DTD GDB Memory Map V1.0//EN\" "
+    "\"http://sourceware.org/gdb/gdb-memory-map.dtd\">\n"
+    "<memory-map>\n"
+    "  <memory type=\"ram\" start=\"0x1000\" length=\"0xffffffffeffff000\"/>\n"
+    "</memory-map>\n";
+
 static int64_t
 gdb_srv_handle_xfer(int fd, uint8_t *xfer, uint64_t msg_len)
 {
     ASSERT(xfer);
     ASSERT(msg_len > 0);
 
-    char *read_file;
+    char *read_file = NULL;
+    char *fread     = NULL;
 
     // logger_infof("Got Xfer request: %s\n", xfer);
 
-    // feature request
     if (rl_strncmp((char *)xfer,
                    "features:read:", rl_strlen("features:read:")) == 0) {
-        char *fread = (char *)xfer + rl_strlen("features:read:");
+        // feature request
+        fread = (char *)xfer + rl_strlen("features:read:");
+    } else if (rl_strncmp((char *)xfer, "memory-map:read:",
+                          rl_strlen("memory-map:read:")) == 0) {
+        // memory map request, the annex is empty
+        fread     = (char *)xfer + rl_strlen("memory-map:read:");
+        read_file = (char *)memory_map_xml;
+    }
 
+    if (fread != NULL) {
         char annex[1024];
         uint64_t annex_len = 0;
 
@@ -64,6 +83,7 @@ gdb_srv_handle_xfer(int fd, uint8_t *xfer, uint64_t msg_len)
         ASSERT(length_end != NULL);
         length_len  = length_end - length;
         read_length = rsp_str_to_hex(length, length_len);
+        read_length = MIN(read_length, GDB_PACKET_SIZE);
 
         if (strcmp(annex, "target.xml") == 0) {
             // logger_infof("  target.xml\n");
@@ -98,7 +118,7 @@ gdb_srv_handle_xfer(int fd, uint8_t *xfer, uint64_t msg_len)
 
         gdb_send_ack(fd);
 
-        char msg_answer[8192];
+        char msg_answer[GDB_MAX_MESSAGE_LENGTH];
         msg_answer[0] = list_chr;
         strncpy(msg_answer + 1, read_file_start,
                 MIN(read_file_len, read_length));
@@ -122,11 +142,7 @@ gdb_srv_handle_supported(int fd, uint8_t *supported, uint64_t msg_len)
     ASSERT(msg_len > 0);
 
     char *ptok = NULL;
-    char *support_answer =
-        "PacketSize=1000;qXfer:features:read+;vContSupported+;multiprocess+;"
-        "swbreak+;hwbreak+";
-    uint8_t support_packet[GDB_MAX_PACKET_LENGTH];
-    uint64_t pkt_len = 0;
+    char support_answer[256];
 
     // logger_infof("Got Supported info:\n");
 
@@ -138,9 +154,13 @@ gdb_srv_handle_supported(int fd, uint8_t *supported, uint64_t msg_len)
 
     gdb_send_ack(fd);
 
-    pkt_len = rsp_construct_pkt(support_packet, (uint8_t *)support_answer,
-                                rl_strlen(support_answer));
-    gdb_send_pkt(fd, support_packet, pkt_len);
+    // binary-upload+ announces the x packet
+    rl_snprintf(support_answer, sizeof(support_answer),
+                "PacketSize=%x;qXfer:features:read+;qXfer:memory-map:read+;"
+                "binary-upload+;vContSupported+;multiprocess+;swbreak+;"
+                "hwbreak+",
+                GDB_PACKET_SIZE);
+    gdb_send_msg(fd, (uint8_t *)support_answer, rl_strlen(support_answer));
 
     return 0;
 }
@@ -305,8 +305,9 @@ rsp_extract_pkt(uint8_t *msg, uint8_t *pkt, uint64_t *pkt_len)
         rsp_unescape_msg(msg, &chk_sum, pkt + pkt_idx, &msg_escaped_len);
     ASSERT(msg_unescaped_len > 0);
 
-    // increase packet index by escaped message length
-    pkt_idx += msg_unescaped_len;
+    // increase packet index by escaped message length, which is larger than
+    // the unescaped length if the message carries escaped binary data
+    pkt_idx += msg_escaped_len;
 
     // check rsp message end character
     if (pkt[pkt_idx] != (uint8_t)'#') {
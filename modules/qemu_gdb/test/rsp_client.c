@@ -51,11 +51,24 @@ connect_range_retry(const char *host, uint16_t port, uint16_t span,
     return -1;
 }
 
+static struct {
+    char data[65536];
+    size_t pos;
+    size_t len;
+} rx;
+
 static int
 recv_byte(int fd, char *out)
 {
-    ssize_t n = recv(fd, out, 1, 0);
-    return n == 1 ? 0 : -1;
+    if (rx.pos == rx.len) {
+        ssize_t n = recv(fd, rx.data, sizeof(rx.data), 0);
+        if (n <= 0)
+            return -1;
+        rx.pos = 0;
+        rx.len = (size_t)n;
+    }
+    *out = rx.data[rx.pos++];
+    return 0;
 }
 
 static int
@@ -79,12 +92,19 @@ recv_packet(int fd, char *buf, size_t cap)
             break;
         if (len + 1 >= cap)
             return -1;
-        buf[len++] = ch;
         csum += (uint8_t)ch;
+        // binary replies escape '#', '$', '*' and '}'
+        if (ch == '}') {
+            if (recv_byte(fd, &ch) != 0)
+                return -1;
+            csum += (uint8_t)ch;
+            ch ^= 0x20;
+        }
+        buf[len++] = ch;
     }
 
     char hex[2];
-    if (recv(fd, hex, 2, MSG_WAITALL) != 2)
+    if (recv_byte(fd, &hex[0]) != 0 || recv_byte(fd, &hex[1]) != 0)
         return -1;
 
     static const char h[] = "0123456789abcdef";
@@ -123,6 +143,95 @@ send_packet(int fd, const char *msg)
     return 0;
 }
 
+static double
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static int
+hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/* Reads `len` bytes at `addr` with `m` (hex) or `x` (binary) packets of at
+ * most `chunk` bytes. Returns the elapsed time in ms, or a negative value on
+ * error. */
+static double
+read_memory(int fd, char cmd, uint64_t addr, uint8_t *out, size_t len,
+            size_t chunk, char *buf, size_t cap)
+{
+    double start = now_ms();
+    size_t done  = 0;
+    while (done < len) {
+        char req[64];
+        size_t want = len - done < chunk ? len - done : chunk;
+        snprintf(req, sizeof(req), "%c%llx,%zx", cmd,
+                 (unsigned long long)(addr + done), want);
+        if (send_packet(fd, req) != 0)
+            return -1;
+        int n = recv_packet(fd, buf, cap);
+        if (n <= 0 || buf[0] == 'E')
+            return -1;
+
+        size_t got = 0;
+        if (cmd == 'x') {
+            if (buf[0] != 'b')
+                return -1;
+            got = (size_t)n - 1;
+            memcpy(out + done, buf + 1, got);
+        } else {
+            got = (size_t)n / 2;
+            for (size_t i = 0; i < got; i++) {
+                int hi = hex_nibble(buf[2 * i]);
+                int lo = hex_nibble(buf[2 * i + 1]);
+                if (hi < 0 || lo < 0)
+                    return -1;
+                out[done + i] = (uint8_t)(hi << 4 | lo);
+            }
+        }
+        if (got == 0)
+            return -1;
+        done += got;
+    }
+    return now_ms() - start;
+}
+
+/* Reads 1 MiB of guest RAM with hex and binary packets and compares both. */
+static int
+bench_read(int fd)
+{
+    enum { BENCH_ADDR = 0x40000000, BENCH_LEN = 1 << 20 };
+    static uint8_t hex_out[BENCH_LEN];
+    static uint8_t bin_out[BENCH_LEN];
+    static char buf[1 << 18];
+
+    double hex_ms = read_memory(fd, 'm', BENCH_ADDR, hex_out, BENCH_LEN,
+                                0x8000, buf, sizeof(buf));
+    double bin_ms = read_memory(fd, 'x', BENCH_ADDR, bin_out, BENCH_LEN,
+                                0x10000, buf, sizeof(buf));
+    if (hex_ms < 0 || bin_ms < 0) {
+        fprintf(stderr, "qemu-gdb-rsp: failed memory read\n");
+        return -1;
+    }
+    if (memcmp(hex_out, bin_out, BENCH_LEN) != 0) {
+        fprintf(stderr, "qemu-gdb-rsp: m and x reads differ\n");
+        return -1;
+    }
+    fprintf(stderr, "qemu-gdb-rsp: 1MiB read m=%.1fms x=%.1fms\n", hex_ms,
+            bin_ms);
+    return 0;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -132,6 +241,7 @@ main(int argc, char **argv)
         host = argv[1];
     if (argc >= 3)
         port = (uint16_t)strtoul(argv[2], NULL, 10);
+    bool bench = argc >= 4 && strcmp(argv[3], "--bench") == 0;
 
     int fd = connect_range_retry(host, port, 256, 5000);
     if (fd < 0)
@@ -151,6 +261,11 @@ main(int argc, char **argv)
         return 1;
     }
 
+    if (bench && bench_read(fd) != 0) {
+        close(fd);
+        return 1;
+    }
+
     if (send_packet(fd, "c") != 0 || recv_packet(fd, buf, sizeof(buf)) <= 0) {
         fprintf(stderr, "qemu-gdb-rsp: failed continue\n");
         close(fd);
@@ -1,7 +1,9 @@
 #include <inttypes.h>
+#include <qemu-plugin.h>
 #include <stdint.h>
 
 #include "profile_emit.h"
+#include "profile_hist.h"
 #include <lotto/sys/stdio.h>
 #include <lotto/sys/stdlib.h>
 #include <lotto/sys/string.h>
@@ -10,6 +12,7 @@ static struct {
     int enabled;
     uint64_t tb_count;
     uint64_t insn_count;
+    uint64_t insn_cache_hits;
     uint64_t mem_reads;
     uint64_t mem_writes;
     uint64_t udf_exit_count;
@@ -37,6 +40,9 @@ qemu_profile_on_init(void)
 {
     sys_memset(&g_qemu_profile, 0, sizeof(g_qemu_profile));
     g_qemu_profile.enabled = env_enabled("LOTTO_QEMU_PROFILE") ? 1 : 0;
+    if (g_qemu_profile.enabled) {
+        qemu_profile_hist_init();
+    }
 }
 
 void
@@ -50,38 +56,65 @@ qemu_profile_on_fini(void)
         return;
     }
 
+    uint64_t insns = __atomic_load_n(&g_qemu_profile.insn_count,
+                                     __ATOMIC_RELAXED);
+    uint64_t hits  = __atomic_load_n(&g_qemu_profile.insn_cache_hits,
+                                     __ATOMIC_RELAXED);
+
     sys_fprintf(
         stderr,
         "qemu-profile: tb=%" PRIu64 " insn=%" PRIu64 " mem-r=%" PRIu64
         " mem-w=%" PRIu64 " udf-exit=%" PRIu64 " udf-yield=%" PRIu64
-        " wfe=%" PRIu64 " wfi=%" PRIu64 "\n",
-        __atomic_load_n(&g_qemu_profile.tb_count, __ATOMIC_RELAXED),
-        __atomic_load_n(&g_qemu_profile.insn_count, __ATOMIC_RELAXED),
+        " wfe=%" PRIu64 " wfi=%" PRIu64 " insn-cache-hit=%" PRIu64
+        " (%.1f%%)\n",
+        __atomic_load_n(&g_qemu_profile.tb_count, __ATOMIC_RELAXED), insns,
         __atomic_load_n(&g_qemu_profile.mem_reads, __ATOMIC_RELAXED),
         __atomic_load_n(&g_qemu_profile.mem_writes, __ATOMIC_RELAXED),
         __atomic_load_n(&g_qemu_profile.udf_exit_count, __ATOMIC_RELAXED),
         __atomic_load_n(&g_qemu_profile.udf_yield_count, __ATOMIC_RELAXED),
         __atomic_load_n(&g_qemu_profile.wfe_count, __ATOMIC_RELAXED),
-        __atomic_load_n(&g_qemu_profile.wfi_count, __ATOMIC_RELAXED));
+        __atomic_load_n(&g_qemu_profile.wfi_count, __ATOMIC_RELAXED), hits,
+        insns == 0 ? 0.0 : 100.0 * (double)hits / (double)insns);
+    qemu_profile_hist_export();
+}
+
+static void
+_tb_exec_cb(unsigned int cpu_index, void *udata)
+{
+    (void)cpu_index;
+    qemu_profile_hist_tb_exec((uint64_t)(uintptr_t)udata);
 }
 
 void
-qemu_profile_on_translate(size_t insn_count)
+qemu_profile_on_translate(struct qemu_plugin_tb *tb, size_t insn_count,
+                          size_t cache_hits)
 {
     if (!profile_is_enabled()) {
         return;
     }
+    if (qemu_profile_hist_enabled()) {
+        uint64_t pc = qemu_plugin_tb_vaddr(tb);
+        qemu_profile_hist_tb_translated(pc, insn_count);
+        qemu_plugin_register_vcpu_tb_exec_cb(tb, _tb_exec_cb,
+                                             QEMU_PLUGIN_CB_NO_REGS,
+                                             (void *)(uintptr_t)pc);
+    }
     __atomic_fetch_add(&g_qemu_profile.tb_count, 1u, __ATOMIC_RELAXED);
     __atomic_fetch_add(&g_qemu_profile.insn_count, (uint64_t)insn_count,
                        __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_qemu_profile.insn_cache_hits, (uint64_t)cache_hits,
+                       __ATOMIC_RELAXED);
 }
 
 void
-qemu_profile_on_memaccess(bool is_store)
+qemu_profile_on_memaccess(uint64_t pc, bool is_store)
 {
     if (!profile_is_enabled()) {
         return;
     }
+    if (qemu_profile_hist_enabled()) {
+        qemu_profile_hist_memaccess(pc, is_store);
+    }
 
     if (is_store) {
         __atomic_fetch_add(&g_qemu_profile.mem_writes, 1u, __ATOMIC_RELAXED);
@@ -99,3 +132,12 @@ qemu_profile_on_udf_yield(void)
     }
     __atomic_fetch_add(&g_qemu_profile.udf_yield_count, 1u, __ATOMIC_RELAXED);
 }
+
+void
+qemu_profile_on_change_point(uint64_t pc)
+{
+    if (!profile_is_enabled() || !qemu_profile_hist_enabled()) {
+        return;
+    }
+    qemu_profile_hist_change_point(pc);
+}
@@ -3,11 +3,16 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+struct qemu_plugin_tb;
 
 void qemu_profile_on_init(void);
 void qemu_profile_on_fini(void);
-void qemu_profile_on_translate(size_t insn_count);
-void qemu_profile_on_memaccess(bool is_store);
+void qemu_profile_on_translate(struct qemu_plugin_tb *tb, size_t insn_count,
+                               size_t cache_hits);
+void qemu_profile_on_memaccess(uint64_t pc, bool is_store);
+void qemu_profile_on_change_point(uint64_t pc);
 void qemu_profile_on_udf_yield(void);
 
 #endif
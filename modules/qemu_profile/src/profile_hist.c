@@ -0,0 +1,321 @@
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "profile_hist.h"
+#include <lotto/modules/qemu/elf.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+
+#define SHARD_INIT_CAP 1024U
+
+typedef struct profile_site {
+    uint64_t pc;
+    uint64_t tb_execs;
+    uint64_t tb_insns;
+    uint64_t mem_reads;
+    uint64_t mem_writes;
+    uint64_t change_points;
+} profile_site_t;
+
+/* Open-addressing table keyed by guest PC; PC 0 marks a free slot. */
+typedef struct profile_table {
+    profile_site_t *sites;
+    size_t cap;
+    size_t used;
+} profile_table_t;
+
+typedef struct profile_shard {
+    profile_table_t table;
+    struct profile_shard *next;
+} profile_shard_t;
+
+typedef struct profile_symbol {
+    uint64_t addr;
+    uint64_t size;
+    char *name;
+} profile_symbol_t;
+
+static struct {
+    bool enabled;
+    const char *prefix;
+    profile_shard_t *shards;
+} _hist;
+
+static __thread profile_shard_t *_shard;
+
+static inline size_t
+_hash(uint64_t pc, size_t cap)
+{
+    return (size_t)(((pc >> 2) * 0x9e3779b97f4a7c15ULL) >> 32) & (cap - 1);
+}
+
+static profile_site_t *_table_site(profile_table_t *t, uint64_t pc);
+
+static void
+_table_grow(profile_table_t *t)
+{
+    profile_table_t old = *t;
+
+    t->cap   = old.cap == 0 ? SHARD_INIT_CAP : old.cap * 2;
+    t->used  = 0;
+    t->sites = sys_calloc(t->cap, sizeof(profile_site_t));
+    for (size_t i = 0; i < old.cap; i++) {
+        if (old.sites[i].pc != 0) {
+            *_table_site(t, old.sites[i].pc) = old.sites[i];
+        }
+    }
+    sys_free(old.sites);
+}
+
+static profile_site_t *
+_table_site(profile_table_t *t, uint64_t pc)
+{
+    if (2 * (t->used + 1) > t->cap) {
+        _table_grow(t);
+    }
+    for (size_t i = _hash(pc, t->cap);; i = (i + 1) & (t->cap - 1)) {
+        profile_site_t *s = &t->sites[i];
+        if (s->pc == pc) {
+            return s;
+        }
+        if (s->pc == 0) {
+            s->pc = pc;
+            t->used++;
+            return s;
+        }
+    }
+}
+
+static profile_site_t *
+_site(uint64_t pc)
+{
+    if (_shard == NULL) {
+        _shard = sys_calloc(1, sizeof(profile_shard_t));
+        _shard->next = __atomic_load_n(&_hist.shards, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&_hist.shards, &_shard->next,
+                                            _shard, true, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {}
+    }
+    return _table_site(&_shard->table, pc);
+}
+
+bool
+qemu_profile_hist_init(void)
+{
+    const char *prefix = sys_getenv("LOTTO_QEMU_PROFILE_OUT");
+
+    _hist.enabled = prefix != NULL && prefix[0] != '\0';
+    _hist.prefix  = prefix;
+    return _hist.enabled;
+}
+
+bool
+qemu_profile_hist_enabled(void)
+{
+    return _hist.enabled;
+}
+
+void
+qemu_profile_hist_tb_translated(uint64_t pc, size_t insn_count)
+{
+    if (pc != 0) {
+        _site(pc)->tb_insns = insn_count;
+    }
+}
+
+void
+qemu_profile_hist_tb_exec(uint64_t pc)
+{
+    if (pc != 0) {
+        _site(pc)->tb_execs++;
+    }
+}
+
+void
+qemu_profile_hist_memaccess(uint64_t pc, bool is_store)
+{
+    if (pc == 0) {
+        return;
+    }
+    profile_site_t *s = _site(pc);
+    if (is_store) {
+        s->mem_writes++;
+    } else {
+        s->mem_reads++;
+    }
+}
+
+void
+qemu_profile_hist_change_point(uint64_t pc)
+{
+    if (pc != 0) {
+        _site(pc)->change_points++;
+    }
+}
+
+/*******************************************************************************
+ * export
+ ******************************************************************************/
+
+static struct {
+    profile_symbol_t *syms;
+    size_t len;
+    size_t cap;
+} _symbols;
+
+static void
+_add_symbol(const char *name, uint64_t addr, uint64_t size, bool is_func,
+            void *arg)
+{
+    (void)arg;
+    if (!is_func) {
+        return;
+    }
+    if (_symbols.len == _symbols.cap) {
+        _symbols.cap  = _symbols.cap == 0 ? 256 : _symbols.cap * 2;
+        _symbols.syms = sys_realloc(_symbols.syms,
+                                    _symbols.cap * sizeof(profile_symbol_t));
+    }
+    _symbols.syms[_symbols.len++] = (profile_symbol_t){
+        .addr = addr,
+        .size = size,
+        .name = sys_strdup(name),
+    };
+}
+
+static int
+_symbol_cmp(const void *a, const void *b)
+{
+    const profile_symbol_t *x = a;
+    const profile_symbol_t *y = b;
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static const profile_symbol_t *
+_symbol_lookup(uint64_t pc)
+{
+    size_t lo = 0;
+    size_t hi = _symbols.len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (_symbols.syms[mid].addr <= pc) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return NULL;
+    }
+    const profile_symbol_t *s = &_symbols.syms[lo - 1];
+    return pc < s->addr + s->size ? s : NULL;
+}
+
+static int
+_site_cmp(const void *a, const void *b)
+{
+    const profile_site_t *x = a;
+    const profile_site_t *y = b;
+    return x->pc < y->pc ? -1 : x->pc > y->pc;
+}
+
+/* Merges the shards into a PC-sorted array of sites. */
+static profile_site_t *
+_merge(size_t *len)
+{
+    profile_table_t merged = {0};
+
+    for (profile_shard_t *sh = __atomic_load_n(&_hist.shards, __ATOMIC_ACQUIRE);
+         sh != NULL; sh = sh->next) {
+        for (size_t i = 0; i < sh->table.cap; i++) {
+            const profile_site_t *s = &sh->table.sites[i];
+            if (s->pc == 0) {
+                continue;
+            }
+            profile_site_t *m = _table_site(&merged, s->pc);
+            m->tb_execs += s->tb_execs;
+            m->tb_insns = s->tb_insns > m->tb_insns ? s->tb_insns : m->tb_insns;
+            m->mem_reads += s->mem_reads;
+            m->mem_writes += s->mem_writes;
+            m->change_points += s->change_points;
+        }
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < merged.cap; i++) {
+        if (merged.sites[i].pc != 0) {
+            merged.sites[n++] = merged.sites[i];
+        }
+    }
+    qsort(merged.sites, n, sizeof(profile_site_t), _site_cmp);
+    *len = n;
+    return merged.sites;
+}
+
+static FILE *
+_open_output(const char *suffix)
+{
+    char path[PATH_MAX];
+    sys_snprintf(path, sizeof(path), "%s.%s", _hist.prefix, suffix);
+    FILE *fp = sys_fopen(path, "w");
+    if (fp == NULL) {
+        logger_warnf("qemu-profile: could not write '%s'\n", path);
+    }
+    return fp;
+}
+
+void
+qemu_profile_hist_export(void)
+{
+    if (!_hist.enabled) {
+        return;
+    }
+
+    size_t len            = 0;
+    profile_site_t *sites = _merge(&len);
+
+    if (qemu_elf_foreach_symbol(_add_symbol, NULL)) {
+        qsort(_symbols.syms, _symbols.len, sizeof(profile_symbol_t),
+              _symbol_cmp);
+    }
+
+    FILE *csv    = _open_output("csv");
+    FILE *folded = _open_output("folded");
+    if (csv != NULL) {
+        sys_fprintf(csv, "pc,symbol,offset,tb_execs,tb_insns,mem_reads,"
+                         "mem_writes,change_points\n");
+    }
+    for (size_t i = 0; i < len; i++) {
+        const profile_site_t *s   = &sites[i];
+        const profile_symbol_t *f = _symbol_lookup(s->pc);
+        const char *name          = f != NULL ? f->name : "??";
+        uint64_t offset           = f != NULL ? s->pc - f->addr : 0;
+
+        if (csv != NULL) {
+            sys_fprintf(csv,
+                        "0x%" PRIx64 ",%s,0x%" PRIx64 ",%" PRIu64 ",%" PRIu64
+                        ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                        s->pc, name, offset, s->tb_execs, s->tb_insns,
+                        s->mem_reads, s->mem_writes, s->change_points);
+        }
+        /* guest instructions executed per block, for flame graphs */
+        if (folded != NULL && s->tb_execs > 0) {
+            sys_fprintf(folded, "%s;0x%" PRIx64 " %" PRIu64 "\n", name, s->pc,
+                        s->tb_execs * (s->tb_insns > 0 ? s->tb_insns : 1));
+        }
+    }
+    if (csv != NULL) {
+        sys_fclose(csv);
+    }
+    if (folded != NULL) {
+        sys_fclose(folded);
+    }
+
+    sys_fprintf(stderr, "qemu-profile: %zu sites written to %s.{csv,folded}\n",
+                len, _hist.prefix);
+    sys_free(sites);
+}
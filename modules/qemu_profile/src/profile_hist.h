@@ -0,0 +1,24 @@
+#ifndef LOTTO_MODULES_QEMU_PROFILE_HIST_H
+#define LOTTO_MODULES_QEMU_PROFILE_HIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Guest PC histograms, sharded per vCPU thread. Each shard is only written by
+ * its own thread; shards are merged and exported at fini. */
+
+/* Enables the histograms when LOTTO_QEMU_PROFILE_OUT names an output prefix. */
+bool qemu_profile_hist_init(void);
+bool qemu_profile_hist_enabled(void);
+
+void qemu_profile_hist_tb_translated(uint64_t pc, size_t insn_count);
+void qemu_profile_hist_tb_exec(uint64_t pc);
+void qemu_profile_hist_memaccess(uint64_t pc, bool is_store);
+void qemu_profile_hist_change_point(uint64_t pc);
+
+/* Writes `<prefix>.csv` and `<prefix>.folded`, resolving PCs against the
+ * guest ELF symbols. */
+void qemu_profile_hist_export(void);
+
+#endif
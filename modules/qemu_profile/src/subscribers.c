@@ -1,6 +1,7 @@
 #include "profile_emit.h"
 #include <dice/pubsub.h>
 #include <lotto/engine/pubsub.h>
+#include <lotto/engine/sequencer.h>
 #include <lotto/modules/qemu/events.h>
 #include <lotto/modules/yield/events.h>
 #include <lotto/runtime/events.h>
@@ -12,20 +13,53 @@ PS_SUBSCRIBE(CHAIN_QEMU_CONTROL, EVENT_QEMU_FINI, { qemu_profile_on_fini(); })
 
 PS_SUBSCRIBE(CHAIN_QEMU_CONTROL, EVENT_QEMU_TRANSLATE, {
     const qemu_translate_event_t *ev = data;
-    qemu_profile_on_translate(ev->insn_count);
+    qemu_profile_on_translate(ev->tb, ev->insn_count, ev->cache_hits);
 })
 
-PS_SUBSCRIBE(INTERCEPT_EVENT, EVENT_MA_READ,
-             { qemu_profile_on_memaccess(false); })
+static inline uint64_t
+memaccess_event_pc(type_id type, const void *event)
+{
+    switch (type) {
+        case EVENT_MA_READ:
+            return (uint64_t)(uintptr_t)((struct ma_read_event *)event)->pc;
+        case EVENT_MA_WRITE:
+            return (uint64_t)(uintptr_t)((struct ma_write_event *)event)->pc;
+        case EVENT_MA_AREAD:
+            return (uint64_t)(uintptr_t)((struct ma_aread_event *)event)->pc;
+        case EVENT_MA_AWRITE:
+            return (uint64_t)(uintptr_t)((struct ma_awrite_event *)event)->pc;
+        default:
+            ASSERT(0);
+            return 0;
+    }
+}
 
-PS_SUBSCRIBE(INTERCEPT_BEFORE, EVENT_MA_AREAD,
-             { qemu_profile_on_memaccess(false); })
+PS_SUBSCRIBE(INTERCEPT_EVENT, EVENT_MA_READ, {
+    qemu_profile_on_memaccess(memaccess_event_pc(type, event), false);
+})
+
+PS_SUBSCRIBE(INTERCEPT_BEFORE, EVENT_MA_AREAD, {
+    qemu_profile_on_memaccess(memaccess_event_pc(type, event), false);
+})
 
-PS_SUBSCRIBE(INTERCEPT_EVENT, EVENT_MA_WRITE,
-             { qemu_profile_on_memaccess(true); })
+PS_SUBSCRIBE(INTERCEPT_EVENT, EVENT_MA_WRITE, {
+    qemu_profile_on_memaccess(memaccess_event_pc(type, event), true);
+})
 
-PS_SUBSCRIBE(INTERCEPT_BEFORE, EVENT_MA_AWRITE,
-             { qemu_profile_on_memaccess(true); })
+PS_SUBSCRIBE(INTERCEPT_BEFORE, EVENT_MA_AWRITE, {
+    qemu_profile_on_memaccess(memaccess_event_pc(type, event), true);
+})
 
 PS_SUBSCRIBE(CHAIN_LOTTO_TRAP, EVENT_YIELD_USER,
              { qemu_profile_on_udf_yield(); })
+
+/* qemu_profile is registered after the strategy modules, so the decision is
+ * final by the time this handler runs. */
+static void
+_profile_capture(const capture_point *cp, sequencer_decision *e)
+{
+    if (e->is_chpt && !e->skip) {
+        qemu_profile_on_change_point(cp->pc);
+    }
+}
+ON_SEQUENCER_CAPTURE(_profile_capture)
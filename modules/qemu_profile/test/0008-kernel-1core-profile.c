@@ -1,7 +1,9 @@
 // clang-format off
 // REQUIRES: module-qemu
 // REQUIRES: module-qemu_profile
-// RUN: LOTTO_QEMU_PROFILE=1 %lotto %stress -Q -r 1 -- -smp 1 -kernel %builddir/modules/qemu/test/kernel/0008-kernel-1core-profile.elf 2>&1 | grep "qemu-profile: tb="
+// RUN: LOTTO_QEMU_PROFILE=1 %lotto %stress -Q -r 1 -- -smp 1 -kernel %builddir/modules/qemu/test/kernel/0008-kernel-1core-profile.elf 2>&1 | grep -E "qemu-profile: tb=.* insn-cache-hit="
+// RUN: LOTTO_QEMU_PROFILE=1 LOTTO_QEMU_PROFILE_OUT=%t %lotto %stress -Q -r 1 -- -smp 1 -kernel %builddir/modules/qemu/test/kernel/0008-kernel-1core-profile.elf 2>&1 | grep "qemu-profile: .* sites written"
+// RUN: head -1 %t.csv | grep "^pc,symbol,offset,tb_execs"
 // clang-format on
 
 #include "kernel/kernel.h"
@@ -0,0 +1,36 @@
+/**
+ * @file resident.h
+ * @brief Resident QEMU mode shared by the snap-stress driver and the plugin.
+ *
+ * In resident mode a single QEMU process runs a batch of snapshot rounds. At
+ * the end of each round the plugin reloads the snapshot in place and restarts
+ * the Lotto engine with the replay trace of the next round. Round 0 uses the
+ * LOTTO_RECORD and LOTTO_REPLAY traces set up by the driver; round `i > 0`
+ * replays and records the files returned by the path helpers below.
+ */
+#ifndef LOTTO_MODULES_QEMU_SNAPSHOT_RESIDENT_H
+#define LOTTO_MODULES_QEMU_SNAPSHOT_RESIDENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* directory holding the per-round traces */
+#define QEMU_RESIDENT_DIR_VAR "LOTTO_QEMU_RESIDENT_DIR"
+/* number of rounds of the batch */
+#define QEMU_RESIDENT_ROUNDS_VAR "LOTTO_QEMU_RESIDENT_ROUNDS"
+
+static inline void
+qemu_resident_replay_path(char *path, size_t len, const char *dir,
+                          uint64_t round)
+{
+    snprintf(path, len, "%s/resident-%lu.replay.trace", dir, round);
+}
+
+static inline void
+qemu_resident_record_path(char *path, size_t len, const char *dir,
+                          uint64_t round)
+{
+    snprintf(path, len, "%s/resident-%lu.trace", dir, round);
+}
+
+#endif
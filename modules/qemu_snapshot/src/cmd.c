@@ -8,6 +8,7 @@
 #include <lotto/driver/exec.h>
 #include <lotto/driver/flagmgr.h>
 #include <lotto/driver/flags/prng.h>
+#include <lotto/driver/jobs.h>
 #include <lotto/driver/record.h>
 #include <lotto/driver/subcmd.h>
 #include <lotto/driver/trace.h>
@@ -17,6 +18,7 @@
 #include <lotto/modules/qemu_snapshot/config.h>
 #include <lotto/modules/qemu_snapshot/events.h>
 #include <lotto/modules/qemu_snapshot/final.h>
+#include <lotto/modules/qemu_snapshot/resident.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/ensure.h>
 #include <lotto/sys/now.h>
@@ -31,6 +33,14 @@
 #define SNAPSHOT_RESUME_TRACE_BASENAME "from-snap.trace"
 #define SNAPSHOT_RESUME_DRIVE_BASENAME "from-snap.qcow2"
 
+/* rounds run by one resident QEMU process */
+#define SNAPSHOT_RESIDENT_BATCH 64
+
+DECLARE_COMMAND_FLAG(SNAP_RESIDENT, "", "resident", "",
+                     "keep QEMU running and reload the snapshot in place "
+                     "between rounds",
+                     flag_off())
+
 typedef struct snap_source {
     record_t *start;
     record_t *config;
@@ -403,7 +413,7 @@ _write_resume_trace(const char *source_trace, const char *path,
     statemgr_record_unmarshal(source->config);
     struct qemu_snapshot_config_state *snapshot_cfg =
         qemu_snapshot_config_state();
-    prng()->seed                   = (uint32_t)seed;
+    prng_reset(seed);
     snapshot_cfg->enabled          = true;
     snapshot_cfg->clk              = source->snapshot->clk + 1;
     snapshot_cfg->snapshot_valid   = true;
@@ -635,7 +645,7 @@ _backup_snapshot_artifacts(const char *trace_path,
     _snapshot_trace_path(snapshot_trace, temporary_directory);
     _snapshot_drive_path(snapshot_drive, temporary_directory);
 
-    if (cp(source.snapshot_drive, snapshot_drive) != 0) {
+    if (cp_clone(source.snapshot_drive, snapshot_drive) != 0) {
         sys_fprintf(
             stderr,
             "error: could not back up snapshot drive '%s' to '%s': %s\n",
@@ -691,7 +701,11 @@ _prepare_round(const snap_source_t *source, const char *temporary_directory,
         return 1;
     }
 
-    if (cp(source->snapshot_drive, snapshot_copy_path) != 0) {
+    /* The round drive is recycled: every round re-clones the immutable base
+     * over the same path, which costs O(1) on reflink-capable filesystems. An
+     * overlay with a backing file does not work here since -loadvm only sees
+     * internal snapshots of the top image. */
+    if (cp_clone(source->snapshot_drive, snapshot_copy_path) != 0) {
         sys_fprintf(
             stderr, "error: could not copy snapshot drive '%s' to '%s': %s\n",
             source->snapshot_drive, snapshot_copy_path, strerror(errno));
@@ -702,78 +716,210 @@ _prepare_round(const snap_source_t *source, const char *temporary_directory,
                                snapshot_copy_path, seed);
 }
 
-int
-snap_stress(args_t *args, flags_t *flags)
+/* Loaded once by snap_stress() and shared by all jobs. */
+static struct {
+    const char *input;
+    snap_source_t source;
+    args_t replay_args;
+} _snap;
+
+static int
+_snap_round(flags_t *flags, const char *temporary_directory,
+            const char *trace_path, const char *snapshot_copy_path,
+            uint64_t seed)
+{
+    flags_set_by_opt(flags, flag_seed(), uval(seed));
+
+    int err = _prepare_round(&_snap.source, temporary_directory, _snap.input,
+                             trace_path, snapshot_copy_path, seed);
+    if (err != 0) {
+        return err;
+    }
+
+    args_t run_args = _args_dup(&_snap.replay_args);
+    err = _args_enable_snapshot(&run_args, _snap.source.snapshot_name,
+                                snapshot_copy_path);
+    if (err != 0) {
+        _args_free(&run_args);
+        return err;
+    }
+
+    err = run_once(&run_args, flags);
+    _args_free(&run_args);
+
+    int rewrite_err = _rewrite_output_trace_with_snapshot_prefix(
+        flags_get_sval(flags, flag_output()), trace_path, _snap.source.snapshot,
+        _snap.source.snapshot_name);
+    return rewrite_err != 0 ? rewrite_err : err;
+}
+
+/* Writes what cli_trace_init() would hand to the runtime for a round, using
+ * the config state left by _write_resume_trace(). */
+static int
+_write_replay_trace(const char *resume_trace, const char *path,
+                    const args_t *run_args, const flags_t *flags)
+{
+    cli_trace_copy(resume_trace, path);
+    trace_t *trace = cli_trace_load(path);
+    if (trace == NULL) {
+        sys_fprintf(stderr, "error: could not load temporary trace '%s'\n",
+                    path);
+        return 1;
+    }
+    trace_clear(trace);
+
+    flags_publish(flags);
+    if (TRACE_OK != trace_append(trace, record_start(run_args)) ||
+        TRACE_OK != trace_append(trace, record_config(0))) {
+        sys_fprintf(stderr, "error: could not write replay trace '%s'\n",
+                    path);
+        trace_destroy(trace);
+        return 1;
+    }
+
+    cli_trace_save(trace, path);
+    trace_destroy(trace);
+    return 0;
+}
+
+/* Runs `n` rounds in one QEMU process. Round 0 is set up as a regular round;
+ * the plugin reloads the snapshot in place and moves on to the replay trace of
+ * the next round. Reports the number of rounds that ran in `done`; the output
+ * trace is the one of the last of them. */
+static int
+_snap_resident_batch(flags_t *flags, const char *temporary_directory,
+                     const char *trace_path, const char *snapshot_copy_path,
+                     uint64_t first, const uint64_t *seeds, uint64_t n,
+                     uint64_t *done)
+{
+    char path[PATH_MAX];
+    char rounds[32];
+    int err = 0;
+
+    *done = 0;
+    if (!_ensure_directory(temporary_directory)) {
+        sys_fprintf(stderr,
+                    "error: could not create temporary directory '%s'\n",
+                    temporary_directory);
+        return 1;
+    }
+
+    args_t run_args = _args_dup(&_snap.replay_args);
+    err = _args_enable_snapshot(&run_args, _snap.source.snapshot_name,
+                                snapshot_copy_path);
+
+    for (uint64_t i = 1; err == 0 && i < n; i++) {
+        flags_set_by_opt(flags, flag_seed(), uval(seeds[i]));
+        err = _write_resume_trace(_snap.input, trace_path, &_snap.source,
+                                  snapshot_copy_path, seeds[i]);
+        if (err == 0) {
+            qemu_resident_replay_path(path, sizeof(path), temporary_directory,
+                                      i);
+            err = _write_replay_trace(trace_path, path, &run_args, flags);
+        }
+        qemu_resident_record_path(path, sizeof(path), temporary_directory, i);
+        (void)unlink(path);
+    }
+    if (err == 0) {
+        flags_set_by_opt(flags, flag_seed(), uval(seeds[0]));
+        err = _prepare_round(&_snap.source, temporary_directory, _snap.input,
+                             trace_path, snapshot_copy_path, seeds[0]);
+    }
+    if (err != 0) {
+        _args_free(&run_args);
+        return err;
+    }
+
+    sys_snprintf(rounds, sizeof(rounds), "%lu", n);
+    sys_setenv(QEMU_RESIDENT_DIR_VAR, temporary_directory, true);
+    sys_setenv(QEMU_RESIDENT_ROUNDS_VAR, rounds, true);
+    err = run_once(&run_args, flags);
+    sys_unsetenv(QEMU_RESIDENT_ROUNDS_VAR);
+    sys_unsetenv(QEMU_RESIDENT_DIR_VAR);
+    _args_free(&run_args);
+
+    /* later rounds only exist if the earlier ones rolled over */
+    uint64_t last = 0;
+    for (uint64_t i = 1; i < n; i++) {
+        qemu_resident_record_path(path, sizeof(path), temporary_directory, i);
+        if (access(path, R_OK) == 0) {
+            last = i;
+        }
+    }
+    for (uint64_t i = 0; i <= last; i++) {
+        round_print(flags, first + i);
+    }
+    *done = last + 1;
+
+    const char *output = flags_get_sval(flags, flag_output());
+    if (last > 0) {
+        qemu_resident_record_path(path, sizeof(path), temporary_directory,
+                                  last);
+        if (rename(path, output) != 0 && cp_clone(path, output) != 0) {
+            sys_fprintf(stderr, "error: could not move '%s' to '%s': %s\n",
+                        path, output, strerror(errno));
+            return err != 0 ? err : 1;
+        }
+        int resume_err = _write_resume_trace(_snap.input, trace_path,
+                                             &_snap.source, snapshot_copy_path,
+                                             seeds[last]);
+        if (resume_err != 0) {
+            return resume_err;
+        }
+    }
+
+    int rewrite_err = _rewrite_output_trace_with_snapshot_prefix(
+        output, trace_path, _snap.source.snapshot, _snap.source.snapshot_name);
+    return rewrite_err != 0 ? rewrite_err : err;
+}
+
+static int
+_snap_stress_loop(args_t *args, flags_t *flags, uint64_t job)
 {
     (void)args;
+    (void)job;
 
     const char *temporary_directory =
         flags_get_sval(flags, flag_temporary_directory());
-    char snapshot_trace_path[PATH_MAX];
     char trace_path[PATH_MAX];
     char snapshot_copy_path[PATH_MAX];
-    _snapshot_trace_path(snapshot_trace_path, temporary_directory);
     sys_sprintf(trace_path, "%s/%s", temporary_directory,
                 SNAPSHOT_RESUME_TRACE_BASENAME);
     sys_sprintf(snapshot_copy_path, "%s/%s", temporary_directory,
                 SNAPSHOT_RESUME_DRIVE_BASENAME);
 
-    const char *input = flags_get_sval(flags, flag_input());
-    if (input == NULL || input[0] == '\0' ||
-        flags_get(flags, flag_input()).is_default) {
-        input = snapshot_trace_path;
-    }
-
-    snap_source_t source = {0};
-    args_t replay_args   = {0};
-    int err              = _load_source(input, &source, &replay_args);
-    if (err != 0) {
-        _free_source(&source);
-        _args_free(&replay_args);
-        return err;
-    }
-
-    execute_resolve_replay_args(&replay_args, flags);
-
     flags_set_by_opt(flags, flag_input(), sval(trace_path));
 
     struct flag_val seed = flags_get(flags, flag_seed());
     uint64_t rounds      = flags_get_uval(flags, flag_rounds());
-
-    for (uint64_t i = 0; i < rounds; i++) {
-        round_print(flags, i);
-
-        uint64_t round_seed =
-            seed.is_default ? (uint64_t)now() : as_uval(seed._val);
-        flags_set_by_opt(flags, flag_seed(), uval(round_seed));
-
-        err = _prepare_round(&source, temporary_directory, input, trace_path,
-                             snapshot_copy_path, round_seed);
-        if (err != 0) {
-            break;
+    bool resident        = flags_is_on(flags, FLAG_SNAP_RESIDENT);
+    uint64_t seeds[SNAPSHOT_RESIDENT_BATCH];
+    int err = 0;
+
+    for (uint64_t i = 0; i < rounds;) {
+        uint64_t n    = resident ? rounds - i : 1;
+        uint64_t done = 0;
+        if (n > SNAPSHOT_RESIDENT_BATCH) {
+            n = SNAPSHOT_RESIDENT_BATCH;
         }
-
-        args_t run_args = _args_dup(&replay_args);
-        err             = _args_enable_snapshot(&run_args, source.snapshot_name,
-                                                snapshot_copy_path);
-        if (err != 0) {
-            _args_free(&run_args);
-            break;
+        for (uint64_t j = 0; j < n; j++) {
+            seeds[j] = seed.is_default ? (uint64_t)now() :
+                                         as_uval(seed._val) + j;
         }
 
-        err = run_once(&run_args, flags);
-        _args_free(&run_args);
-
-        int rewrite_err = _rewrite_output_trace_with_snapshot_prefix(
-            flags_get_sval(flags, flag_output()), trace_path, source.snapshot,
-            source.snapshot_name);
-        if (rewrite_err != 0) {
-            err = rewrite_err;
-            break;
+        if (n == 1) {
+            round_print(flags, i);
+            err  = _snap_round(flags, temporary_directory, trace_path,
+                               snapshot_copy_path, seeds[0]);
+            done = 1;
+        } else {
+            err = _snap_resident_batch(flags, temporary_directory, trace_path,
+                                       snapshot_copy_path, i, seeds, n, &done);
         }
         if (err != 0) {
             break;
         }
+        i += done;
 
         if (rounds > 1) {
             adjust(flags_get_sval(flags, flag_output()));
@@ -782,12 +928,43 @@ snap_stress(args_t *args, flags_t *flags)
         if (seed.is_default) {
             seed._val = uval((uint64_t)now());
         } else {
-            seed._val = uval(as_uval(seed._val) + 1);
+            seed._val = uval(as_uval(seed._val) + done);
         }
         flags_set_by_opt(flags, flag_seed(), seed._val);
     }
 
-    _free_source(&source);
+    return err;
+}
+
+int
+snap_stress(args_t *args, flags_t *flags)
+{
+    const char *temporary_directory =
+        flags_get_sval(flags, flag_temporary_directory());
+    char snapshot_trace_path[PATH_MAX];
+    _snapshot_trace_path(snapshot_trace_path, temporary_directory);
+
+    /* resolve the input before jobs move to their own directories */
+    const char *input = flags_get_sval(flags, flag_input());
+    if (input == NULL || input[0] == '\0' ||
+        flags_get(flags, flag_input()).is_default) {
+        input = snapshot_trace_path;
+    }
+
+    _snap.input = input;
+    int err     = _load_source(input, &_snap.source, &_snap.replay_args);
+    if (err != 0) {
+        _free_source(&_snap.source);
+        _args_free(&_snap.replay_args);
+        return err;
+    }
+
+    execute_resolve_replay_args(&_snap.replay_args, flags);
+
+    err = run_jobs(args, flags, _snap_stress_loop);
+
+    _free_source(&_snap.source);
+    _args_free(&_snap.replay_args);
     return err;
 }
 
@@ -797,11 +974,15 @@ ON_DRIVER_REGISTER_COMMANDS({
                     flag_output(),
                     flag_verbose(),
                     flag_rounds(),
+                    flag_jobs(),
+                    flag_seed(),
+                    FLAG_SNAP_RESIDENT,
                     flag_temporary_directory(),
                     flag_no_preload(),
                     flag_before_run(),
                     flag_after_run(),
                     flag_logger_file(),
+                    flag_logger_binary(),
                     0};
     subcmd_register(
         snap_stress, "snap-stress", "",
@@ -0,0 +1,96 @@
+#include <limits.h>
+#include <qemu-plugin.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <lotto/base/reason.h>
+#include <lotto/modules/qemu/events.h>
+#include <lotto/modules/qemu_snapshot/config.h>
+#include <lotto/modules/qemu_snapshot/resident.h>
+#include <lotto/runtime/runtime.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/string.h>
+
+static struct {
+    const char *dir;
+    uint64_t rounds;
+    uint64_t round;
+    char snapshot_name[QEMU_SNAPSHOT_NAME_MAX];
+} _resident;
+
+/* Runs on the task that ends the round. Failing rounds terminate QEMU, so the
+ * driver finds their trace as the last one of the batch. */
+static bool
+_rollover(reason_t reason, int err)
+{
+    const struct qemu_snapshot_config_state *cfg =
+        qemu_snapshot_config_state();
+
+    if (err != 0 || !IS_REASON_SHUTDOWN(reason)) {
+        return false;
+    }
+    if (_resident.round + 1 >= _resident.rounds) {
+        return false;
+    }
+    if (!cfg->snapshot_valid || cfg->snapshot_name[0] == '\0') {
+        return false;
+    }
+
+    /* the name must outlive the config state, which is reset on resume */
+    sys_strcpy(_resident.snapshot_name, cfg->snapshot_name);
+    if (!qemu_plugin_delayed_load_snapshot(_resident.snapshot_name)) {
+        logger_warnf("resident: could not request reload of snapshot '%s'\n",
+                     _resident.snapshot_name);
+        return false;
+    }
+    return true;
+}
+
+/* Runs in the QEMU main loop with all vCPUs stopped. */
+static void
+_snapshot_loaded_cb(qemu_plugin_id_t id, bool success)
+{
+    (void)id;
+    char path[PATH_MAX];
+
+    if (!lotto_dormant()) {
+        return;
+    }
+    if (!success) {
+        logger_errorf("resident: could not reload snapshot '%s'\n",
+                      _resident.snapshot_name);
+        _exit(1);
+    }
+
+    _resident.round++;
+    qemu_resident_replay_path(path, sizeof(path), _resident.dir,
+                              _resident.round);
+    setenv("LOTTO_REPLAY", path, true);
+    qemu_resident_record_path(path, sizeof(path), _resident.dir,
+                              _resident.round);
+    setenv("LOTTO_RECORD", path, true);
+
+    lotto_rollover_resume();
+}
+
+void
+qemu_snapshot_resident_init(const qemu_control_event_t *ev)
+{
+    const char *dir    = getenv(QEMU_RESIDENT_DIR_VAR);
+    const char *rounds = getenv(QEMU_RESIDENT_ROUNDS_VAR);
+
+    if (dir == NULL || dir[0] == '\0' || rounds == NULL) {
+        return;
+    }
+
+    _resident.dir    = dir;
+    _resident.rounds = strtoull(rounds, NULL, 10);
+    _resident.round  = 0;
+    if (_resident.rounds <= 1) {
+        return;
+    }
+
+    qemu_plugin_register_snapshot_loaded_cb((qemu_plugin_id_t)ev->plugin_id,
+                                            _snapshot_loaded_cb);
+    lotto_rollover_register(_rollover);
+}
@@ -95,11 +95,14 @@ qemu_snapshot_trap(const capture_point *trap_cp, metadata_t *md)
     qemu_snapshot();
 }
 
+void qemu_snapshot_resident_init(const qemu_control_event_t *ev);
+
 void
 qemu_snapshot_plugin_init(const qemu_control_event_t *ev)
 {
     qemu_plugin_register_snapshot_done_cb((qemu_plugin_id_t)ev->plugin_id,
                                           qemu_snapshot_done_cb);
+    qemu_snapshot_resident_init(ev);
 }
 
 void
@@ -0,0 +1,18 @@
+// clang-format off
+// REQUIRES: module-qemu
+// REQUIRES: module-qemu_snapshot
+// RUN: %lotto %stress -Q -s pos -r 1 -- -smp 2 -kernel %builddir/modules/qemu_snapshot/test/kernel/0001-kernel-2core-snapshot-race.elf
+// RUN: %lotto snap-stress %tmpdir --resident --seed 42 -r 3 -o %t.resident.trace | %check %s
+// RUN: %lotto snap-stress %tmpdir --seed 44 -r 1 -o %t.fresh.trace
+// RUN: %lotto show %tmpdir -i %t.resident.trace 2>&1 | grep -E '^  (clock|task|type):' > %t.resident.txt
+// RUN: %lotto show %tmpdir -i %t.fresh.trace 2>&1 | grep -E '^  (clock|task|type):' > %t.fresh.txt
+// RUN: test -s %t.fresh.txt && diff %t.resident.txt %t.fresh.txt
+// CHECK: kernel: all cores done
+// CHECK: kernel: all cores done
+// CHECK: kernel: all cores done
+// clang-format on
+
+/* The last round of a resident batch, which reuses the QEMU process and the
+ * Lotto runtime of the previous rounds, schedules the vCPUs exactly as a fresh
+ * process started with the same seed. The kernel is the one of
+ * 0001-kernel-2core-snapshot-race.c. */
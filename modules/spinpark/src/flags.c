@@ -0,0 +1,16 @@
+#include "state.h"
+#include <lotto/base/flags.h>
+#include <lotto/driver/flagmgr.h>
+#include <lotto/driver/flags/modules.h>
+
+REGISTER_RUNTIME_SWITCHABLE_CONFIG(spinpark_config(), false)
+
+NEW_CALLBACK_FLAG(SPINPARK_THRESHOLD, "", LOTTO_MODULE_FLAG("threshold"), "",
+                  "reads of the same address without a write before the task "
+                  "is parked, 0 for never",
+                  flag_uval(SPINPARK_DEFAULT_THRESHOLD),
+                  { spinpark_config()->threshold = as_uval(v); })
+NEW_CALLBACK_FLAG(SPINPARK_TIMEOUT, "", LOTTO_MODULE_FLAG("timeout"), "NSEC",
+                  "virtual time after which a parked task wakes up anyway",
+                  flag_uval(SPINPARK_DEFAULT_TIMEOUT),
+                  { spinpark_config()->timeout = as_uval(v); })
@@ -0,0 +1,191 @@
+#include "state.h"
+#include <dice/events/memaccess.h>
+#include <lotto/base/tidmap.h>
+#include <lotto/base/tidset.h>
+#include <lotto/engine/pubsub.h>
+#include <lotto/engine/sequencer.h>
+#include <lotto/engine/statemgr.h>
+#include <lotto/modules/clock.h>
+#include <lotto/modules/timeout/timeout.h>
+#include <lotto/runtime/events.h>
+#include <lotto/sys/assert.h>
+#include <lotto/util/macros.h>
+
+/*******************************************************************************
+ * @file handler.c
+ *
+ * A task reading the same address over and over, without writing in between,
+ * is spinning on it. Once it reaches the threshold, the task is parked: it
+ * leaves the set of schedulable tasks until another task writes to the address
+ * or its timeout fires. Parked tasks are woken up as well when nothing else
+ * could run.
+ ******************************************************************************/
+
+typedef struct {
+    tiditem_t t;
+    uintptr_t addr;
+    size_t size;
+    uint64_t reads;
+    bool parked;
+} spinner_t;
+
+static tidmap_t _state;
+
+static void
+_spinpark_reset(void)
+{
+    const tiditem_t *i = NULL;
+    while ((i = tidmap_iterate(&_state)) != NULL)
+        tidmap_deregister(&_state, i->key);
+
+    tidmap_init(&_state, MARSHABLE_STATIC(sizeof(spinner_t)));
+}
+REGISTER_EPHEMERAL(_state, { _spinpark_reset(); })
+
+LOTTO_SUBSCRIBE(EVENT_TIMEOUT_TRIGGER, {
+    spinner_t *s = (spinner_t *)tidmap_find(&_state, as_uval(v));
+    if (s != NULL && s->parked) {
+        s->parked = false;
+        s->reads  = 0;
+    }
+    return PS_OK;
+})
+
+static bool
+_is_write(type_id type)
+{
+    switch (type) {
+        case EVENT_MA_WRITE:
+        case EVENT_MA_AWRITE:
+        case EVENT_MA_RMW:
+        case EVENT_MA_XCHG:
+        case EVENT_MA_CMPXCHG:
+        case EVENT_MA_CMPXCHG_WEAK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool
+_is_parked(task_id id)
+{
+    spinner_t *s = (spinner_t *)tidmap_find(&_state, id);
+    return s != NULL && s->parked;
+}
+
+static void
+_unpark(spinner_t *s)
+{
+    s->reads = 0;
+    if (s->parked) {
+        s->parked = false;
+        handler_timeout_deregister(s->t.key);
+    }
+}
+
+static void
+_park(const capture_point *cp, event_t *e, spinner_t *s)
+{
+    struct timespec deadline;
+    lotto_clock_time(&deadline);
+    uint64_t deadline_ns = (uint64_t)deadline.tv_nsec +
+                           spinpark_config()->timeout;
+    deadline.tv_sec += (long)(deadline_ns / NSEC_IN_SEC);
+    deadline.tv_nsec = (long)(deadline_ns % NSEC_IN_SEC);
+    handler_timeout_register(cp->id, &deadline);
+
+    s->reads  = 0;
+    s->parked = true;
+    if (!e->is_chpt) {
+        e->reason  = REASON_SYS_YIELD;
+        e->is_chpt = true;
+    }
+}
+
+/* Wakes up the tasks spinning on a range overlapping the written one. */
+static void
+_wake(task_id writer, uintptr_t addr, size_t size)
+{
+    for (const tiditem_t *cur = tidmap_iterate(&_state); cur;
+         cur = tidmap_next(cur)) {
+        spinner_t *s = (spinner_t *)cur;
+        if (cur->key != writer && (s->reads > 0 || s->parked) &&
+            addr < s->addr + s->size && s->addr < addr + size) {
+            _unpark(s);
+        }
+    }
+}
+
+/* Removes parked tasks from the schedulable ones, unless none would remain. */
+static void
+_remove_parked(tidset_t *tset)
+{
+    bool runnable = false;
+    for (size_t i = 0; i < tidset_size(tset) && !runnable; i++) {
+        runnable = !_is_parked(tidset_get(tset, i));
+    }
+    for (const tiditem_t *cur = tidmap_iterate(&_state); cur;
+         cur = tidmap_next(cur)) {
+        spinner_t *s = (spinner_t *)cur;
+        if (!s->parked) {
+            continue;
+        }
+        if (runnable) {
+            tidset_remove(tset, cur->key);
+        } else {
+            _unpark(s);
+        }
+    }
+}
+
+/*******************************************************************************
+ * handler function
+ ******************************************************************************/
+STATIC void
+_spinpark_handle(const capture_point *cp, event_t *e)
+{
+    ASSERT(e);
+    if (e->skip || !spinpark_config()->enabled)
+        return;
+
+    ASSERT(cp);
+    ASSERT(cp->id != NO_TASK);
+
+    // a parked task may still run if the schedule is forced, e.g., on replay
+    spinner_t *s =
+        (spinner_t *)tidmap_find_or_register(&_state, cp->id, NULL);
+    if (s->parked) {
+        _unpark(s);
+    }
+
+    if (has_memaccess_addr(cp)) {
+        uintptr_t addr = memaccess_addr(cp);
+        size_t size    = memaccess_size(cp);
+        if (_is_write(cp->type_id)) {
+            // atomic writes wake up spinners once done, plain ones have no
+            // after event
+            if (cp->chain_id == CHAIN_INGRESS_AFTER ||
+                cp->type_id == EVENT_MA_WRITE) {
+                _wake(cp->id, addr, size);
+            }
+            s->reads = 0;
+        } else if (cp->chain_id != CHAIN_INGRESS_AFTER) {
+            if (s->reads > 0 && s->addr == addr && s->size == size) {
+                s->reads++;
+            } else {
+                s->addr  = addr;
+                s->size  = size;
+                s->reads = 1;
+            }
+            uint64_t threshold = spinpark_config()->threshold;
+            if (threshold > 0 && s->reads >= threshold && !e->readonly &&
+                e->next == NO_TASK) {
+                _park(cp, e, s);
+            }
+        }
+    }
+
+    _remove_parked(&e->tset);
+}
+ON_SEQUENCER_CAPTURE(_spinpark_handle)
@@ -0,0 +1,20 @@
+#include "state.h"
+#include <lotto/engine/statemgr.h>
+#include <lotto/sys/logger.h>
+
+static spinpark_config_t _config = {
+    .threshold = SPINPARK_DEFAULT_THRESHOLD,
+    .timeout   = SPINPARK_DEFAULT_TIMEOUT,
+};
+
+REGISTER_CONFIG(_config, {
+    logger_infof("enabled   = %s\n", _config.enabled ? "on" : "off");
+    logger_infof("threshold = %lu\n", _config.threshold);
+    logger_infof("timeout   = %lu\n", _config.timeout);
+})
+
+spinpark_config_t *
+spinpark_config(void)
+{
+    return &_config;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file state.h
+ * @brief Spinpark module state declarations.
+ */
+#ifndef LOTTO_STATE_SPINPARK_H
+#define LOTTO_STATE_SPINPARK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lotto/base/marshable.h>
+
+#define SPINPARK_DEFAULT_THRESHOLD 8
+#define SPINPARK_DEFAULT_TIMEOUT   1000000
+
+typedef struct spinpark_config {
+    marshable_t m;
+    bool enabled;
+    uint64_t threshold;
+    uint64_t timeout;
+} spinpark_config_t;
+
+spinpark_config_t *spinpark_config(void);
+
+#endif
@@ -0,0 +1,48 @@
+// clang-format off
+// RUN: %lotto %stress -r 20 -e spinpark --spinpark-timeout 1000000000000 -- %b
+// RUN: (! %lotto %stress -r 20 -- %b 2>&1) | %check %s
+// CHECK: assert failed {{.*}}/spinpark_budget.c:{{[0-9]+}}: spins <= 64
+// clang-format on
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+atomic_int flag;
+atomic_int noise;
+
+/* The writer takes many steps before setting flag. Without parking, the
+ * reader keeps spinning meanwhile; once parked, it only runs again when flag
+ * is written. */
+void *
+writer(void *arg)
+{
+    for (int i = 0; i < 1000; i++) {
+        atomic_store(&noise, i);
+    }
+    atomic_store(&flag, 1);
+    return arg;
+}
+
+void *
+reader(void *arg)
+{
+    int spins = 0;
+    while (!atomic_load(&flag)) {
+        spins++;
+    }
+    assert(spins <= 64);
+    return arg;
+}
+
+int
+main()
+{
+    pthread_t t1, t2;
+    pthread_create(&t1, 0, reader, 0);
+    pthread_create(&t2, 0, writer, 0);
+
+    pthread_join(t1, 0);
+    pthread_join(t2, 0);
+    return 0;
+}
@@ -0,0 +1,42 @@
+// clang-format off
+// RUN: (! %lotto %stress -r 200 -e spinpark -- %b 2>&1) | %check %s
+// RUN: (! %lotto %replay 2>&1) | %check %s
+// CHECK: assert failed {{.*}}/spinpark_mp.c:{{[0-9]+}}: atomic_load(&data) == 42
+// clang-format on
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+atomic_int flag;
+atomic_int data;
+
+/* The reader is parked while spinning on flag and woken up by the store, so
+ * it can still run between the two stores of the writer. */
+void *
+writer(void *arg)
+{
+    atomic_store(&flag, 1);
+    atomic_store(&data, 42);
+    return arg;
+}
+
+void *
+reader(void *arg)
+{
+    while (!atomic_load(&flag)) {}
+    assert(atomic_load(&data) == 42);
+    return arg;
+}
+
+int
+main()
+{
+    pthread_t t1, t2;
+    pthread_create(&t1, 0, reader, 0);
+    pthread_create(&t2, 0, writer, 0);
+
+    pthread_join(t1, 0);
+    pthread_join(t2, 0);
+    return 0;
+}
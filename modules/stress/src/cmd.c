@@ -1,25 +1,97 @@
 /*******************************************************************************
  * stress
  ******************************************************************************/
+#include "portfolio.h"
 #include <lotto/driver/flagmgr.h>
 #include <lotto/driver/flags/prng.h>
+#include <lotto/driver/jobs.h>
 #include <lotto/driver/subcmd.h>
 #include <lotto/driver/utils.h>
+#include <lotto/modules/coverage/coverage.h>
 #include <lotto/sys/now.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
 #include <lotto/engine/pubsub.h>
 
-int
-stress(args_t *args, flags_t *flags)
+DECLARE_COMMAND_FLAG(STRESS_COVERAGE, "", "stress-coverage", "",
+                     "keep rounds reaching new interleavings and mutate them",
+                     flag_off())
+
+DECLARE_COMMAND_FLAG(STRESS_PORTFOLIO, "", "stress-portfolio", "ARMS",
+                     "allocate rounds among ';'-separated sets of runtime "
+                     "flags, or the default portfolio with 'default'",
+                     flag_sval(""))
+
+/* Runs a round, replaying `mutant` if not NULL, and counts the coverage
+ * entries that reached a new bucket in `found`. */
+static int
+_coverage_round(args_t *args, flags_t *flags, coverage_t *cov,
+                const char *mutant, uint64_t *found)
+{
+    if (mutant != NULL) {
+        sys_setenv("LOTTO_REPLAY", mutant, true);
+    }
+    coverage_round_begin(cov);
+    int err = run_once(args, flags);
+    if (mutant != NULL) {
+        sys_unsetenv("LOTTO_REPLAY");
+    }
+    *found = coverage_round_end(cov, flags_get_sval(flags, flag_output()));
+    return err;
+}
+
+static int
+_stress_loop(args_t *args, flags_t *flags, uint64_t job)
 {
+    (void)job;
     struct flag_val seed = flags_get(flags, flag_seed());
     uint64_t rounds      = flags_get_uval(flags, flag_rounds());
+    const char *spec     = flags_get_sval(flags, FLAG_STRESS_PORTFOLIO);
+    bool mutate          = flags_is_on(flags, FLAG_STRESS_COVERAGE);
+    uint64_t stream      = flags_get_uval(flags, flag_prng_stream());
+
+    // the portfolio is rewarded with coverage, so it needs the map as well
+    portfolio_t *pf = NULL;
+    if (spec[0] != '\0' && (pf = portfolio_init(spec, flags)) == NULL) {
+        return 1;
+    }
+    coverage_t *cov = NULL;
+    if (mutate || pf != NULL) {
+        cov = coverage_init(flags_get_sval(flags, flag_temporary_directory()));
+    }
+    flags_t *arm_flags = pf ? flagmgr_flags_alloc() : NULL;
 
+    int err = 0;
     for (uint64_t i = 0; i < rounds; i++) {
-        round_print(flags, i);
+        // once the corpus is not empty, every other round replays a mutant of
+        // one of its traces instead of starting from scratch; a mutant keeps
+        // the flags of its trace, so it does not count for any arm
+        const char *mutant = NULL;
+        if (mutate && (i & 1)) {
+            mutant = coverage_mutate(cov, as_uval(seed._val), stream);
+        }
+        flags_t *round_flags = flags;
+        uint64_t arm         = 0;
+        if (pf != NULL && mutant == NULL) {
+            arm = portfolio_select(pf);
+            portfolio_apply(pf, arm, flags, arm_flags);
+            round_flags = arm_flags;
+        }
+
+        round_print(round_flags, i);
+        if (round_flags == arm_flags) {
+            sys_fprintf(stdout, "[lotto] portfolio arm: %s\n",
+                        portfolio_arm_str(pf, arm));
+        }
 
-        int err = run_once(args, flags);
+        uint64_t found = 0;
+        err = cov ? _coverage_round(args, round_flags, cov, mutant, &found) :
+                    run_once(args, round_flags);
+        if (round_flags == arm_flags) {
+            portfolio_update(pf, arm, err != 0 || found > 0);
+        }
         if (err) {
-            return err;
+            break;
         }
 
         if (rounds > 1) {
@@ -35,7 +107,24 @@ stress(args_t *args, flags_t *flags)
         flags_set_by_opt(flags, flag_seed(), seed._val);
     }
 
-    return 0;
+    if (pf != NULL) {
+        portfolio_print(pf);
+        portfolio_fini(pf);
+        flags_free(arm_flags);
+    }
+    if (cov != NULL) {
+        sys_fprintf(stdout,
+                    "[lotto] coverage: %lu entries, %lu traces in corpus\n",
+                    coverage_entries(cov), coverage_corpus_size(cov));
+        coverage_fini(cov);
+    }
+    return err;
+}
+
+int
+stress(args_t *args, flags_t *flags)
+{
+    return run_jobs(args, flags, _stress_loop);
 }
 
 ON_DRIVER_REGISTER_COMMANDS({
@@ -43,11 +132,15 @@ ON_DRIVER_REGISTER_COMMANDS({
                     flag_input(),
                     flag_verbose(),
                     flag_rounds(),
+                    flag_jobs(),
+                    FLAG_STRESS_COVERAGE,
+                    FLAG_STRESS_PORTFOLIO,
                     flag_temporary_directory(),
                     flag_no_preload(),
                     flag_before_run(),
                     flag_after_run(),
                     flag_logger_file(),
+                    flag_logger_binary(),
                     0};
     subcmd_register(stress, "stress", "[--] <command line>",
                     "Run a program repeatedly to find an execution of interest",
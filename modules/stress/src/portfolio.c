@@ -0,0 +1,181 @@
+#include <math.h>
+#include <string.h>
+
+#include "portfolio.h"
+#include <lotto/driver/args.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+
+#define ARM_LEN      256
+#define ARM_MAX_ARGS 32
+
+typedef struct portfolio_arm {
+    char spec[ARM_LEN];
+    char tokens[ARM_LEN]; /* spec split into NUL-terminated arguments */
+    int argc;
+    uint64_t rounds;
+    uint64_t rewards;
+} portfolio_arm_t;
+
+struct portfolio {
+    portfolio_arm_t arms[PORTFOLIO_MAX_ARMS];
+    uint64_t narms;
+    uint64_t rounds;
+};
+
+static bool
+_arm_parse(const portfolio_arm_t *arm, flags_t *dst)
+{
+    // getopt permutes the vector, so every parse gets a fresh one
+    char *argv[ARM_MAX_ARGS + 2] = {"portfolio"};
+    const char *tok              = arm->tokens;
+    for (int i = 1; i <= arm->argc; i++) {
+        argv[i] = (char *)tok;
+        tok += sys_strlen(tok) + 1;
+    }
+    args_t args          = ARGS(arm->argc + 1, argv);
+    flag_t sel[MAX_FLAGS] = {0};
+    return flags_parse(dst, &args, true, sel) == FLAGS_PARSE_OK &&
+           args.argc == 0;
+}
+
+static bool
+_arm_init(portfolio_arm_t *arm, const char *spec, size_t len)
+{
+    if (len >= ARM_LEN) {
+        sys_fprintf(stderr, "error: portfolio arm too long: %.*s\n", (int)len,
+                    spec);
+        return false;
+    }
+    sys_memcpy(arm->spec, spec, len);
+    arm->spec[len] = '\0';
+
+    char *out = arm->tokens;
+    for (const char *p = arm->spec; *p != '\0';) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (arm->argc == ARM_MAX_ARGS) {
+            sys_fprintf(stderr, "error: too many flags in portfolio arm: %s\n",
+                        arm->spec);
+            return false;
+        }
+        while (*p != '\0' && *p != ' ' && *p != '\t') {
+            *out++ = *p++;
+        }
+        *out++ = '\0';
+        arm->argc++;
+    }
+    return true;
+}
+
+portfolio_t *
+portfolio_init(const char *spec, const flags_t *flags)
+{
+    if (sys_strcmp(spec, "default") == 0) {
+        spec = PORTFOLIO_DEFAULT;
+    }
+    portfolio_t *pf = sys_calloc(1, sizeof(portfolio_t));
+    ASSERT(pf);
+
+    flags_t *scratch = flagmgr_flags_alloc();
+    for (const char *p = spec; *p != '\0';) {
+        const char *end = strchr(p, ';');
+        size_t len      = end ? (size_t)(end - p) : sys_strlen(p);
+        if (len > 0) {
+            if (pf->narms == PORTFOLIO_MAX_ARMS) {
+                sys_fprintf(stderr, "error: more than %u portfolio arms\n",
+                            PORTFOLIO_MAX_ARMS);
+                goto fail;
+            }
+            portfolio_arm_t *arm = &pf->arms[pf->narms++];
+            flags_cpy(scratch, flags);
+            if (!_arm_init(arm, p, len) || !_arm_parse(arm, scratch)) {
+                sys_fprintf(stderr, "error: invalid portfolio arm: %s\n",
+                            arm->spec);
+                goto fail;
+            }
+        }
+        p += end ? len + 1 : len;
+    }
+    if (pf->narms == 0) {
+        sys_fprintf(stderr, "error: empty portfolio\n");
+        goto fail;
+    }
+    flags_free(scratch);
+    return pf;
+
+fail:
+    flags_free(scratch);
+    sys_free(pf);
+    return NULL;
+}
+
+void
+portfolio_fini(portfolio_t *pf)
+{
+    sys_free(pf);
+}
+
+/* UCB1: every arm is tried once, then the arm with the highest upper
+ * confidence bound on its reward rate is picked. */
+uint64_t
+portfolio_select(portfolio_t *pf)
+{
+    uint64_t best   = 0;
+    double best_ucb = -1.0;
+    for (uint64_t i = 0; i < pf->narms; i++) {
+        const portfolio_arm_t *arm = &pf->arms[i];
+        if (arm->rounds == 0) {
+            return i;
+        }
+        double ucb = (double)arm->rewards / (double)arm->rounds +
+                     sqrt(2.0 * log((double)pf->rounds) / (double)arm->rounds);
+        if (ucb > best_ucb) {
+            best     = i;
+            best_ucb = ucb;
+        }
+    }
+    return best;
+}
+
+void
+portfolio_apply(const portfolio_t *pf, uint64_t arm, const flags_t *flags,
+                flags_t *dst)
+{
+    ASSERT(arm < pf->narms);
+    flags_cpy(dst, flags);
+    bool ok = _arm_parse(&pf->arms[arm], dst);
+    ASSERT(ok && "portfolio arm was validated");
+}
+
+void
+portfolio_update(portfolio_t *pf, uint64_t arm, bool reward)
+{
+    ASSERT(arm < pf->narms);
+    pf->arms[arm].rounds++;
+    pf->arms[arm].rewards += reward;
+    pf->rounds++;
+}
+
+const char *
+portfolio_arm_str(const portfolio_t *pf, uint64_t arm)
+{
+    ASSERT(arm < pf->narms);
+    return pf->arms[arm].spec;
+}
+
+void
+portfolio_print(const portfolio_t *pf)
+{
+    for (uint64_t i = 0; i < pf->narms; i++) {
+        const portfolio_arm_t *arm = &pf->arms[i];
+        sys_fprintf(stdout, "[lotto] portfolio: %lu/%lu rounds rewarded: %s\n",
+                    arm->rewards, arm->rounds, arm->spec);
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file portfolio.h
+ * @brief Stress declarations for the strategy portfolio.
+ *
+ * A portfolio is a set of arms, each a list of runtime flags such as
+ * `-s pct --pct-d 3`, applied on top of the command flags for one round. Arms
+ * are picked with UCB1, rewarding rounds that reach new interleaving coverage
+ * or fail. The flags of the round are published into its trace, so a failing
+ * round replays with the arm it ran with.
+ */
+#ifndef LOTTO_STRESS_PORTFOLIO_H
+#define LOTTO_STRESS_PORTFOLIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lotto/driver/flagmgr.h>
+
+#define PORTFOLIO_MAX_ARMS 32U
+
+/* Arms tried with `--stress-portfolio default`. They vary strategy, PCT
+ * depth and bias policy only: the POS watchdog is tuned through the
+ * LOTTO_POS_WD_THRESHOLD environment variable rather than a flag, and
+ * `--sampling-config` needs a FILE, so neither fits a default arm. A custom
+ * portfolio can still use `--sampling-config FILE` in its arms. */
+#define PORTFOLIO_DEFAULT                                                      \
+    "-s random;-s pos;-s pct --pct-d 2;-s pct --pct-d 3;-s pct --pct-d 5;"     \
+    "-s random --bias-policy LOWEST;-s random --bias-policy HIGHEST"
+
+typedef struct portfolio portfolio_t;
+
+/**
+ * Parses `spec`, a `;`-separated list of arms.
+ *
+ * @return the portfolio, or NULL if an arm has invalid flags
+ */
+portfolio_t *portfolio_init(const char *spec, const flags_t *flags);
+void portfolio_fini(portfolio_t *pf);
+
+/**
+ * Picks the arm of the next round.
+ */
+uint64_t portfolio_select(portfolio_t *pf);
+
+/**
+ * Copies `flags` into `dst` and applies the flags of `arm` on top.
+ */
+void portfolio_apply(const portfolio_t *pf, uint64_t arm, const flags_t *flags,
+                     flags_t *dst);
+
+/**
+ * Credits the round run with `arm`.
+ */
+void portfolio_update(portfolio_t *pf, uint64_t arm, bool reward);
+
+const char *portfolio_arm_str(const portfolio_t *pf, uint64_t arm);
+
+/**
+ * Prints how many rounds and rewards each arm got.
+ */
+void portfolio_print(const portfolio_t *pf);
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * @file deadline_queue.h
+ * @brief Timeout module declarations for the deadline queue.
+ *
+ * A min-heap of per-task deadlines on the Lotto virtual clock. The earliest
+ * deadline is available in O(1); insertion, rescheduling and cancellation are
+ * O(log n). Tasks are indexed directly by id, so there is at most one deadline
+ * per task in a queue. Ties are broken by ascending task id to keep the
+ * trigger order deterministic.
+ */
+#ifndef LOTTO_MODULES_TIMEOUT_DEADLINE_QUEUE_H
+#define LOTTO_MODULES_TIMEOUT_DEADLINE_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <lotto/base/marshable.h>
+#include <lotto/base/task_id.h>
+
+typedef struct deadline_entry {
+    struct timespec deadline;
+    task_id id;
+} deadline_entry_t;
+
+typedef struct deadline_queue {
+    marshable_t m;
+    size_t size;
+    size_t capacity;
+    deadline_entry_t *entries;
+    size_t icapacity;
+    size_t *index; /* task id -> heap position + 1, 0 if absent */
+} deadline_queue_t;
+
+/*******************************************************************************
+ * marshaling interface
+ ******************************************************************************/
+size_t deadline_queue_msize(const marshable_t *m);
+void *deadline_queue_marshal(const marshable_t *m, void *buf);
+const void *deadline_queue_unmarshal(marshable_t *m, const void *buf);
+void deadline_queue_print(const marshable_t *m);
+
+#define MARSHABLE_DEADLINE_QUEUE                                               \
+    (marshable_t)                                                              \
+    {                                                                          \
+        .alloc_size = sizeof(deadline_queue_t),                                \
+        .unmarshal  = deadline_queue_unmarshal,                                \
+        .marshal    = deadline_queue_marshal,                                  \
+        .size       = deadline_queue_msize,                                    \
+        .print      = deadline_queue_print,                                    \
+    }
+
+/*******************************************************************************
+ * public interface
+ ******************************************************************************/
+/**
+ * Initializes an empty queue.
+ *
+ * @param q queue object
+ */
+void deadline_queue_init(deadline_queue_t *q);
+
+/**
+ * Releases the queue buffers.
+ *
+ * @param q queue object
+ */
+void deadline_queue_fini(deadline_queue_t *q);
+
+/**
+ * Sets the deadline of a task, inserting or rescheduling it.
+ *
+ * @param q queue object
+ * @param id task id
+ * @param deadline absolute deadline on the Lotto clock
+ */
+void deadline_queue_set(deadline_queue_t *q, task_id id,
+                        const struct timespec *deadline);
+
+/**
+ * Removes the deadline of a task.
+ *
+ * @param q queue object
+ * @param id task id
+ * @return true if the task had a deadline
+ */
+bool deadline_queue_cancel(deadline_queue_t *q, task_id id);
+
+/**
+ * Returns the deadline entry of a task or NULL if it has none.
+ *
+ * @param q queue object
+ * @param id task id
+ */
+const deadline_entry_t *deadline_queue_find(const deadline_queue_t *q,
+                                            task_id id);
+
+/**
+ * Returns the earliest deadline entry or NULL if the queue is empty.
+ *
+ * @param q queue object
+ */
+const deadline_entry_t *deadline_queue_peek(const deadline_queue_t *q);
+
+/**
+ * Pops the earliest entry if its deadline is not after `now`.
+ *
+ * @param q queue object
+ * @param now current time
+ * @param out receives the popped entry
+ * @return true if an entry was popped
+ */
+bool deadline_queue_pop_expired(deadline_queue_t *q,
+                                const struct timespec *now,
+                                deadline_entry_t *out);
+
+/**
+ * Returns the number of deadlines in the queue.
+ *
+ * @param q queue object
+ */
+size_t deadline_queue_size(const deadline_queue_t *q);
+
+#endif
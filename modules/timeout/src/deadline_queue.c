@@ -0,0 +1,253 @@
+#include <lotto/modules/clock.h>
+#include <lotto/modules/timeout/deadline_queue.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+
+#define DEADLINE_QUEUE_INIT_SIZE 16
+
+/*******************************************************************************
+ * heap maintenance
+ ******************************************************************************/
+static bool
+_before(const deadline_entry_t *a, const deadline_entry_t *b)
+{
+    int cmp = timespec_compare(&a->deadline, &b->deadline);
+    return cmp < 0 || (cmp == 0 && a->id < b->id);
+}
+
+static void
+_index_expand(deadline_queue_t *q, task_id id)
+{
+    if (id < q->icapacity)
+        return;
+    size_t cap = q->icapacity ? q->icapacity : DEADLINE_QUEUE_INIT_SIZE;
+    while (cap <= id)
+        cap *= 2;
+    q->index = (size_t *)sys_realloc(q->index, sizeof(size_t) * cap);
+    ASSERT(q->index);
+    sys_memset(q->index + q->icapacity, 0,
+               sizeof(size_t) * (cap - q->icapacity));
+    q->icapacity = cap;
+}
+
+static void
+_place(deadline_queue_t *q, size_t pos, const deadline_entry_t *e)
+{
+    q->entries[pos] = *e;
+    q->index[e->id] = pos + 1;
+}
+
+static void
+_sift_up(deadline_queue_t *q, size_t pos)
+{
+    deadline_entry_t e = q->entries[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!_before(&e, &q->entries[parent]))
+            break;
+        _place(q, pos, &q->entries[parent]);
+        pos = parent;
+    }
+    _place(q, pos, &e);
+}
+
+static void
+_sift_down(deadline_queue_t *q, size_t pos)
+{
+    deadline_entry_t e = q->entries[pos];
+    for (;;) {
+        size_t child = 2 * pos + 1;
+        if (child >= q->size)
+            break;
+        if (child + 1 < q->size &&
+            _before(&q->entries[child + 1], &q->entries[child]))
+            child++;
+        if (!_before(&q->entries[child], &e))
+            break;
+        _place(q, pos, &q->entries[child]);
+        pos = child;
+    }
+    _place(q, pos, &e);
+}
+
+static void
+_fix(deadline_queue_t *q, size_t pos)
+{
+    if (pos > 0 && _before(&q->entries[pos], &q->entries[(pos - 1) / 2]))
+        _sift_up(q, pos);
+    else
+        _sift_down(q, pos);
+}
+
+static void
+_remove_at(deadline_queue_t *q, size_t pos)
+{
+    q->index[q->entries[pos].id] = 0;
+    if (--q->size == pos)
+        return;
+    _place(q, pos, &q->entries[q->size]);
+    _fix(q, pos);
+}
+
+/*******************************************************************************
+ * public interface
+ ******************************************************************************/
+void
+deadline_queue_init(deadline_queue_t *q)
+{
+    ASSERT(q);
+    *q = (deadline_queue_t){.m = MARSHABLE_DEADLINE_QUEUE};
+}
+
+void
+deadline_queue_fini(deadline_queue_t *q)
+{
+    ASSERT(q);
+    if (q->entries)
+        sys_free(q->entries);
+    if (q->index)
+        sys_free(q->index);
+    q->entries   = NULL;
+    q->index     = NULL;
+    q->size      = 0;
+    q->capacity  = 0;
+    q->icapacity = 0;
+}
+
+void
+deadline_queue_set(deadline_queue_t *q, task_id id,
+                   const struct timespec *deadline)
+{
+    ASSERT(q);
+    ASSERT(deadline);
+    ASSERT(id != NO_TASK);
+    _index_expand(q, id);
+
+    deadline_entry_t e = {.deadline = *deadline, .id = id};
+    size_t pos         = q->index[id];
+    if (pos != 0) {
+        _place(q, pos - 1, &e);
+        _fix(q, pos - 1);
+        return;
+    }
+    if (q->size == q->capacity) {
+        q->capacity = q->capacity ? q->capacity * 2 : DEADLINE_QUEUE_INIT_SIZE;
+        q->entries  = (deadline_entry_t *)sys_realloc(
+            q->entries, sizeof(deadline_entry_t) * q->capacity);
+        ASSERT(q->entries);
+    }
+    _place(q, q->size++, &e);
+    _sift_up(q, q->size - 1);
+}
+
+bool
+deadline_queue_cancel(deadline_queue_t *q, task_id id)
+{
+    ASSERT(q);
+    if (id >= q->icapacity || q->index[id] == 0)
+        return false;
+    _remove_at(q, q->index[id] - 1);
+    return true;
+}
+
+const deadline_entry_t *
+deadline_queue_find(const deadline_queue_t *q, task_id id)
+{
+    ASSERT(q);
+    if (id >= q->icapacity || q->index[id] == 0)
+        return NULL;
+    return &q->entries[q->index[id] - 1];
+}
+
+const deadline_entry_t *
+deadline_queue_peek(const deadline_queue_t *q)
+{
+    ASSERT(q);
+    return q->size > 0 ? &q->entries[0] : NULL;
+}
+
+bool
+deadline_queue_pop_expired(deadline_queue_t *q, const struct timespec *now,
+                           deadline_entry_t *out)
+{
+    ASSERT(q);
+    ASSERT(now);
+    if (q->size == 0 || timespec_compare(&q->entries[0].deadline, now) > 0)
+        return false;
+    if (out)
+        *out = q->entries[0];
+    _remove_at(q, 0);
+    return true;
+}
+
+size_t
+deadline_queue_size(const deadline_queue_t *q)
+{
+    ASSERT(q);
+    return q->size;
+}
+
+/*******************************************************************************
+ * marshaling implementation
+ ******************************************************************************/
+size_t
+deadline_queue_msize(const marshable_t *m)
+{
+    ASSERT(m);
+    const deadline_queue_t *q = (const deadline_queue_t *)m;
+    return sizeof(size_t) + q->size * sizeof(deadline_entry_t);
+}
+
+void *
+deadline_queue_marshal(const marshable_t *m, void *buf)
+{
+    ASSERT(m);
+    ASSERT(buf);
+    const deadline_queue_t *q = (const deadline_queue_t *)m;
+    char *b                   = (char *)buf;
+
+    sys_memcpy(b, &q->size, sizeof(size_t));
+    b += sizeof(size_t);
+    sys_memcpy(b, q->entries, q->size * sizeof(deadline_entry_t));
+    b += q->size * sizeof(deadline_entry_t);
+    return b;
+}
+
+const void *
+deadline_queue_unmarshal(marshable_t *m, const void *buf)
+{
+    ASSERT(m);
+    ASSERT(buf);
+    deadline_queue_t *q = (deadline_queue_t *)m;
+    const char *b       = (const char *)buf;
+    size_t size;
+
+    deadline_queue_fini(q);
+    sys_memcpy(&size, b, sizeof(size_t));
+    b += sizeof(size_t);
+
+    /* entries were marshaled in heap order, so appending keeps the heap */
+    for (size_t i = 0; i < size; i++) {
+        deadline_entry_t e;
+        sys_memcpy(&e, b, sizeof(deadline_entry_t));
+        b += sizeof(deadline_entry_t);
+        deadline_queue_set(q, e.id, &e.deadline);
+    }
+    return b;
+}
+
+void
+deadline_queue_print(const marshable_t *m)
+{
+    ASSERT(m);
+    const deadline_queue_t *q = (const deadline_queue_t *)m;
+    logger_infof("deadlines = [");
+    for (size_t i = 0; i < q->size; i++) {
+        const deadline_entry_t *e = &q->entries[i];
+        logger_printf("%s(%lu, %ld.%09ld)", i ? ", " : "", e->id,
+                      e->deadline.tv_sec, e->deadline.tv_nsec);
+    }
+    logger_println("]");
+}
@@ -4,20 +4,18 @@
 #include <lotto/engine/sequencer.h>
 #include <lotto/engine/statemgr.h>
 #include <lotto/modules/clock.h>
+#include <lotto/modules/timeout/deadline_queue.h>
 #include <lotto/modules/timeout/timeout.h>
 
 /*******************************************************************************
  * state
  ******************************************************************************/
-typedef struct timeout {
-    tiditem_t ti;
-    struct timespec deadline;
-} timeout_t;
+static deadline_queue_t _state;
 
-tidmap_t _state;
-
-REGISTER_STATE(EPHEMERAL, _state,
-               { tidmap_init(&_state, MARSHABLE_STATIC(sizeof(timeout_t))); })
+REGISTER_STATE(EPHEMERAL, _state, {
+    deadline_queue_fini(&_state);
+    deadline_queue_init(&_state);
+})
 
 /*******************************************************************************
  * utils
@@ -34,51 +32,28 @@ static void
 _check_deadlines(tidset_t *tset)
 {
     struct timespec now;
+    deadline_entry_t e;
     lotto_clock_time(&now);
-    for (const tiditem_t *cur = tidmap_iterate(&_state); cur;) {
-        const timeout_t *timeout = (const timeout_t *)cur;
-        if (timespec_compare(&timeout->deadline, &now) > 0) {
-            cur = tidmap_next(cur);
-            continue;
-        }
-        task_id id = cur->key;
-        _trigger_timeout(tset, id);
-        cur = tidmap_next(cur);
-        tidmap_deregister(&_state, id);
+    while (deadline_queue_pop_expired(&_state, &now, &e)) {
+        _trigger_timeout(tset, e.id);
     }
 }
 
 static void
 _time_leap(tidset_t *tset)
 {
-    const timeout_t *min = &(timeout_t){.deadline.tv_sec = INT32_MAX};
-    bool multiple        = false;
-    for (const tiditem_t *cur = tidmap_iterate(&_state); cur;
-         cur                  = tidmap_next(cur)) {
-        const timeout_t *timeout = (const timeout_t *)cur;
-        int cmp = timespec_compare(&timeout->deadline, &min->deadline);
-        if (cmp > 0) {
-            continue;
-        }
-        multiple = min->ti.key != NO_TASK && cmp == 0;
-        min      = timeout;
-    }
-    task_id id = min->ti.key;
-    ASSERT(id != NO_TASK);
-    lotto_clock_leap(&min->deadline);
-    if (multiple) {
-        _check_deadlines(tset);
-        return;
-    }
-    _trigger_timeout(tset, id);
-    tidmap_deregister(&_state, id);
+    const deadline_entry_t *min = deadline_queue_peek(&_state);
+    ASSERT(min && min->id != NO_TASK);
+    struct timespec deadline = min->deadline;
+    lotto_clock_leap(&deadline);
+    _check_deadlines(tset);
 }
 
 STATIC void
 _timeout_handle(const capture_point *cp, event_t *e)
 {
     (void)cp;
-    if (tidmap_size(&_state) == 0) {
+    if (deadline_queue_size(&_state) == 0) {
         return;
     }
     _check_deadlines(&e->tset);
@@ -95,16 +70,11 @@ ON_SEQUENCER_CAPTURE(_timeout_handle);
 void
 handler_timeout_register(task_id id, const struct timespec *deadline)
 {
-    timeout_t *timeout =
-        (timeout_t *)tidmap_find_or_register(&_state, id, NULL);
-    struct timespec now;
-    lotto_clock_time(&now);
-    ASSERT(timeout);
-    timeout->deadline = *deadline;
+    deadline_queue_set(&_state, id, deadline);
 }
 
 void
 handler_timeout_deregister(task_id id)
 {
-    tidmap_deregister(&_state, id);
+    deadline_queue_cancel(&_state, id);
 }
@@ -24,3 +24,10 @@ NEW_CALLBACK_FLAG(UAFCHECK_PROB, "", "uafcheck-prob", "FLOAT",
                       }
                       uafcheck_config()->prob = as_dval(v);
                   })
+
+NEW_CALLBACK_FLAG(UAFCHECK_BATCH, "", "uafcheck-batch", "INT",
+                  "number of frees protected together by uafcheck",
+                  flag_uval(UAFCHECK_DEFAULT_BATCH), {
+                      ASSERT(as_uval(v) > 0);
+                      uafcheck_config()->batch = as_uval(v);
+                  })
@@ -5,11 +5,13 @@
 static uafcheck_config_t _config = {
     .max_pages = UAFCHECK_DEFAULT_MAX_PAGES,
     .prob      = UAFCHECK_DEFAULT_PROB,
+    .batch     = UAFCHECK_DEFAULT_BATCH,
 };
 
 REGISTER_CONFIG(_config, {
     logger_infof("max_pages = %lu\n", _config.max_pages);
     logger_infof("prob      = %g\n", _config.prob);
+    logger_infof("batch     = %lu\n", _config.batch);
 })
 
 uafcheck_config_t *
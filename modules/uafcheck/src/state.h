@@ -7,11 +7,13 @@
 
 #define UAFCHECK_DEFAULT_MAX_PAGES 16
 #define UAFCHECK_DEFAULT_PROB      0.5
+#define UAFCHECK_DEFAULT_BATCH     1
 
 typedef struct uafcheck_config {
     marshable_t m;
     size_t max_pages;
     double prob;
+    size_t batch;
 } uafcheck_config_t;
 
 uafcheck_config_t *uafcheck_config(void);
@@ -1,20 +1,14 @@
-#include <malloc.h>
 #include <stdlib.h>
 #include <unistd.h>
 
 #include "state.h"
 #include "uafcheck.h"
+#include <lotto/engine/prng.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
 #include <lotto/sys/real.h>
 #include <lotto/sys/string.h>
 #include <sys/mman.h>
-#include <vsync/queue/bounded_spsc.h>
-#include <vsync/queue/internal/bounded_ret.h>
-
-#define UAFC_CANARY 0xBEEFFEED
-
-#define METADATA_SIZE sizeof(alloc_t)
 
 static uintptr_t _pagesize;
 static uintptr_t _pagemask;
@@ -39,67 +33,252 @@ uafc_init(void *(*alloc)(size_t), void *(*aligned_alloc)(size_t, size_t),
                    .free          = free,
                    .realloc       = realloc};
 
-    size_t len = sizeof(alloc_t *) * uafcheck_config()->max_pages;
-    void *buf  = alloc(len);
-    ASSERT(buf);
+    // every span has at least one page, and at most one batch is enqueued
+    // before the quarantine is trimmed
+    uc->qcap       = uafcheck_config()->max_pages + UAFC_MAX_BATCH;
+    uc->quarantine = alloc(sizeof(uafc_span_t) * uc->qcap);
+    uc->scratch    = alloc(sizeof(uafc_span_t) * uc->qcap);
+    ASSERT(uc->quarantine && uc->scratch);
 
-    bounded_spsc_init(&uc->protected, buf, uafcheck_config()->max_pages);
     caslock_init(&uc->lock);
 
     return uc;
 }
 
+/*******************************************************************************
+ * sampling
+ ******************************************************************************/
+
+/* Sampling draws from its own substream of the engine generator, so that
+ * runs are reproducible without consuming the scheduler's random numbers. */
+static bool
+_uafc_sample(uafc_t *uc)
+{
+    double prob = uafcheck_config()->prob;
+    if (prob <= 0.0)
+        return false;
+    if (prob >= 1.0)
+        return true;
+
+    uint64_t seed   = prng_seed();
+    uint64_t stream = prng()->stream;
+    if (!uc->seeded || uc->seed != seed || uc->stream != stream) {
+        uc->seed   = seed;
+        uc->stream = stream;
+        uc->seeded = true;
+        prng_sub_init(&uc->sampler, seed, stream, PRNG_SUB_UAFCHECK);
+    }
+    return prng_sub_real(&uc->sampler) <= prob;
+}
+
+/*******************************************************************************
+ * page slab
+ ******************************************************************************/
+
+static uafc_region_t *
+_uafc_region_of(uafc_t *uc, uintptr_t p)
+{
+    for (size_t i = 0; i < uc->nregions; i++) {
+        uafc_region_t *r = &uc->regions[i];
+        if (p >= r->begin && p < r->end)
+            return r;
+    }
+    return NULL;
+}
+
+static inline uafc_page_t *
+_uafc_meta(uafc_region_t *r, uintptr_t p)
+{
+    return &r->meta[(p - r->begin) / _pagesize];
+}
+
+static uafc_region_t *
+_uafc_region_new(uafc_t *uc)
+{
+    if (uc->nregions == UAFC_MAX_REGIONS)
+        return NULL;
+
+    // the metadata pages precede the data pages of the region
+    size_t meta_pages =
+        (UAFC_REGION_PAGES * sizeof(uafc_page_t) + _pagesize - 1) / _pagesize;
+    size_t len = (meta_pages + UAFC_REGION_PAGES) * _pagesize;
+    void *base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        logger_warnf("could not map uafcheck region\n");
+        return NULL;
+    }
+
+    uafc_region_t *r = &uc->regions[uc->nregions++];
+    r->meta          = base;
+    r->begin         = (uintptr_t)base + meta_pages * _pagesize;
+    r->end           = r->begin + UAFC_REGION_PAGES * _pagesize;
+    r->bump          = r->begin;
+    return r;
+}
+
+static inline size_t
+_uafc_class(uint32_t pages)
+{
+    return pages <= UAFC_SPAN_CLASSES ? pages - 1 : UAFC_SPAN_CLASSES;
+}
+
+static void *
+_uafc_span_reuse(uafc_t *uc, uint32_t pages)
+{
+    void **link = &uc->free_spans[_uafc_class(pages)];
+    if (pages <= UAFC_SPAN_CLASSES) {
+        void *span = *link;
+        if (span != NULL)
+            *link = *(void **)span;
+        return span;
+    }
+
+    // large spans: first fit that wastes at most half of the span
+    for (void *span; (span = *link) != NULL; link = (void **)span) {
+        uafc_region_t *r = _uafc_region_of(uc, (uintptr_t)span);
+        uint32_t have    = _uafc_meta(r, (uintptr_t)span)->pages;
+        if (have >= pages && have <= 2 * pages) {
+            *link = *(void **)span;
+            return span;
+        }
+    }
+    return NULL;
+}
+
+static void *
+_uafc_span_alloc(uafc_t *uc, uint32_t pages)
+{
+    void *span = _uafc_span_reuse(uc, pages);
+    if (span != NULL)
+        return span;
+
+    uafc_region_t *r = uc->nregions > 0 ? &uc->regions[uc->nregions - 1] : NULL;
+    if (r == NULL || r->bump + pages * _pagesize > r->end)
+        r = _uafc_region_new(uc);
+    if (r == NULL)
+        return NULL;
+
+    span = (void *)r->bump;
+    r->bump += pages * _pagesize;
+    _uafc_meta(r, (uintptr_t)span)->pages = pages;
+    return span;
+}
+
+/*******************************************************************************
+ * quarantine
+ ******************************************************************************/
+
+static int
+_uafc_span_cmp(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)((const uafc_span_t *)a)->ptr;
+    uintptr_t y = (uintptr_t)((const uafc_span_t *)b)->ptr;
+    return x < y ? -1 : x > y;
+}
+
+/* Applies `prot` to the spans, which are sorted by address, with one call per
+ * run of adjacent spans. Released spans also drop their pages. */
+static void
+_uafc_apply(uafc_span_t *spans, size_t n, int prot, bool release)
+{
+    for (size_t i = 0; i < n;) {
+        uintptr_t start = (uintptr_t)spans[i].ptr;
+        uintptr_t end   = start + spans[i].meta->pages * _pagesize;
+        for (i++; i < n && (uintptr_t)spans[i].ptr == end; i++)
+            end += spans[i].meta->pages * _pagesize;
+
+        if (release && madvise((void *)start, end - start, MADV_DONTNEED) != 0)
+            logger_fatalf("could not release pages\n");
+        if (mprotect((void *)start, end - start, prot) != 0)
+            logger_fatalf("could not mprotect pages\n");
+    }
+}
+
+/* Releases the oldest quarantined spans until at most `pages` remain. */
+static void
+_uafc_evict(uafc_t *uc, size_t pages)
+{
+    size_t n = 0;
+    while (uc->qlen > 0 && uc->qpages > pages) {
+        uafc_span_t s = uc->quarantine[uc->qhead];
+        uc->qhead     = (uc->qhead + 1) % uc->qcap;
+        uc->qlen--;
+        uc->qpages -= s.meta->pages;
+        uc->scratch[n++] = s;
+    }
+    if (n == 0)
+        return;
+
+    qsort(uc->scratch, n, sizeof(uafc_span_t), _uafc_span_cmp);
+    _uafc_apply(uc->scratch, n, PROT_READ | PROT_WRITE, true);
+
+    for (size_t i = 0; i < n; i++) {
+        uafc_span_t *s  = &uc->scratch[i];
+        void **head     = &uc->free_spans[_uafc_class(s->meta->pages)];
+        s->meta->state  = UAFC_SPAN_RELEASED;
+        *(void **)s->ptr = *head;
+        *head            = s->ptr;
+    }
+}
+
+/* Protects the pending frees and moves them into the quarantine. */
+static void
+_uafc_protect_pending(uafc_t *uc)
+{
+    size_t n = uc->npending;
+    if (n == 0)
+        return;
+
+    sys_memcpy(uc->scratch, uc->pending, n * sizeof(uafc_span_t));
+    qsort(uc->scratch, n, sizeof(uafc_span_t), _uafc_span_cmp);
+    _uafc_apply(uc->scratch, n, PROT_NONE, false);
+
+    for (size_t i = 0; i < n; i++) {
+        ASSERT(uc->qlen < uc->qcap);
+        uc->quarantine[(uc->qhead + uc->qlen) % uc->qcap] = uc->pending[i];
+        uc->qlen++;
+        uc->qpages += uc->pending[i].meta->pages;
+    }
+    uc->npending = 0;
+
+    // trim in batches as well, keeping half of the budget protected
+    size_t max_pages = uafcheck_config()->max_pages;
+    if (uc->qpages > max_pages)
+        _uafc_evict(uc, max_pages / 2);
+}
+
+/*******************************************************************************
+ * public interface
+ ******************************************************************************/
+
 void *
 uafc_alloc(uafc_t *uc, size_t n)
 {
     ASSERT(uc);
 
-    // sample probability
-    double p = rand() * 1.0 / RAND_MAX;
-    if (p > uafcheck_config()->prob)
+    if (n > UAFC_REGION_PAGES * _pagesize || !_uafc_sample(uc))
         return uc->alloc(n);
 
-    size_t size    = n + METADATA_SIZE + 2 * _pagesize;
-    uintptr_t base = (uintptr_t)uc->alloc(size);
-    ASSERT(base);
-
     // allocation
-    // base ptr
+    // span (page aligned)
     //   |                        |
-    //   +------ next page -------+
-    //   | alloc_t                |
     //   +------------------------+
     //   | user data              |
     //   | ...                    |
+    //   +------------------------+
+    //
+    // the metadata lives in the page table of the region
+    uint32_t pages = n == 0 ? 1 : (uint32_t)((n + _pagesize - 1) / _pagesize);
+    void *span     = _uafc_span_alloc(uc, pages);
+    if (span == NULL)
+        return uc->alloc(n);
 
-    uintptr_t next = (base + _pagesize + METADATA_SIZE) & _pagemask;
-    alloc_t *a     = (alloc_t *)next - 1;
-    ASSERT((uintptr_t)a >= base);
-    ASSERT(next + n <= base + size);
-    a->canary = UAFC_CANARY;
-    a->base   = (void *)base;
-    a->size   = n;
-
-    return a->data;
-}
-
-static bool
-_uafc_drop(uafc_t *uc)
-{
-    void *ptr = NULL;
-    if (bounded_spsc_deq(&uc->protected, &ptr) == QUEUE_BOUNDED_EMPTY)
-        return false;
-
-    int ret = mprotect(ptr + METADATA_SIZE, _pagesize,
-                       PROT_READ | PROT_EXEC | PROT_WRITE);
-    if (ret != 0)
-        logger_fatalf("could not mprotect page\n");
-
-    alloc_t *a = (alloc_t *)ptr;
-    a->canary  = ~UAFC_CANARY;
-    uc->free(a->base);
-
-    return true;
+    uafc_page_t *m = _uafc_meta(_uafc_region_of(uc, (uintptr_t)span),
+                                (uintptr_t)span);
+    m->size        = n;
+    m->state       = UAFC_SPAN_LIVE;
+    return span;
 }
 
 void
@@ -109,35 +288,24 @@ uafc_free(uafc_t *uc, void *p)
         return;
     }
     ASSERT(uc);
-    alloc_t *a = (alloc_t *)p - 1;
 
-    // if not alloc_t wouldn't be aligned or a is aligned but canary dead,
-    // then p is not uafc allocated
-    if (((uintptr_t)p & _pagemask) != (uintptr_t)p ||
-        (a->canary != UAFC_CANARY)) {
+    uafc_region_t *r = _uafc_region_of(uc, (uintptr_t)p);
+    if (r == NULL) {
         uc->free(p);
         return;
     }
 
-    // probe double free
-    volatile char c = *(char *)p;
-    (void)c;
-
-    // protect page and save
-    int ret = mprotect(p, _pagesize, PROT_NONE);
-    if (ret != 0)
-        logger_fatalf("could not protect page\n");
+    uafc_page_t *m = _uafc_meta(r, (uintptr_t)p);
+    if (((uintptr_t)p & _pagemask) != (uintptr_t)p ||
+        m->state != UAFC_SPAN_LIVE)
+        logger_fatalf("invalid or double free of %p\n", p);
 
-    ASSERT(a->canary == UAFC_CANARY);
+    m->state = UAFC_SPAN_FREED;
+    uc->pending[uc->npending++] = (uafc_span_t){.ptr = p, .meta = m};
 
-    caslock_acquire(&uc->lock);
-    if (bounded_spsc_enq(&uc->protected, a) == QUEUE_BOUNDED_FULL) {
-        bool ok = _uafc_drop(uc);
-        ASSERT(ok);
-        int r = bounded_spsc_enq(&uc->protected, a);
-        ASSERT(r == QUEUE_BOUNDED_OK);
-    }
-    caslock_release(&uc->lock);
+    size_t batch = uafcheck_config()->batch;
+    if (uc->npending >= batch || uc->npending == UAFC_MAX_BATCH)
+        _uafc_protect_pending(uc);
 }
 
 void *
@@ -155,20 +323,18 @@ uafc_realloc(uafc_t *uc, void *p, size_t n)
         return uafc_alloc(uc, n);
     }
     ASSERT(uc);
-    alloc_t *a = (alloc_t *)p - 1;
 
-    // if not alloc_t wouldn't be aligned or a is aligned but canary dead,
-    // then p is not uafc allocated
-    if (p == NULL || ((uintptr_t)p & _pagemask) != (uintptr_t)p ||
-        (a->canary != UAFC_CANARY))
+    uafc_region_t *r = _uafc_region_of(uc, (uintptr_t)p);
+    if (r == NULL)
         return uc->realloc(p, n);
 
-    void *np = uafc_alloc(uc, n);
-    if (!np || !p) {
+    size_t size = _uafc_meta(r, (uintptr_t)p)->size;
+    void *np    = uafc_alloc(uc, n);
+    if (!np) {
         return np;
     }
 
-    n = a->size < n ? a->size : n;
+    n = size < n ? size : n;
     sys_memcpy(np, p, n);
     uafc_free(uc, p);
 
@@ -181,9 +347,10 @@ uafc_fini(uafc_t *uc)
     ASSERT(uc);
 
     caslock_acquire(&uc->lock);
-    while (_uafc_drop(uc))
-        ;
+    _uafc_protect_pending(uc);
+    _uafc_evict(uc, 0);
     caslock_release(&uc->lock);
-    uc->free(uc->protected.buf);
+    uc->free(uc->quarantine);
+    uc->free(uc->scratch);
     uc->free(uc);
 }
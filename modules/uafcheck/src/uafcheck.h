@@ -1,30 +1,85 @@
 /**
  * @file uafcheck.h
  * @brief Uafcheck module declarations for uafcheck.
+ *
+ * Sampled objects live in page spans carved from large regions that are
+ * mapped once. A freed span is protected and kept in a quarantine, so a
+ * later access faults. Frees are protected in batches and evicted spans are
+ * released in batches, both coalescing adjacent spans into a single
+ * mprotect/madvise range.
  */
 #ifndef LOTTO_UAFCHECK_H
 #define LOTTO_UAFCHECK_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 
+#include <lotto/engine/prng.h>
 #include <lotto/sys/assert.h>
-#include <vsync/queue/bounded_spsc.h>
 #include <vsync/spinlock/caslock.h>
 
-typedef struct uaf_alloc {
-    void *base;
-    size_t size;
-    uint64_t canary;
-    char data[0];
-} alloc_t;
+#define UAFC_REGION_PAGES 16384U
+#define UAFC_MAX_REGIONS  64U
+#define UAFC_SPAN_CLASSES 16U
+#define UAFC_MAX_BATCH    64U
+
+enum uafc_span_state {
+    UAFC_SPAN_NONE = 0,
+    UAFC_SPAN_LIVE,
+    UAFC_SPAN_FREED,
+    UAFC_SPAN_RELEASED,
+};
+
+/* Per-page metadata, only meaningful for the first page of a span. */
+typedef struct uafc_page {
+    uint64_t size;
+    uint32_t pages;
+    uint32_t state;
+} uafc_page_t;
+
+typedef struct uafc_region {
+    uintptr_t begin; /* first data page */
+    uintptr_t end;
+    uintptr_t bump;
+    uafc_page_t *meta;
+} uafc_region_t;
+
+typedef struct uafc_span {
+    void *ptr;
+    uafc_page_t *meta;
+} uafc_span_t;
 
 typedef struct uafc {
     caslock_t lock;
-    bounded_spsc_t protected;
     void *(*alloc)(size_t);
     void *(*aligned_alloc)(size_t, size_t);
     void (*free)(void *);
     void *(*realloc)(void *, size_t);
+
+    // sampling substream of the engine seed and stream
+    uint64_t seed;
+    uint64_t stream;
+    prng_sub_t sampler;
+    bool seeded;
+
+    uafc_region_t regions[UAFC_MAX_REGIONS];
+    size_t nregions;
+
+    // released spans, linked through their first word
+    void *free_spans[UAFC_SPAN_CLASSES + 1];
+
+    // freed spans waiting to be protected
+    uafc_span_t pending[UAFC_MAX_BATCH];
+    size_t npending;
+
+    // protected spans, oldest first
+    uafc_span_t *quarantine;
+    uafc_span_t *scratch;
+    size_t qcap;
+    size_t qhead;
+    size_t qlen;
+    size_t qpages;
 } uafc_t;
 
 uafc_t *uafc_init(void *(*alloc)(size_t),
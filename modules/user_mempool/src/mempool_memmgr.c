@@ -3,6 +3,10 @@
 #include <stdlib.h>
 
 #include "mempool.h"
+#include <dice/chains/capture.h>
+#include <dice/events/thread.h>
+#include <dice/module.h>
+#include <dice/pubsub.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/memmgr_impl.h>
 #include <lotto/sys/mempool.h>
@@ -62,3 +66,10 @@ memmgr_free(void *ptr)
     memmgr_init();
     FORWARD(free, ptr);
 }
+
+/* Hands the magazines of an exiting thread back to the pool. */
+PS_SUBSCRIBE(CAPTURE_EVENT, EVENT_THREAD_EXIT, {
+    if (_lotto_mempool != NULL)
+        lotto_mempool_thread_fini(_lotto_mempool);
+    return PS_OK;
+})
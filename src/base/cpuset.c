@@ -0,0 +1,89 @@
+#include <limits.h>
+#include <stdbool.h>
+
+#include <lotto/base/cpuset.h>
+#include <lotto/sys/stdio.h>
+
+static bool
+_read_topology(int cpu, const char *name, uint64_t *val)
+{
+    char path[PATH_MAX];
+    sys_snprintf(path, PATH_MAX, "/sys/devices/system/cpu/cpu%d/topology/%s",
+                 cpu, name);
+    FILE *fp = sys_fopen(path, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    bool ok = sys_fscanf(fp, "%lu", val) == 1;
+    sys_fclose(fp);
+    return ok;
+}
+
+uint64_t
+cpuset_core(int cpu)
+{
+    uint64_t package, core;
+    if (!_read_topology(cpu, "physical_package_id", &package) ||
+        !_read_topology(cpu, "core_id", &core)) {
+        return UINT64_MAX - (uint64_t)cpu;
+    }
+    return package << 32 | (core & UINT32_MAX);
+}
+
+size_t
+cpuset_spread(const cpu_set_t *set, cpu_core_f *core_of, cpu_order_t *order)
+{
+    uint64_t keys[CPU_SETSIZE];
+    cpu_order_t cpus[CPU_SETSIZE];
+    uint32_t rank[CPU_SETSIZE]; /* SMT siblings listed before on the core */
+    uint32_t ncores = 0;
+    size_t n        = 0;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, set)) {
+            continue;
+        }
+        keys[n]  = core_of(cpu);
+        rank[n]  = 0;
+        cpus[n]  = (cpu_order_t){.cpu = cpu, .core = ncores};
+        size_t i = 0;
+        for (; i < n && keys[i] != keys[n]; i++) {}
+        if (i < n) {
+            for (size_t j = i; j < n; j++) {
+                rank[n] += keys[j] == keys[n];
+            }
+            cpus[n].core = cpus[i].core;
+        } else {
+            ncores++;
+        }
+        n++;
+    }
+
+    size_t k = 0;
+    for (uint32_t r = 0; k < n; r++) {
+        for (size_t i = 0; i < n; i++) {
+            if (rank[i] == r) {
+                order[k++] = cpus[i];
+            }
+        }
+    }
+    return n;
+}
+
+void
+cpuset_job(const cpu_order_t *order, size_t n, uint64_t job, uint64_t jobs,
+           cpu_set_t *mine)
+{
+    uint32_t ncores = 0;
+    for (size_t i = 0; i < n && order[i].core == ncores; i++) {
+        ncores++;
+    }
+
+    CPU_ZERO(mine);
+    for (size_t i = 0; i < n; i++) {
+        if (jobs <= ncores ? order[i].core * jobs / ncores == job :
+                             i == job % n) {
+            CPU_SET(order[i].cpu, mine);
+        }
+    }
+}
@@ -0,0 +1,278 @@
+#include <lotto/base/prioheap.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+
+#define PRIOHEAP_INIT_SIZE 16
+
+/*******************************************************************************
+ * ordering
+ ******************************************************************************/
+static uint64_t
+_scale(uint64_t prio, uint64_t mult, uint64_t k, bool *overflow)
+{
+    *overflow = false;
+    if (k == 0 || prio == 0 || mult == 1)
+        return prio;
+    if (mult == 0)
+        return 0;
+    for (; k > 0; k--) {
+        if (__builtin_mul_overflow(prio, mult, &prio)) {
+            *overflow = true;
+            return UINT64_MAX;
+        }
+    }
+    return prio;
+}
+
+/* Compares effective priorities exactly: both nodes are brought to the most
+ * recent of their epochs, and a scaled value that overflows is larger than any
+ * unscaled one. */
+static int
+_prio_cmp(const prioheap_t *heap, const prionode_t *a, const prionode_t *b)
+{
+    bool overflow;
+    uint64_t pa = a->prio;
+    uint64_t pb = b->prio;
+
+    if (a->epoch < b->epoch) {
+        pa = _scale(pa, heap->mult, b->epoch - a->epoch, &overflow);
+        if (overflow)
+            return 1;
+    } else if (b->epoch < a->epoch) {
+        pb = _scale(pb, heap->mult, a->epoch - b->epoch, &overflow);
+        if (overflow)
+            return -1;
+    }
+    return pa > pb ? 1 : pa < pb ? -1 : 0;
+}
+
+static bool
+_above(const prioheap_t *heap, const prionode_t *a, const prionode_t *b)
+{
+    int c = _prio_cmp(heap, a, b);
+    return c > 0 || (c == 0 && a->id < b->id);
+}
+
+/*******************************************************************************
+ * heap maintenance
+ ******************************************************************************/
+static void
+_place(prioheap_t *heap, size_t pos, prionode_t *node)
+{
+    heap->nodes[pos] = node;
+    node->pos        = pos;
+}
+
+static void
+_sift_up(prioheap_t *heap, size_t pos)
+{
+    prionode_t *node = heap->nodes[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!_above(heap, node, heap->nodes[parent]))
+            break;
+        _place(heap, pos, heap->nodes[parent]);
+        pos = parent;
+    }
+    _place(heap, pos, node);
+}
+
+static void
+_sift_down(prioheap_t *heap, size_t pos)
+{
+    prionode_t *node = heap->nodes[pos];
+    for (;;) {
+        size_t child = 2 * pos + 1;
+        if (child >= heap->size)
+            break;
+        if (child + 1 < heap->size &&
+            _above(heap, heap->nodes[child + 1], heap->nodes[child]))
+            child++;
+        if (!_above(heap, heap->nodes[child], node))
+            break;
+        _place(heap, pos, heap->nodes[child]);
+        pos = child;
+    }
+    _place(heap, pos, node);
+}
+
+static void
+_fix(prioheap_t *heap, size_t pos)
+{
+    if (pos > 0 && _above(heap, heap->nodes[pos], heap->nodes[(pos - 1) / 2]))
+        _sift_up(heap, pos);
+    else
+        _sift_down(heap, pos);
+}
+
+static void
+_expand(prioheap_t *heap)
+{
+    size_t cap = heap->capacity ? heap->capacity * 2 : PRIOHEAP_INIT_SIZE;
+    heap->nodes =
+        (prionode_t **)sys_realloc(heap->nodes, sizeof(prionode_t *) * cap);
+    heap->frontier =
+        (size_t *)sys_realloc(heap->frontier, sizeof(size_t) * cap);
+    ASSERT(heap->nodes && heap->frontier);
+    heap->capacity = cap;
+}
+
+/*******************************************************************************
+ * public interface
+ ******************************************************************************/
+void
+prioheap_init(prioheap_t *heap, uint64_t mult)
+{
+    ASSERT(heap);
+    sys_memset(heap, 0, sizeof(prioheap_t));
+    heap->mult = mult;
+}
+
+void
+prioheap_fini(prioheap_t *heap)
+{
+    ASSERT(heap);
+    if (heap->nodes)
+        sys_free(heap->nodes);
+    if (heap->frontier)
+        sys_free(heap->frontier);
+    sys_memset(heap, 0, sizeof(prioheap_t));
+}
+
+void
+prioheap_insert(prioheap_t *heap, prionode_t *node, task_id id, uint64_t prio)
+{
+    ASSERT(heap);
+    ASSERT(node);
+    if (heap->size == heap->capacity)
+        _expand(heap);
+    node->id    = id;
+    node->prio  = prio;
+    node->epoch = heap->epoch;
+    _place(heap, heap->size++, node);
+    _sift_up(heap, node->pos);
+}
+
+void
+prioheap_remove(prioheap_t *heap, prionode_t *node)
+{
+    ASSERT(heap);
+    ASSERT(node);
+    ASSERT(node->pos < heap->size && heap->nodes[node->pos] == node);
+    size_t pos       = node->pos;
+    prionode_t *last = heap->nodes[--heap->size];
+    node->pos        = PRIOHEAP_NONE;
+    if (last == node)
+        return;
+    _place(heap, pos, last);
+    _fix(heap, pos);
+}
+
+void
+prioheap_update(prioheap_t *heap, prionode_t *node, uint64_t prio)
+{
+    ASSERT(heap);
+    ASSERT(node);
+    ASSERT(node->pos < heap->size && heap->nodes[node->pos] == node);
+    node->prio  = prio;
+    node->epoch = heap->epoch;
+    _fix(heap, node->pos);
+}
+
+uint64_t
+prioheap_prio(const prioheap_t *heap, const prionode_t *node)
+{
+    ASSERT(heap);
+    ASSERT(node);
+    bool overflow;
+    return _scale(node->prio, heap->mult, heap->epoch - node->epoch,
+                  &overflow);
+}
+
+void
+prioheap_decay(prioheap_t *heap)
+{
+    ASSERT(heap);
+    heap->epoch++;
+}
+
+size_t
+prioheap_size(const prioheap_t *heap)
+{
+    ASSERT(heap);
+    return heap->size;
+}
+
+prionode_t *
+prioheap_top(const prioheap_t *heap)
+{
+    ASSERT(heap);
+    return heap->size > 0 ? heap->nodes[0] : NULL;
+}
+
+/* The frontier is a max-heap of positions in heap->nodes. Since a child is
+ * never above its parent, popping the frontier and pushing the children of the
+ * popped position enumerates nodes in heap order. */
+static void
+_frontier_push(prioheap_t *heap, size_t *n, size_t pos)
+{
+    size_t i = (*n)++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!_above(heap, heap->nodes[pos],
+                    heap->nodes[heap->frontier[parent]]))
+            break;
+        heap->frontier[i] = heap->frontier[parent];
+        i                 = parent;
+    }
+    heap->frontier[i] = pos;
+}
+
+static size_t
+_frontier_pop(prioheap_t *heap, size_t *n)
+{
+    size_t top  = heap->frontier[0];
+    size_t last = heap->frontier[--(*n)];
+    size_t i    = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *n)
+            break;
+        if (child + 1 < *n &&
+            _above(heap, heap->nodes[heap->frontier[child + 1]],
+                   heap->nodes[heap->frontier[child]]))
+            child++;
+        if (!_above(heap, heap->nodes[heap->frontier[child]],
+                    heap->nodes[last]))
+            break;
+        heap->frontier[i] = heap->frontier[child];
+        i                 = child;
+    }
+    heap->frontier[i] = last;
+    return top;
+}
+
+prionode_t *
+prioheap_first_in(prioheap_t *heap, const tidset_t *tset)
+{
+    ASSERT(heap);
+    ASSERT(tset);
+
+    if (tidset_size(tset) == 0 || heap->size == 0)
+        return NULL;
+
+    size_t n = 0;
+    _frontier_push(heap, &n, 0);
+    while (n > 0) {
+        size_t pos       = _frontier_pop(heap, &n);
+        prionode_t *node = heap->nodes[pos];
+        if (tidset_has(tset, node->id))
+            return node;
+        if (2 * pos + 1 < heap->size)
+            _frontier_push(heap, &n, 2 * pos + 1);
+        if (2 * pos + 2 < heap->size)
+            _frontier_push(heap, &n, 2 * pos + 2);
+    }
+    return NULL;
+}
@@ -5,6 +5,7 @@
 
 #include <lotto/base/record.h>
 #include <lotto/base/trace_file.h>
+#include <lotto/base/trace_footer.h>
 #include <lotto/base/trace_impl.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
@@ -16,6 +17,8 @@ typedef struct {
     trace_t iface;
     record_t *cur;
     stream_t *stream;
+    bool sealed;
+    trace_index_t index;
 } trace_file_t;
 
 /**
@@ -33,9 +36,18 @@ _append_safe(trace_t *t, record_t *record)
     // calculate total size of record
     size_t size = sizeof(record_t) + record->size;
 
+    if (!tf->sealed)
+        trace_index_add(&tf->index, record);
+
     if (size != stream_write(tf->stream, (const char *)record, size))
         return TRACE_ERROR;
 
+    // the EXIT record ends the trace, seal it so that readers can seek
+    if (record->kind == RECORD_EXIT && !tf->sealed) {
+        tf->sealed = true;
+        (void)trace_index_seal(&tf->index, tf->stream);
+    }
+
     return TRACE_OK;
 }
 
@@ -155,16 +167,21 @@ _save_to(const trace_t *t, stream_t *stream)
         return;
 
     trace_file_t *tf = (trace_file_t *)t;
+    trace_index_t index;
+    trace_index_init(&index);
     sys_free(tf->cur);
     tf->cur = NULL;
     for (record_t *record = _next(&tf->iface, RECORD_ANY); record;
          _advance(&tf->iface), record = _next(&tf->iface, RECORD_ANY)) {
         size_t size = sizeof(record_t) + record->size;
+        trace_index_add(&index, record);
         // dump record
         size_t r = stream_write(stream, (const char *)record, size);
         if (r == 0)
             logger_fatalf("failed to dump record");
     }
+    if (!trace_index_seal(&index, stream))
+        logger_fatalf("failed to dump trace footer");
 }
 
 trace_t *
@@ -185,5 +202,7 @@ trace_file_create(stream_t *stream)
     tf->iface.stream      = _stream;
     tf->stream            = stream;
     tf->cur               = NULL;
+    tf->sealed            = false;
+    trace_index_init(&tf->index);
     return &tf->iface;
 }
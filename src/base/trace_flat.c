@@ -5,6 +5,7 @@
 
 #include <lotto/base/record.h>
 #include <lotto/base/trace_flat.h>
+#include <lotto/base/trace_footer.h>
 #include <lotto/base/trace_impl.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
@@ -135,6 +136,11 @@ _load(trace_t *t)
         // read data from stream
         r = stream_read(tf->stream, record->data, record->size);
         ASSERT(r == record->size && "could not read payload");
+        // the footer is rebuilt when the trace is saved
+        if (record->kind == RECORD_NONE) {
+            sys_free(record);
+            continue;
+        }
         if (TRACE_OK != trace_append(t, record))
             ASSERT(0 && "trace append failed");
     }
@@ -156,15 +162,20 @@ _save_to(const trace_t *t, stream_t *stream)
         return;
 
     trace_flat_t *tf = (trace_flat_t *)t;
+    trace_index_t index;
+    trace_index_init(&index);
     for (trace_flat_node_t *node = tf->head; node; node = node->next) {
         record_t *record = node->record;
         // calculate total size of record
         size_t size = sizeof(record_t) + record->size;
+        trace_index_add(&index, record);
         // dump record
         size_t r = stream_write(stream, (const char *)record, size);
         if (r == 0)
             logger_fatalf("failed to dump record");
     }
+    if (!trace_index_seal(&index, stream))
+        logger_fatalf("failed to dump trace footer");
 }
 
 static record_t *
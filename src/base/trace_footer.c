@@ -0,0 +1,222 @@
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <lotto/base/trace_footer.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/fcntl.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+#include <lotto/sys/unistd.h>
+
+/*******************************************************************************
+ * writer
+ ******************************************************************************/
+
+void
+trace_index_init(trace_index_t *ix)
+{
+    sys_memset(ix, 0, sizeof(trace_index_t));
+    ix->stride             = 1;
+    ix->footer.exit_offset = TRACE_FOOTER_NO_EXIT;
+    ix->footer.magic       = TRACE_FOOTER_MAGIC;
+}
+
+void
+trace_index_add(trace_index_t *ix, const record_t *r)
+{
+    trace_footer_t *f = &ix->footer;
+
+    if (f->count % ix->stride == 0) {
+        if (f->index_len == TRACE_INDEX_CAPACITY) {
+            for (uint64_t i = 0; i < TRACE_INDEX_CAPACITY / 2; i++) {
+                ix->entries[i] = ix->entries[2 * i];
+            }
+            f->index_len = TRACE_INDEX_CAPACITY / 2;
+            ix->stride *= 2;
+        }
+        if (f->count % ix->stride == 0) {
+            ix->entries[f->index_len++] = (trace_index_entry_t){
+                .clk    = r->clk,
+                .offset = ix->offset,
+            };
+        }
+    }
+
+    if (f->count == 0 || r->clk < f->clk_min) {
+        f->clk_min = r->clk;
+    }
+    if (r->clk > f->clk_max) {
+        f->clk_max = r->clk;
+    }
+    if (r->kind == RECORD_EXIT) {
+        f->exit_offset = ix->offset;
+    }
+    f->last_offset = ix->offset;
+    f->count++;
+    ix->offset += sizeof(record_t) + r->size;
+}
+
+bool
+trace_index_seal(trace_index_t *ix, stream_t *stream)
+{
+    size_t index_size = ix->footer.index_len * sizeof(trace_index_entry_t);
+    record_t header   = {.kind = RECORD_NONE,
+                         .size = index_size + sizeof(trace_footer_t)};
+
+    if (stream_write(stream, (const char *)&header, sizeof(record_t)) == 0)
+        return false;
+    if (index_size > 0 &&
+        stream_write(stream, (const char *)ix->entries, index_size) == 0)
+        return false;
+    if (stream_write(stream, (const char *)&ix->footer,
+                     sizeof(trace_footer_t)) == 0)
+        return false;
+    return true;
+}
+
+/*******************************************************************************
+ * reader
+ ******************************************************************************/
+
+struct trace_reader_s {
+    int fd;
+    uint64_t pos;
+    uint64_t end; /* offset of the footer record */
+    trace_footer_t footer;
+    trace_index_entry_t *entries;
+};
+
+static bool
+_read_at(int fd, uint64_t offset, void *buf, size_t size)
+{
+    if (sys_lseek(fd, (off_t)offset, SEEK_SET) != (off_t)offset)
+        return false;
+    for (size_t done = 0; done < size;) {
+        ssize_t r = sys_read(fd, (char *)buf + done, size - done);
+        if (r <= 0)
+            return false;
+        done += (size_t)r;
+    }
+    return true;
+}
+
+static record_t *
+_record_at(trace_reader_t *tr, uint64_t offset)
+{
+    record_t header;
+    if (offset >= tr->end ||
+        !_read_at(tr->fd, offset, &header, sizeof(record_t)) ||
+        header.size > tr->end - offset - sizeof(record_t))
+        return NULL;
+
+    record_t *r = record_alloc(header.size);
+    ASSERT(r);
+    sys_memcpy(r, &header, sizeof(record_t));
+    r->next = NULL;
+    if (!_read_at(tr->fd, offset + sizeof(record_t), r->data, r->size)) {
+        sys_free(r);
+        return NULL;
+    }
+    return r;
+}
+
+trace_reader_t *
+trace_reader_open(const char *fn)
+{
+    int fd = sys_open(fn, O_RDONLY, 0);
+    if (fd == -1)
+        return NULL;
+
+    trace_reader_t *tr = sys_malloc(sizeof(trace_reader_t));
+    ASSERT(tr);
+    *tr = (trace_reader_t){.fd = fd};
+
+    off_t size = sys_lseek(fd, 0, SEEK_END);
+    if (size < (off_t)(sizeof(record_t) + sizeof(trace_footer_t)))
+        goto fail;
+
+    trace_footer_t *f = &tr->footer;
+    if (!_read_at(fd, size - sizeof(trace_footer_t), f,
+                  sizeof(trace_footer_t)) ||
+        f->magic != TRACE_FOOTER_MAGIC ||
+        f->index_len > TRACE_INDEX_CAPACITY)
+        goto fail;
+
+    size_t index_size = f->index_len * sizeof(trace_index_entry_t);
+    size_t tail_size  = sizeof(record_t) + index_size + sizeof(trace_footer_t);
+    if ((uint64_t)size < tail_size)
+        goto fail;
+    tr->end = (uint64_t)size - tail_size;
+
+    record_t header;
+    if (!_read_at(fd, tr->end, &header, sizeof(record_t)) ||
+        header.kind != RECORD_NONE ||
+        header.size != index_size + sizeof(trace_footer_t) ||
+        (f->count > 0 && f->last_offset >= tr->end))
+        goto fail;
+
+    if (index_size > 0) {
+        tr->entries = sys_malloc(index_size);
+        ASSERT(tr->entries);
+        if (!_read_at(fd, tr->end + sizeof(record_t), tr->entries,
+                      index_size))
+            goto fail;
+    }
+    return tr;
+
+fail:
+    trace_reader_close(tr);
+    return NULL;
+}
+
+const trace_footer_t *
+trace_reader_footer(const trace_reader_t *tr)
+{
+    return &tr->footer;
+}
+
+record_t *
+trace_reader_last(trace_reader_t *tr)
+{
+    if (tr->footer.count == 0)
+        return NULL;
+    return _record_at(tr, tr->footer.last_offset);
+}
+
+void
+trace_reader_seek(trace_reader_t *tr, clk_t clk)
+{
+    /* first entry with entries[i].clk >= clk */
+    uint64_t lo = 0;
+    uint64_t hi = tr->footer.index_len;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (tr->entries[mid].clk < clk) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    tr->pos = lo == 0 ? 0 : tr->entries[lo - 1].offset;
+}
+
+record_t *
+trace_reader_next(trace_reader_t *tr)
+{
+    record_t *r = _record_at(tr, tr->pos);
+    if (r != NULL)
+        tr->pos += sizeof(record_t) + r->size;
+    return r;
+}
+
+void
+trace_reader_close(trace_reader_t *tr)
+{
+    if (tr == NULL)
+        return;
+    sys_close(tr->fd);
+    sys_free(tr->entries);
+    sys_free(tr);
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * log
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <dice/pubsub.h>
+#include <lotto/driver/args.h>
+#include <lotto/driver/flagmgr.h>
+#include <lotto/driver/subcmd.h>
+#include <lotto/sys/assert.h>
+#include <lotto/sys/logger_bin.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/string.h>
+
+typedef struct {
+    logger_bin_event_t ev;
+    uint64_t ring;
+} decoded_t;
+
+static int
+_decoded_cmp(const void *a, const void *b)
+{
+    const decoded_t *x = a;
+    const decoded_t *y = b;
+    if (x->ev.ts != y->ev.ts)
+        return x->ev.ts < y->ev.ts ? -1 : 1;
+    return x->ring < y->ring ? -1 : x->ring > y->ring ? 1 : 0;
+}
+
+static int
+_log_decode(const char *fn)
+{
+    FILE *fp = sys_fopen(fn, "r");
+    if (fp == NULL) {
+        sys_fprintf(stderr, "error: could not open %s\n", fn);
+        return 1;
+    }
+
+    logger_bin_header_t hdr;
+    if (sys_fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        hdr.magic != LOGGER_BIN_MAGIC || hdr.version != LOGGER_BIN_VERSION ||
+        hdr.event_size != sizeof(logger_bin_event_t)) {
+        sys_fprintf(stderr, "error: %s is not a binary log\n", fn);
+        sys_fclose(fp);
+        return 1;
+    }
+
+    decoded_t *evs = NULL;
+    size_t nevs    = 0;
+    size_t cap     = 0;
+    uint64_t drops = 0;
+    logger_bin_chunk_t chunk;
+    while (sys_fread(&chunk, sizeof(chunk), 1, fp) == 1) {
+        drops += chunk.dropped;
+        if (nevs + chunk.count > cap) {
+            cap = (nevs + chunk.count) * 2;
+            evs = sys_realloc(evs, cap * sizeof(decoded_t));
+            ASSERT(evs);
+        }
+        for (uint64_t i = 0; i < chunk.count; i++, nevs++) {
+            evs[nevs].ring = chunk.ring;
+            if (sys_fread(&evs[nevs].ev, sizeof(logger_bin_event_t), 1, fp) !=
+                1) {
+                sys_fprintf(stderr, "warning: truncated binary log\n");
+                goto done;
+            }
+        }
+    }
+
+done:
+    sys_fclose(fp);
+    qsort(evs, nevs, sizeof(decoded_t), _decoded_cmp);
+
+    uint64_t t0 = nevs > 0 ? evs[0].ev.ts : 0;
+    for (size_t i = 0; i < nevs; i++) {
+        const logger_bin_event_t *e = &evs[i].ev;
+        sys_fprintf(stdout,
+                    "[+%12.6fms ring:%lu t:%lu clk:%lu pc:0x%lx] %-8s "
+                    "type:%s arg:%lu\n",
+                    (double)(e->ts - t0) / 1e6, evs[i].ring, e->tid, e->clk,
+                    e->pc, logger_bin_kind_str(e->kind),
+                    e->type ? ps_type_str(e->type) : "-", e->arg);
+    }
+    if (drops > 0)
+        sys_fprintf(stdout, "[lotto] %lu older events dropped\n", drops);
+
+    sys_free(evs);
+    return 0;
+}
+
+int
+log_cmd(args_t *args, flags_t *flags)
+{
+    (void)flags;
+    int i = 0;
+    if (i < args->argc && sys_strcmp(args->argv[i], "log") == 0)
+        i++;
+
+    if (args->argc - i == 2 && sys_strcmp(args->argv[i], "decode") == 0)
+        return _log_decode(args->argv[i + 1]);
+
+    sys_fprintf(stderr, "usage: lotto log decode <file>\n");
+    return 1;
+}
+
+ON_DRIVER_REGISTER_COMMANDS({
+    flag_t sel[] = {0};
+    subcmd_register(log_cmd, "log", "decode <file>",
+                    "Decode a binary log written with --log-binary", false,
+                    sel, flags_default, SUBCMD_GROUP_OTHER);
+})
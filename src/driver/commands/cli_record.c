@@ -20,6 +20,7 @@ ON_DRIVER_REGISTER_COMMANDS({
                     flag_before_run(),
                     flag_after_run(),
                     flag_logger_file(),
+                    flag_logger_binary(),
                     0};
     subcmd_register(record, "record", "[--] <command line>",
                     "Record a single execution of a program", true, sel,
@@ -31,6 +31,8 @@ replay(args_t *args, flags_t *flags)
 
     setenv("LOTTO_LOGGER_FILE", flags_get_sval(flags, flag_logger_file()),
            true);
+    setenv("LOTTO_LOGGER_BINARY", flags_get_sval(flags, flag_logger_binary()),
+           true);
 
     sys_fprintf(stdout, "trace file: %s\n",
                 flags_get_sval(flags, flag_input()));
@@ -114,6 +116,7 @@ ON_DRIVER_REGISTER_COMMANDS({
                     flag_before_run(),
                     flag_after_run(),
                     flag_logger_file(),
+                    flag_logger_binary(),
                     0};
     subcmd_register(replay, "replay", "", "Replay a trace", false, sel,
                     _default_flags, SUBCMD_GROUP_TRACE);
@@ -13,10 +13,11 @@ run(args_t *args, flags_t *flags)
 }
 
 ON_DRIVER_REGISTER_COMMANDS({
-    flag_t sel[] = {flag_verbose(),    flag_temporary_directory(),
-                    flag_no_preload(), flag_before_run(),
-                    flag_after_run(),  flag_logger_file(),
-                    flag_input(),      0};
+    flag_t sel[] = {flag_verbose(),      flag_temporary_directory(),
+                    flag_no_preload(),   flag_before_run(),
+                    flag_after_run(),    flag_logger_file(),
+                    flag_logger_binary(), flag_input(),
+                    0};
     subcmd_register(run, "run", "[--] <command line>",
                     "Run a program once without recording a trace",
                     true, sel, run_default_flags, SUBCMD_GROUP_RUN);
@@ -1,5 +1,7 @@
 #include <errno.h>
+#include <fcntl.h>
 #include <spawn.h>
+#include <sys/syscall.h>
 #include <termios.h>
 
 #include <lotto/driver/exec.h>
@@ -74,7 +76,9 @@ _handle_sigterm(int sig, siginfo_t *si, void *arg)
     sys_exit(1);
 }
 
-#define BUFFER_SIZE 1024
+#define BUFFER_SIZE (64 * 1024)
+/* Without a pidfd, child exit is noticed by checking periodically. */
+#define EXIT_CHECK_MS 100
 
 typedef struct {
     int wstatus;
@@ -82,6 +86,71 @@ typedef struct {
     bool child_missing;
 } child_wait_state_t;
 
+/* Output forwarding state of the current execute(). Data moves from the
+ * pipes to the driver's stdout/stderr with splice() unless the destination
+ * does not support it or the tail is being kept, which needs a copy. */
+static struct {
+    bool splice_ok[2];
+    char *tail;
+    size_t tail_cap;
+    size_t tail_len;
+    size_t tail_head;
+} _fwd;
+
+static char _fwd_buffer[BUFFER_SIZE];
+
+static void
+tail_append_(const char *data, size_t len)
+{
+    if (len >= _fwd.tail_cap) {
+        sys_memcpy(_fwd.tail, data + len - _fwd.tail_cap, _fwd.tail_cap);
+        _fwd.tail_head = 0;
+        _fwd.tail_len  = _fwd.tail_cap;
+        return;
+    }
+    size_t end   = (_fwd.tail_head + _fwd.tail_len) % _fwd.tail_cap;
+    size_t first = _fwd.tail_cap - end < len ? _fwd.tail_cap - end : len;
+    sys_memcpy(_fwd.tail + end, data, first);
+    sys_memcpy(_fwd.tail, data + first, len - first);
+    _fwd.tail_len += len;
+    if (_fwd.tail_len > _fwd.tail_cap) {
+        _fwd.tail_head = (_fwd.tail_head + _fwd.tail_len - _fwd.tail_cap) %
+                         _fwd.tail_cap;
+        _fwd.tail_len  = _fwd.tail_cap;
+    }
+}
+
+static void
+write_all_(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = sys_write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            /* the destination went away, drop the output */
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/* splice() also fails with EAGAIN when the destination pipe is full. Returns
+ * true if `fd` was full and has been waited for. */
+static bool
+await_writable_(int fd)
+{
+    struct pollfd pfd    = {.fd = fd, .events = POLLOUT};
+    struct timespec zero = {0};
+    if (sys_ppoll(&pfd, 1, &zero, NULL) == 1) {
+        return false;
+    }
+    sys_ppoll(&pfd, 1, NULL, NULL);
+    return true;
+}
+
 static bool
 pipe_should_close_(short revents)
 {
@@ -105,26 +174,37 @@ record_child_exit_(pid_t pid, child_wait_state_t *state)
     }
 }
 
+/* Forwards everything available in the (non-blocking) pipe. Returns true once
+ * the pipe reached EOF. */
 static bool
-consume_pipe_data_(int fd, short revents, bool *data_read)
+consume_pipe_data_(int fd)
 {
-    char buffer[BUFFER_SIZE];
-    bool drain_to_eof = revents & POLLHUP;
-    int out_fd        = fd == p_out[0] ? STDOUT_FILENO : STDERR_FILENO;
-
-    if (!(revents & (POLLIN | POLLHUP))) {
-        return false;
-    }
+    int idx    = fd == p_out[0] ? 0 : 1;
+    int out_fd = idx == 0 ? STDOUT_FILENO : STDERR_FILENO;
 
     while (1) {
-        ssize_t bytes_read = sys_read(fd, buffer, BUFFER_SIZE - 1);
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            sys_dprintf(out_fd, "%s", buffer);
-            *data_read = true;
-            if (!drain_to_eof) {
-                return false;
+        ssize_t bytes_read;
+        if (_fwd.splice_ok[idx] && _fwd.tail_cap == 0) {
+            bytes_read = splice(fd, NULL, out_fd, NULL, BUFFER_SIZE,
+                                SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (bytes_read < 0 && errno == EAGAIN && await_writable_(out_fd)) {
+                continue;
+            }
+            if (bytes_read < 0 && errno != EINTR && errno != EAGAIN) {
+                /* e.g., a terminal or a file opened with O_APPEND */
+                _fwd.splice_ok[idx] = false;
+                continue;
             }
+        } else {
+            bytes_read = sys_read(fd, _fwd_buffer, BUFFER_SIZE);
+            if (bytes_read > 0) {
+                write_all_(out_fd, _fwd_buffer, (size_t)bytes_read);
+                if (_fwd.tail_cap > 0) {
+                    tail_append_(_fwd_buffer, (size_t)bytes_read);
+                }
+            }
+        }
+        if (bytes_read > 0) {
             continue;
         }
         if (bytes_read == 0) {
@@ -145,16 +225,44 @@ consume_pipe_data_(int fd, short revents, bool *data_read)
     }
 }
 
+static int
+open_pidfd_(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+/* Blocks until a pipe has data or the child exits; the pidfd becomes readable
+ * when the child terminates. */
 static void
 read_pipes(pid_t pid, child_wait_state_t *state)
 {
-    nfds_t nfds             = 2;
-    struct timespec timeout = {.tv_sec = 0, .tv_nsec = 10000};
-    struct pollfd pfds[2]   = {{.fd = p_out[0], .events = POLLIN},
-                               {.fd = p_err[0], .events = POLLIN}};
+    int pipes[2]    = {p_out[0], p_err[0]};
+    nfds_t npipes   = 2;
+    int pidfd       = open_pidfd_(pid);
+    struct timespec exit_check = {.tv_sec  = 0,
+                                  .tv_nsec = EXIT_CHECK_MS * 1000000L};
+
+    for (nfds_t i = 0; i < npipes; i++) {
+        fcntl(pipes[i], F_SETFL, fcntl(pipes[i], F_GETFL) | O_NONBLOCK);
+    }
+
+    while (npipes > 0) {
+        struct pollfd pfds[3];
+        nfds_t nfds = 0;
+        for (; nfds < npipes; nfds++) {
+            pfds[nfds] = (struct pollfd){.fd = pipes[nfds], .events = POLLIN};
+        }
+        if (pidfd >= 0) {
+            pfds[nfds++] = (struct pollfd){.fd = pidfd, .events = POLLIN};
+        }
 
-    while (nfds > 0) {
-        int ret_ppoll = sys_ppoll(pfds, nfds, &timeout, NULL);
+        int ret_ppoll =
+            sys_ppoll(pfds, nfds, pidfd >= 0 ? NULL : &exit_check, NULL);
         if (ret_ppoll == -1) {
             if (errno == EINTR) {
                 continue;
@@ -172,38 +280,34 @@ read_pipes(pid_t pid, child_wait_state_t *state)
         }
 
         record_child_exit_(pid, state);
+        bool exited = state->have_status || state->child_missing;
 
-        bool data_read     = false;
         bool close_pipe[2] = {false, false};
-        for (uint64_t i = 0; i < nfds; i++) {
+        for (nfds_t i = 0; i < npipes; i++) {
             short revents = pfds[i].revents;
-            if (!(revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL))) {
-                continue;
-            }
-
-            if (revents & (POLLIN | POLLHUP)) {
-                close_pipe[i] =
-                    consume_pipe_data_(pfds[i].fd, revents, &data_read);
-                continue;
-            }
-
-            if (pipe_should_close_(revents)) {
+            if (exited || (revents & (POLLIN | POLLHUP))) {
+                /* after exit, drain what the child left in the pipe */
+                close_pipe[i] = consume_pipe_data_(pipes[i]);
+            } else if (pipe_should_close_(revents)) {
                 close_pipe[i] = true;
             }
         }
 
-        for (int64_t i = CAST_TYPE(int64_t, nfds) - 1; i >= 0; i--) {
-            if (!close_pipe[i]) {
-                continue;
+        for (int64_t i = CAST_TYPE(int64_t, npipes) - 1; i >= 0; i--) {
+            if (close_pipe[i]) {
+                pipes[i] = pipes[--npipes];
             }
-            pfds[i] = pfds[--nfds];
         }
 
-        if ((state->have_status || state->child_missing) && !data_read &&
-            ret_ppoll == 0) {
+        /* descendants may keep the pipes open, do not wait for them */
+        if (exited) {
             break;
         }
     }
+
+    if (pidfd >= 0) {
+        sys_close(pidfd);
+    }
 }
 
 static int
@@ -334,6 +438,11 @@ execute(const args_t *args, const flags_t *flags, bool config)
     sys_posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
     sys_posix_spawnattr_setsigdefault(&attr, &sigdefset);
 
+    _fwd.splice_ok[0] = true;
+    _fwd.splice_ok[1] = true;
+    _fwd.tail_len     = 0;
+    _fwd.tail_head    = 0;
+
     posix_spawn_file_actions_t action;
     int stdin_fd = -1;
     if (sys_pipe(p_out) || sys_pipe(p_err))
@@ -414,6 +523,30 @@ execute_set_stdin_devnull(exec_stdin_devnull_f *hook)
     _exec_stdin_devnull = hook;
 }
 
+void
+execute_set_output_tail(size_t len)
+{
+    sys_free(_fwd.tail);
+    _fwd.tail      = len > 0 ? sys_malloc(len) : NULL;
+    _fwd.tail_cap  = len;
+    _fwd.tail_len  = 0;
+    _fwd.tail_head = 0;
+}
+
+size_t
+execute_output_tail(char *buf, size_t cap)
+{
+    size_t len = _fwd.tail_len < cap ? _fwd.tail_len : cap;
+    if (len == 0) {
+        return 0;
+    }
+    size_t start = (_fwd.tail_head + _fwd.tail_len - len) % _fwd.tail_cap;
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = _fwd.tail[(start + i) % _fwd.tail_cap];
+    }
+    return len;
+}
+
 void
 execute_set_replay_args_resolver(exec_replay_args_resolver_f *resolver)
 {
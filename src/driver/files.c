@@ -1,4 +1,9 @@
+#include <inttypes.h>
 #include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <lotto/driver/files.h>
 #include <lotto/sys/assert.h>
@@ -22,6 +27,79 @@ driver_try_create_dir(const char *dir)
     return false;
 }
 
+/* FNV-1a over the blob. Blobs are static, so hashes are remembered by content
+ * address and each blob is hashed once per process. */
+#define HASH_MEMO_SIZE 16
+
+static struct {
+    const unsigned char *content;
+    unsigned int len;
+    uint64_t hash;
+} _hash_memo[HASH_MEMO_SIZE];
+
+static uint64_t
+driver_file_hash(const unsigned char *content, unsigned int len)
+{
+    size_t slot = ((uintptr_t)content >> 4) % HASH_MEMO_SIZE;
+    if (_hash_memo[slot].content == content && _hash_memo[slot].len == len) {
+        return _hash_memo[slot].hash;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned int i = 0; i < len; i++) {
+        hash = (hash ^ content[i]) * 0x100000001b3ULL;
+    }
+    _hash_memo[slot].content = content;
+    _hash_memo[slot].len     = len;
+    _hash_memo[slot].hash    = hash;
+    return hash;
+}
+
+/* The stamp `.<path>.stamp` records the hash and length of the blob last
+ * extracted to `<path>`. */
+static bool
+driver_file_is_current(const char *dir, const driver_file_t *file,
+                       const char *stamp)
+{
+    char filename[PATH_MAX];
+    sys_sprintf(filename, "%s/%s", dir, file->path);
+    struct stat st = {0};
+    if (stat(filename, &st) != 0 || st.st_size != (off_t)file->len) {
+        return false;
+    }
+
+    char stampname[PATH_MAX];
+    char content[64] = {0};
+    sys_sprintf(stampname, "%s/.%s.stamp", dir, file->path);
+    FILE *fp = sys_fopen(stampname, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    size_t n = sys_fread(content, 1, sizeof(content) - 1, fp);
+    sys_fclose(fp);
+    return n == strlen(stamp) && strcmp(content, stamp) == 0;
+}
+
+/* Writes `content` next to `filename` and renames it into place, so that
+ * processes which still map the previous file keep a consistent copy. */
+static bool
+driver_write_file(const char *filename, const void *content, size_t len)
+{
+    char tmpname[PATH_MAX];
+    sys_sprintf(tmpname, "%s.tmp.%d", filename, (int)getpid());
+    FILE *fp = sys_fopen(tmpname, "w");
+    if (fp == NULL) {
+        return false;
+    }
+    bool ok = sys_fwrite(content, sizeof(unsigned char), len, fp) == len;
+    ok &= sys_fclose(fp) == 0;
+    ok = ok && rename(tmpname, filename) == 0;
+    if (!ok) {
+        remove(tmpname);
+    }
+    return ok;
+}
+
 bool
 driver_try_dump_files(const char *dir, const driver_file_t files[])
 {
@@ -32,18 +110,20 @@ driver_try_dump_files(const char *dir, const driver_file_t files[])
     }
     for (int i = 0; files[i].path; i++) {
         ASSERT(files[i].content);
+        char stamp[64];
+        sys_sprintf(stamp, "%016" PRIx64 " %u\n",
+                    driver_file_hash(files[i].content, files[i].len),
+                    files[i].len);
+        if (driver_file_is_current(dir, &files[i], stamp)) {
+            continue;
+        }
+
         char filename[PATH_MAX];
+        char stampname[PATH_MAX];
         sys_sprintf(filename, "%s/%s", dir, files[i].path);
-        FILE *fp = sys_fopen(filename, "w");
-        if (fp == NULL) {
-            return false;
-        }
-        if (sys_fwrite(files[i].content, sizeof(unsigned char), files[i].len,
-                       fp) != files[i].len) {
-            sys_fclose(fp);
-            return false;
-        }
-        if (sys_fclose(fp) != 0) {
+        sys_sprintf(stampname, "%s/.%s.stamp", dir, files[i].path);
+        if (!driver_write_file(filename, files[i].content, files[i].len) ||
+            !driver_write_file(stampname, stamp, strlen(stamp))) {
             return false;
         }
     }
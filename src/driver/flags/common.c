@@ -11,6 +11,8 @@ DECLARE_FLAG_NO_PRELOAD;
 DECLARE_FLAG_BEFORE_RUN;
 DECLARE_FLAG_AFTER_RUN;
 DECLARE_FLAG_LOGGER_FILE;
+DECLARE_FLAG_LOGGER_BINARY;
+DECLARE_FLAG_JOBS;
 
 FLAG_GETTER(input, INPUT)
 FLAG_GETTER(output, OUTPUT)
@@ -22,3 +24,5 @@ FLAG_GETTER(no_preload, NO_PRELOAD)
 FLAG_GETTER(before_run, BEFORE_RUN)
 FLAG_GETTER(after_run, AFTER_RUN)
 FLAG_GETTER(logger_file, LOGGER_FILE)
+FLAG_GETTER(logger_binary, LOGGER_BINARY)
+FLAG_GETTER(jobs, JOBS)
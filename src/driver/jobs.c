@@ -0,0 +1,299 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <lotto/base/cpuset.h>
+#include <lotto/driver/exec.h>
+#include <lotto/driver/flags/prng.h>
+#include <lotto/driver/jobs.h>
+#include <lotto/driver/utils.h>
+#include <lotto/sys/stdio.h>
+#include <lotto/sys/string.h>
+#include <lotto/sys/unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_JOBS        256
+#define JOB_OUTPUT_TAIL 4096
+
+static pid_t _workers[MAX_JOBS];
+static int _results[MAX_JOBS];
+static uint64_t _nworkers;
+
+/* Workers lead their own process groups, so a signal to the group also
+ * reaches the programs they started. */
+static void
+_signal_workers(int sig)
+{
+    for (uint64_t k = 0; k < _nworkers; k++) {
+        if (_workers[k] > 0) {
+            kill(-_workers[k], sig);
+        }
+    }
+}
+
+/* Gives each job a share of the physical cores available to the driver, or a
+ * single CPU round-robin when there are more jobs than cores. */
+static void
+_pin_job(uint64_t job, uint64_t jobs)
+{
+    cpu_set_t avail, mine;
+    if (sched_getaffinity(0, sizeof(avail), &avail) != 0) {
+        return;
+    }
+    cpu_order_t order[CPU_SETSIZE];
+    size_t n = cpuset_spread(&avail, cpuset_core, order);
+    if (n == 0) {
+        return;
+    }
+    cpuset_job(order, n, job, jobs, &mine);
+    (void)sched_setaffinity(0, sizeof(mine), &mine);
+}
+
+static void
+_job_output(char *path, const char *dir, const char *output)
+{
+    const char *base = strrchr(output, '/');
+    sys_snprintf(path, PATH_MAX, "%s/%s", dir, base ? base + 1 : output);
+}
+
+static void
+_job_directory(char *dir, const char *temporary_directory, uint64_t job)
+{
+    sys_snprintf(dir, PATH_MAX, "%s/job-%lu", temporary_directory, job);
+}
+
+/* Prints the output tail of a failing job with a single write, so that it is
+ * not interleaved with the output of other jobs. */
+static void
+_print_tail(uint64_t job)
+{
+    char buf[JOB_OUTPUT_TAIL + 64];
+    int hlen = sys_snprintf(buf, sizeof(buf) - JOB_OUTPUT_TAIL,
+                            "[lotto] job %lu output tail:\n", job);
+    size_t len = (size_t)hlen;
+    len += execute_output_tail(buf + len, JOB_OUTPUT_TAIL);
+    buf[len++] = '\n';
+
+    fflush(stdout);
+    const char *data = buf;
+    while (len > 0) {
+        ssize_t n = sys_write(STDOUT_FILENO, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/* Runs `loop` as job `job`. With `split`, the job gets `rounds` rounds on its
+ * own stream of the generator, otherwise it keeps the rounds and stream of
+ * `flags`. */
+static int
+_run_job(args_t *args, flags_t *flags, run_job_f *loop, uint64_t job,
+         uint64_t jobs, bool split, uint64_t rounds)
+{
+    char dir[PATH_MAX];
+    char output[PATH_MAX];
+
+    _pin_job(job, jobs);
+
+    _job_directory(dir, flags_get_sval(flags, flag_temporary_directory()),
+                   job);
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        sys_fprintf(stderr, "error: could not create job directory '%s': %s\n",
+                    dir, strerror(errno));
+        return 1;
+    }
+    _job_output(output, dir, flags_get_sval(flags, flag_output()));
+
+    if (split) {
+        /* workers keep the seeds of the command, the stream makes the draws
+         * of every round disjoint from those of other workers */
+        uint64_t stream = flags_get_uval(flags, flag_prng_stream()) + job;
+        flags_set_by_opt(flags, flag_prng_stream(), uval(stream));
+        flags_set_by_opt(flags, flag_rounds(), uval(rounds));
+    }
+    flags_set_by_opt(flags, flag_temporary_directory(), sval(dir));
+    flags_set_by_opt(flags, flag_output(), sval(output));
+
+    /* the output of concurrent jobs interleaves, repeat the end of the
+     * failing round in one piece */
+    execute_set_output_tail(JOB_OUTPUT_TAIL);
+    int err = loop(args, flags, job);
+    if (err != 0) {
+        _print_tail(job);
+    }
+    return err;
+}
+
+/* Sends the error of a worker to the driver; an exit status only keeps its
+ * low 8 bits. */
+static void
+_report(int fd, int err)
+{
+    while (sys_write(fd, &err, sizeof(err)) < 0 && errno == EINTR) {}
+    sys_close(fd);
+}
+
+/* Receives the error of a reaped worker. A worker that did not report one
+ * was killed or exited on its own, so its status stands in. */
+static int
+_result(int fd, int wstatus)
+{
+    int err;
+    ssize_t n;
+    while ((n = sys_read(fd, &err, sizeof(err))) < 0 && errno == EINTR) {}
+    sys_close(fd);
+    if (n == (ssize_t)sizeof(err)) {
+        return err;
+    }
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+}
+
+void
+collect_job_output(const flags_t *flags, uint64_t job)
+{
+    char dir[PATH_MAX];
+    char job_output[PATH_MAX];
+    const char *output = flags_get_sval(flags, flag_output());
+
+    _job_directory(dir, flags_get_sval(flags, flag_temporary_directory()),
+                   job);
+    _job_output(job_output, dir, output);
+    if (access(job_output, F_OK) != 0) {
+        /* already collected */
+        return;
+    }
+    if (rename(job_output, output) != 0 && cp_clone(job_output, output) != 0) {
+        sys_fprintf(stderr, "error: could not move '%s' to '%s': %s\n",
+                    job_output, output, strerror(errno));
+    }
+}
+
+static int
+_run_jobs(args_t *args, flags_t *flags, run_job_f *loop, uint64_t jobs,
+          bool split)
+{
+    uint64_t rounds = split ? flags_get_uval(flags, flag_rounds()) : jobs;
+
+    if (jobs > rounds) {
+        jobs = rounds;
+    }
+    if (jobs > MAX_JOBS) {
+        sys_fprintf(stderr, "warning: limiting --jobs to %d\n", MAX_JOBS);
+        jobs = MAX_JOBS;
+    }
+    if (jobs <= 1) {
+        return loop(args, flags, 0);
+    }
+
+    struct sigaction act = {.sa_handler = _signal_workers};
+    struct sigaction int_old, term_old;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGINT, &act, &int_old);
+    sigaction(SIGTERM, &act, &term_old);
+
+    int err    = 0;
+    int failed = -1;
+    _nworkers  = 0;
+    for (uint64_t k = 0; k < jobs; k++) {
+        uint64_t extra = rounds % jobs;
+        uint64_t share = rounds / jobs + (k < extra ? 1 : 0);
+        int fds[2];
+        pid_t pid = -1;
+        if (pipe2(fds, O_CLOEXEC) == 0 && (pid = fork()) < 0) {
+            sys_close(fds[0]);
+            sys_close(fds[1]);
+        }
+        if (pid == 0) {
+            sys_close(fds[0]);
+            setpgid(0, 0);
+            sigaction(SIGINT, &int_old, NULL);
+            sigaction(SIGTERM, &term_old, NULL);
+            int ret = _run_job(args, flags, loop, k, jobs, split, share);
+            _report(fds[1], ret);
+            _exit(ret != 0);
+        }
+        if (pid < 0) {
+            sys_fprintf(stderr, "error: could not start job %lu: %s\n", k,
+                        strerror(errno));
+            err = 1;
+            _signal_workers(SIGTERM);
+            break;
+        }
+        sys_close(fds[1]);
+        setpgid(pid, pid);
+        _results[_nworkers]   = fds[0];
+        _workers[_nworkers++] = pid;
+    }
+
+    int last = -1;
+    for (uint64_t live = _nworkers; live > 0;) {
+        int wstatus;
+        pid_t pid = waitpid(-1, &wstatus, 0);
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        int k = -1;
+        for (uint64_t i = 0; i < _nworkers; i++) {
+            if (_workers[i] == pid) {
+                k = (int)i;
+            }
+        }
+        if (k < 0) {
+            continue;
+        }
+        _workers[k] = 0;
+        live--;
+
+        int ret = _result(_results[k], wstatus);
+        if (failed >= 0 || err != 0) {
+            continue;
+        }
+        last = k;
+        if (ret != 0) {
+            failed = k;
+            err    = ret;
+            _signal_workers(SIGTERM);
+        }
+    }
+
+    sigaction(SIGINT, &int_old, NULL);
+    sigaction(SIGTERM, &term_old, NULL);
+    _nworkers = 0;
+
+    if (failed >= 0) {
+        sys_fprintf(stdout, "[lotto] job %d failed, keeping its trace\n",
+                    failed);
+        collect_job_output(flags, (uint64_t)failed);
+    } else if (last >= 0) {
+        collect_job_output(flags, (uint64_t)last);
+    }
+    return err;
+}
+
+int
+run_jobs(args_t *args, flags_t *flags, run_job_f *loop)
+{
+    return _run_jobs(args, flags, loop, flags_get_uval(flags, flag_jobs()),
+                     true);
+}
+
+int
+run_workers(args_t *args, flags_t *flags, run_job_f *loop, uint64_t jobs)
+{
+    return _run_jobs(args, flags, loop, jobs, false);
+}
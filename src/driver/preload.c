@@ -100,8 +100,16 @@ _symlink_lib(const char *dir, const char *lib, const char *links[])
 
     for (size_t i = 0; links[i]; i++) {
         char linkname[PATH_MAX];
+        char target[PATH_MAX];
         sys_sprintf(linkname, "%s/%s", dir, links[i]);
-        if (stat(linkname, &st) != -1) {
+        ssize_t n = readlink(linkname, target, sizeof(target) - 1);
+        if (n >= 0) {
+            target[n] = '\0';
+            if (strcmp(target, filename) == 0) {
+                continue;
+            }
+        }
+        if (lstat(linkname, &st) != -1) {
             /* delete symlink */
             ENSURE(remove(linkname) == 0 &&
                    "could not remove symlink, try specifying a different "
@@ -400,11 +408,22 @@ _ld_preload_fix_dbg(bool is_dbg)
     setenv("LD_PRELOAD", result, true);
 }
 
-void
-preload(const char *dir, uint64_t verbose, bool do_preload_plotto,
-        const char *memmgr_chain_runtime, const char *memmgr_chain_user)
+/* Directory and verbosity of the last library extraction. Drivers running
+ * several rounds call preload() with the same arguments every round, so the
+ * extraction and LD_LIBRARY_PATH set-up happen once per process. */
+static struct {
+    char dir[PATH_MAX];
+    uint64_t verbose;
+    bool ready;
+} _prepared;
+
+static void
+_prepare_libs(const char *dir, uint64_t verbose)
 {
-    const char *cli_preload = getenv(LOTTO_CLI_PRELOAD);
+    if (_prepared.ready && _prepared.verbose == verbose &&
+        strcmp(_prepared.dir, dir) == 0) {
+        return;
+    }
 
     /* make libraries available */
     // clang-format off
@@ -426,8 +445,24 @@ preload(const char *dir, uint64_t verbose, bool do_preload_plotto,
 
     _symlink_lib(dir, LIBTSANO,
                  (const char *[]){LIBTSAN0, LIBTSAN2, LIBCLANG_RT_TSAN, NULL});
-    /* preload libraries */
 
+    /* prepending once keeps LD_LIBRARY_PATH from growing every round */
+    _set_libpath_env(dir);
+
+    sys_snprintf(_prepared.dir, sizeof(_prepared.dir), "%s", dir);
+    _prepared.verbose = verbose;
+    _prepared.ready   = true;
+}
+
+void
+preload(const char *dir, uint64_t verbose, bool do_preload_plotto,
+        const char *memmgr_chain_runtime, const char *memmgr_chain_user)
+{
+    const char *cli_preload = getenv(LOTTO_CLI_PRELOAD);
+
+    _prepare_libs(dir, verbose);
+
+    /* preload libraries */
     const char *logger_level = verbose >= 2 ? "debug" :
                                verbose >= 1 ? "info" :
                                               "error";
@@ -436,8 +471,6 @@ preload(const char *dir, uint64_t verbose, bool do_preload_plotto,
                                 {NULL}};
     envvar_set(vars, true);
 
-    _set_libpath_env(dir);
-
     bool replayed = exec_info_replay_envvars(verbose);
     bool is_dbg   = verbose > 0;
     if (replayed && _ld_preload_is_dbg() == is_dbg) {
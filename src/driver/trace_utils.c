@@ -10,6 +10,7 @@
 #include <lotto/base/trace_chunked.h>
 #include <lotto/base/trace_file.h>
 #include <lotto/base/trace_flat.h>
+#include <lotto/base/trace_footer.h>
 #include <lotto/driver/exec_info.h>
 #include <lotto/driver/flagmgr.h>
 #include <lotto/driver/record.h>
@@ -103,15 +104,47 @@ cli_trace_save(const trace_t *rec, const char *fn)
     }
 }
 
+trace_reader_t *
+cli_trace_reader(const char *fn)
+{
+    char *var = sys_getenv("LOTTO_RECORDER_TYPE");
+    if (!var) {
+        fn  = detect_record_type(fn);
+        var = sys_getenv("LOTTO_RECORDER_TYPE");
+        ASSERT(var);
+    }
+    // chunked traces have no footer
+    if (sys_strcmp(var, "multi") == 0)
+        return NULL;
+    return trace_reader_open(fn);
+}
+
+record_t *
+cli_trace_load_last(const char *fn)
+{
+    trace_reader_t *tr = cli_trace_reader(fn);
+    if (tr != NULL) {
+        record_t *r = trace_reader_last(tr);
+        trace_reader_close(tr);
+        return r;
+    }
+
+    // no footer, scan the trace
+    trace_t *rec = cli_trace_load(fn);
+    record_t *r  = trace_last(rec);
+    r            = r ? record_clone(r) : NULL;
+    trace_destroy(rec);
+    return r;
+}
+
 uint64_t
 cli_trace_last_clk(const char *name)
 {
-    trace_t *rec = cli_trace_load(name);
-    record_t *r  = trace_last(rec);
+    record_t *r = cli_trace_load_last(name);
     if (r == NULL)
         return 0;
     uint64_t result = r->clk;
-    trace_destroy(rec);
+    sys_free(r);
     return result;
 }
 
@@ -22,9 +22,12 @@
 #include <lotto/sys/assert.h>
 #include <lotto/sys/now.h>
 #include <lotto/sys/stdio.h>
+#include <lotto/sys/stdlib.h>
 #include <lotto/sys/stream_chunked_file.h>
 #include <lotto/sys/stream_file.h>
 #include <lotto/sys/string.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 
@@ -92,6 +95,52 @@ out_error:
     return -1;
 }
 
+int
+cp_clone(const char *from, const char *to)
+{
+    struct stat st;
+    int fd_to, fd_from;
+    off_t left = -1;
+
+    fd_from = open(from, O_RDONLY);
+    if (fd_from < 0)
+        return -1;
+
+    fd_to = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_to < 0) {
+        int saved_errno = errno;
+        close(fd_from);
+        errno = saved_errno;
+        return -1;
+    }
+
+#ifdef FICLONE
+    /* share all extents with the source on reflink-capable filesystems */
+    if (ioctl(fd_to, FICLONE, fd_from) == 0)
+        left = 0;
+#endif
+
+    /* let the kernel copy (or share) the data without a user-space buffer */
+    if (left != 0 && fstat(fd_from, &st) == 0) {
+        left = st.st_size;
+        while (left > 0) {
+            ssize_t n = copy_file_range(fd_from, NULL, fd_to, NULL,
+                                        (size_t)left, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            left -= n;
+        }
+    }
+
+    close(fd_from);
+    if (close(fd_to) < 0)
+        left = -1;
+
+    return left == 0 ? 0 : cp(from, to);
+}
+
 void
 round_print(const flags_t *flags, uint64_t round)
 {
@@ -112,15 +161,12 @@ adjust(const char *fn)
     if (fn == NULL || !fn[0])
         return result;
     /* load final record to automatically adjust configs */
-    trace_t *t = cli_trace_load(fn);
-    if (t) {
-        record_t *final = trace_last(t);
-        if (final && final->kind == RECORD_EXIT && final->size > 0) {
-            statemgr_unmarshal(final->data, STATE_TYPE_FINAL, true);
-            result = REASON_RUNTIME(final->reason);
-        }
-        trace_destroy(t);
+    record_t *final = cli_trace_load_last(fn);
+    if (final && final->kind == RECORD_EXIT && final->size > 0) {
+        statemgr_unmarshal(final->data, STATE_TYPE_FINAL, true);
+        result = REASON_RUNTIME(final->reason);
     }
+    sys_free(final);
     return result;
 }
 
@@ -219,6 +265,8 @@ run_once(args_t *args, flags_t *flags)
 
     setenv("LOTTO_LOGGER_FILE", flags_get_sval(flags, flag_logger_file()),
            true);
+    setenv("LOTTO_LOGGER_BINARY", flags_get_sval(flags, flag_logger_binary()),
+           true);
 
     preload(flags_get_sval(flags, flag_temporary_directory()), verbose,
             !flags_is_on(flags, flag_no_preload()),
@@ -12,6 +12,7 @@
 #include <lotto/engine/statemgr.h>
 #include <lotto/runtime/events.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
 #include <lotto/sys/now.h>
 #include <lotto/util/contract.h>
 #include <lotto/util/once.h>
@@ -28,6 +29,16 @@
                   cp->id, CONTRACT(_ghost.clk, ) cp->pc & 0xfff,               \
                   ps_type_str(cp->type_id), ##__VA_ARGS__)
 
+/* Hot-path events go to the binary logger when it is enabled, skipping the
+ * formatting and the type name lookup. */
+#define log_event(cp, kind)                                                    \
+    do {                                                                       \
+        if (!logger_bin(kind, cp->id, sequencer_get_clk(), cp->type_id,        \
+                        cp->pc, 0))                                            \
+            log(cp, "%-8s %s\t%s", #kind, ps_type_str(cp->type_id),            \
+                cp->func);                                                     \
+    } while (0)
+
 
 CONTRACT(enum state{
     INIT     = 0,
@@ -116,6 +127,15 @@ engine_init(trace_t *input, trace_t *output)
     setvbuf(stdout, NULL, _IONBF, 0);
     setvbuf(stderr, NULL, _IONBF, 0);
     logger_debugf("starting...\n");
+    /* the engine is restarted after a runtime rollover */
+    CONTRACT({
+        vatomic_write(&_ghost.state, INIT);
+        vatomic_write(&_ghost.pending_blocking_returns, 0);
+        vatomic_write(&_ghost.exiting, 0);
+        caslock_init(&_ghost.lock);
+        _ghost.running_id = NO_TASK;
+        _ghost.clk        = 0;
+    })
     LOTTO_PUBLISH(EVENT_ENGINE__START, nil);
     recorder_init(input, output);
 }
@@ -129,6 +149,7 @@ engine_fini(const capture_point *cp, reason_t reason)
     })
 
     log(cp, "engine_fini() called! terminating...\n");
+    logger_bin(FINI, cp->id, sequencer_get_clk(), cp->type_id, cp->pc, reason);
     sequencer_fini(cp, reason);
 
     bool success;
@@ -162,7 +183,7 @@ engine_capture(const capture_point *cp)
         ASSERT(caslock_tryacquire(&_ghost.lock));
     })
 
-    log(cp, "CAPTURE  %s\t%s", ps_type_str(cp->type_id), cp->func);
+    log_event(cp, CAPTURE);
 
     struct plan p = sequencer_capture(cp);
 
@@ -187,7 +208,7 @@ engine_capture(const capture_point *cp)
     })
 
     if (plan_next(p) == ACTION_CONTINUE)
-        log(cp, "CONTINUE %s\t%s", ps_type_str(cp->type_id), cp->func);
+        log_event(cp, CONTINUE);
 
     return p;
 }
@@ -196,7 +217,7 @@ void
 engine_resume(const capture_point *cp)
 {
     ASSERT(_engine_is_ingress_chain(cp->chain_id));
-    log(cp, "RESUME   %s\t%s", ps_type_str(cp->type_id), cp->func);
+    log_event(cp, RESUME);
 
     CONTRACT({
         ASSERT(caslock_tryacquire(&_ghost.lock));
@@ -226,7 +247,7 @@ engine_return(const capture_point *cp)
         ASSERT(vatomic_get_dec(&_ghost.pending_blocking_returns) > 0);
     })
 
-    log(cp, "RETURN   %s\t%s", ps_type_str(cp->type_id), cp->func);
+    log_event(cp, RETURN);
     sequencer_return(cp);
 }
 
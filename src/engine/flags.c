@@ -6,6 +6,7 @@
 #include <lotto/driver/flagmgr.h>
 #include <lotto/driver/flags/prng.h>
 #include <lotto/driver/flags/sequencer.h>
+#include <lotto/engine/prng.h>
 #include <lotto/engine/state.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/string.h>
@@ -20,6 +21,12 @@ _record_granularities_help(char *dst)
     record_granularities_all_str(dst);
 }
 
+static void
+_prng_gen_help(char *dst)
+{
+    prng_gen_all_str(dst);
+}
+
 static void
 _stable_address_method_help(char *dst)
 {
@@ -29,7 +36,19 @@ _stable_address_method_help(char *dst)
 NEW_PUBLIC_CALLBACK_FLAG(SEED, "", "seed", "INT",
                          "seed for pseudo-random number generator",
                          flag_uval_force_opt(UINT64_MAX),
-                         { prng()->seed = (uint32_t)as_uval(v); })
+                         { prng_reset(as_uval(v)); })
+
+NEW_PUBLIC_CALLBACK_FLAG(PRNG_STREAM, "", "prng-stream", "INT",
+                         "stream of the pseudo-random number generator",
+                         flag_uval(0),
+                         { prng_stream(prng()->seed, as_uval(v)); })
+
+NEW_PUBLIC_PRETTY_CALLBACK_FLAG(
+    PRNG_GEN, "", "prng", "pseudo-random number generator",
+    flag_uval(PRNG_GEN_XOSHIRO256SS),
+    STR_CONVERTER_GET(prng_gen_str, prng_gen_from, PRNG_GEN_MAX_LEN,
+                      _prng_gen_help),
+    { prng()->gen = as_uval(v); })
 
 NEW_PUBLIC_PRETTY_CALLBACK_FLAG(
     RECORD_GRANULARITY, "", "record-granularity",
@@ -60,6 +79,8 @@ NEW_PUBLIC_PRETTY_CALLBACK_FLAG(
     { sequencer_config()->stable_address_method = as_uval(v); })
 
 FLAG_GETTER(seed, SEED)
+FLAG_GETTER(prng_stream, PRNG_STREAM)
+FLAG_GETTER(prng_gen, PRNG_GEN)
 FLAG_GETTER(record_granularity, RECORD_GRANULARITY)
 FLAG_GETTER(strategy, STRATEGY)
 FLAG_GETTER(stable_address_method, STABLE_ADDRESS_METHOD)
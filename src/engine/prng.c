@@ -1,39 +1,220 @@
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 #include <lotto/engine/prng.h>
 #include <lotto/engine/state.h>
 #include <lotto/sys/assert.h>
-#include <lotto/util/casts.h>
+#include <lotto/sys/logger.h>
 
 #define PRNG_MASK 0xFFFFFFFF
 
+/* xoshiro256** by David Blackman and Sebastiano Vigna. The jump polynomials
+ * advance the state by 2^128 and 2^192 draws. */
+static const uint64_t _jump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+static const uint64_t _long_jump[] = {
+    0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL,
+    0x39109bb02acbe635ULL};
+
+static inline uint64_t
+_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t
+_splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t
+_xoshiro_next(uint64_t *s)
+{
+    uint64_t result = _rotl(s[1] * 5, 7) * 9;
+    uint64_t t      = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = _rotl(s[3], 45);
+
+    return result;
+}
+
+static void
+_xoshiro_jump(uint64_t *s, const uint64_t *poly)
+{
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (size_t i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (poly[i] & (1ULL << b)) {
+                s0 ^= s[0];
+                s1 ^= s[1];
+                s2 ^= s[2];
+                s3 ^= s[3];
+            }
+            (void)_xoshiro_next(s);
+        }
+    }
+    s[0] = s0;
+    s[1] = s1;
+    s[2] = s2;
+    s[3] = s3;
+}
+
+static inline bool
+_unseeded(const prng_t *p)
+{
+    return (p->s[0] | p->s[1] | p->s[2] | p->s[3]) == 0;
+}
+
+/* Derives the xoshiro256** state of substream `sub` of stream `stream`. */
+static void
+_xoshiro_seed(uint64_t *s, uint64_t seed, uint64_t stream, uint64_t sub)
+{
+    uint64_t x = seed;
+    for (int i = 0; i < 4; i++)
+        s[i] = _splitmix64(&x);
+    for (uint64_t i = 0; i < sub; i++)
+        _xoshiro_jump(s, _long_jump);
+    for (uint64_t i = 0; i < stream; i++)
+        _xoshiro_jump(s, _jump);
+}
+
+/* Lemire's nearly divisionless bounded draw: reject the low products that
+ * would otherwise make some values more likely than others. */
+static uint64_t
+_xoshiro_range(uint64_t *s, uint64_t range)
+{
+    __uint128_t m = (__uint128_t)_xoshiro_next(s) * range;
+    uint64_t l    = (uint64_t)m;
+    if (l < range) {
+        uint64_t t = -range % range;
+        while (l < t) {
+            m = (__uint128_t)_xoshiro_next(s) * range;
+            l = (uint64_t)m;
+        }
+    }
+    return (uint64_t)(m >> 64);
+}
+
+/* Derives the generator state from the root seed and stream index. The state
+ * is only derived on the first draw, so that the seed and the stream can be
+ * set in any order. */
+static void
+_seed(prng_t *p)
+{
+    switch (p->gen) {
+        case PRNG_GEN_XOSHIRO256SS:
+            _xoshiro_seed(p->s, p->seed, p->stream, 0);
+            break;
+        case PRNG_GEN_RAND_R:
+            /* rand_r cannot jump, streams only offset the seed; s[1] marks
+             * the state as seeded even if the seed is 0 */
+            p->s[0] = (uint32_t)(p->seed + p->stream);
+            p->s[1] = 1;
+            break;
+        default:
+            logger_fatalf("unknown prng generator id %lu\n", p->gen);
+    }
+}
+
+static inline prng_t *
+_prng()
+{
+    prng_t *p = prng();
+    if (_unseeded(p))
+        _seed(p);
+    return p;
+}
+
 uint64_t
 prng_seed()
 {
     return prng()->seed;
 }
 
-// actually only returns  4 random bytes (32bit) due to & PRNG_MASK
+uint64_t
+prng_digest()
+{
+    prng_t *p = _prng();
+    uint64_t x = p->s[0] ^ _rotl(p->s[1], 16) ^ _rotl(p->s[2], 32) ^
+                 _rotl(p->s[3], 48);
+    return _splitmix64(&x);
+}
+
 uint64_t
 prng_next()
 {
-    return (CAST_TYPE(uint64_t, rand_r(&prng()->seed)) & PRNG_MASK);
+    prng_t *p = _prng();
+    if (p->gen == PRNG_GEN_RAND_R) {
+        // actually only returns 4 random bytes (32bit) due to & PRNG_MASK;
+        // CAST_TYPE would evaluate rand_r() more than once
+        unsigned int st = (unsigned int)p->s[0];
+        uint64_t v      = (uint64_t)rand_r(&st) & PRNG_MASK;
+        p->s[0]         = st;
+        return v;
+    }
+    return _xoshiro_next(p->s);
 }
 
 uint64_t
 prng_range(uint64_t min, uint64_t max)
 {
     ASSERT(max > min);
-    uint64_t v     = prng_next();
     uint64_t range = max - min;
-    uint64_t rn    = min + (v % range);
-    return rn;
+    if (prng()->gen == PRNG_GEN_RAND_R)
+        return min + (prng_next() % range);
+    return min + _xoshiro_range(_prng()->s, range);
 }
 
 double
 prng_real()
 {
-    double rn = 1.0 * (double)prng_next() / RAND_MAX;
-    return rn;
+    if (prng()->gen == PRNG_GEN_RAND_R)
+        return 1.0 * (double)prng_next() / RAND_MAX;
+    /* 53 random bits fill the double mantissa exactly */
+    return (double)(prng_next() >> 11) * 0x1.0p-53;
+}
+
+void
+prng_jump()
+{
+    prng_t *p = _prng();
+    ASSERT(p->gen == PRNG_GEN_XOSHIRO256SS && "generator cannot jump");
+    _xoshiro_jump(p->s, _jump);
+}
+
+void
+prng_sub_init(prng_sub_t *sub, uint64_t seed, uint64_t stream,
+              prng_sub_id_t id)
+{
+    ASSERT(id != PRNG_SUB_NONE);
+    _xoshiro_seed(sub->s, seed, stream, id);
+}
+
+uint64_t
+prng_sub_next(prng_sub_t *sub)
+{
+    return _xoshiro_next(sub->s);
+}
+
+uint64_t
+prng_sub_range(prng_sub_t *sub, uint64_t min, uint64_t max)
+{
+    ASSERT(max > min);
+    return min + _xoshiro_range(sub->s, max - min);
+}
+
+double
+prng_sub_real(prng_sub_t *sub)
+{
+    return (double)(_xoshiro_next(sub->s) >> 11) * 0x1.0p-53;
 }
@@ -12,9 +12,9 @@
 #include <lotto/engine/statemgr.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
 #include <lotto/sys/stdio.h>
 #include <lotto/util/contract.h>
-#include <lotto/util/once.h>
 
 #define IS_AFTER_KIND(x) (((x) & (RECORD_START | RECORD_CONFIG)) != 0)
 
@@ -41,14 +41,16 @@ static struct {
     trace_t *input;
     trace_t *output;
     record_t *finalr;
+    bool replay_ended;
 } _recorder;
 
 void
 recorder_init(trace_t *input, trace_t *output)
 {
     logger_debugf("recorder_init called\n");
-    _recorder.input  = input;
-    _recorder.output = output;
+    _recorder.input        = input;
+    _recorder.output       = output;
+    _recorder.replay_ended = false;
 }
 
 CONTRACT_GHOST({
@@ -208,7 +210,9 @@ recorder_record(const capture_point *cp, clk_t clk)
         ASSERT(clk >= _ghost.replay_clk && "record clk >= to replay");
     })
 
-    logger_debugf("recorder_record called (clk: %lu id: %lu)\n", clk, cp->id);
+    if (!logger_bin(RECORD, cp->id, clk, cp->type_id, cp->pc, 0))
+        logger_debugf("recorder_record called (clk: %lu id: %lu)\n", clk,
+                      cp->id);
 
     if (!_recorder.output)
         return;
@@ -227,8 +231,10 @@ recorder_record(const capture_point *cp, clk_t clk)
     /* if the replay is over, input is NULL. The following call to record
      * marks the start of the recording phase (ie, the end of the replay).
      */
-    if (_recorder.input == NULL)
-        once(recorder_end_replay());
+    if (_recorder.input == NULL && !_recorder.replay_ended) {
+        _recorder.replay_ended = true;
+        recorder_end_replay();
+    }
 }
 
 LOTTO_SUBSCRIBE(EVENT_ENGINE__INFO_RECORD_SAVE, {
@@ -20,25 +20,35 @@
 #include <lotto/runtime/events.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
 #include <lotto/sys/real.h>
 #include <lotto/sys/stream_file.h>
 #include <lotto/util/once.h>
 #include <vsync/atomic.h>
 #include <vsync/atomic/dispatch.h>
-#include <vsync/spinlock/caslock.h>
 
 #define log(cp, fmt, ...)                                                      \
     logger_debugf("[t:%lu, clk:%lu, pc:0x%lx, type:%s] " fmt "\n", cp->id,     \
                   _seq.clk, cp->pc & 0xfff, ps_type_str(cp->type_id),          \
                   ##__VA_ARGS__)
 
+/* Node of the pending-unblocked stack. Each thread owns one node, which can
+ * be in the stack at most once: a task returns from a blocking call only once
+ * before its next capture, and every capture drains the stack. */
+typedef struct pending_node {
+    struct pending_node *next;
+    task_id id;
+    vatomic32_t queued;
+} pending_node_t;
+
 typedef struct {
     _Atomic(clk_t) clk;
 
     tidset_t unblocked;
     struct {
-        tidset_t unblocked;
-        caslock_t lock;
+        /* Treiber stack pushed by returning tasks and drained at once by the
+         * running task, so neither side takes a lock. */
+        vatomicptr_t head;
     } pending;
 
     uint64_t chpt_count;
@@ -51,6 +61,7 @@ typedef struct {
     bool should_record;
 } sequencer_t;
 static sequencer_t _seq;
+static __thread pending_node_t _pending_node;
 
 clk_t clk_bound;
 
@@ -68,8 +79,12 @@ void
 sequencer_reset(void)
 {
     tidset_init(&_seq.unblocked);
-    tidset_init(&_seq.pending.unblocked);
-    caslock_init(&_seq.pending.lock);
+    pending_node_t *n = vatomicptr_xchg(&_seq.pending.head, NULL);
+    while (n != NULL) {
+        pending_node_t *next = n->next;
+        vatomic32_write(&n->queued, 0);
+        n = next;
+    }
     _seq.clk           = 0;
     _seq.chpt_count    = 0;
     _seq.switch_count  = 0;
@@ -142,7 +157,9 @@ sequencer_capture(const capture_point *cp)
                             .tset      = {}};
 
     /* pass capture point to handlers */
-    log(cp, "sequence: cp->replay: %d", e.replay);
+    if (!logger_bin(SEQUENCE, cp->id, _seq.clk, cp->type_id, cp->pc,
+                    e.replay))
+        log(cp, "sequence: cp->replay: %d", e.replay);
     capture_point capture_cp = *cp;
     capture_cp.decision      = &e;
     task_id next             = _dispatch_capture_event(&capture_cp, &e);
@@ -387,22 +404,41 @@ _granularity_should_record(const capture_point *cp, const event_t *e,
 static void
 _update_unblocked()
 {
-    caslock_acquire(&_seq.pending.lock);
-    for (size_t i = 0; i < tidset_size(&_seq.pending.unblocked); i++) {
-        task_id id = tidset_get(&_seq.pending.unblocked, i);
-        bool ok    = tidset_insert(&_seq.unblocked, id);
+    if (vatomicptr_read_rlx(&_seq.pending.head) == NULL)
+        return;
+
+    pending_node_t *n = vatomicptr_xchg_acq(&_seq.pending.head, NULL);
+
+    /* reverse the stack to insert ids in return order */
+    pending_node_t *fifo = NULL;
+    while (n != NULL) {
+        pending_node_t *next = n->next;
+        n->next              = fifo;
+        fifo                 = n;
+        n                    = next;
+    }
+
+    while (fifo != NULL) {
+        pending_node_t *next = fifo->next;
+        bool ok              = tidset_insert(&_seq.unblocked, fifo->id);
         ASSERT(ok && "inserting id of again");
+        vatomic32_write_rel(&fifo->queued, 0);
+        fifo = next;
     }
-    tidset_clear(&_seq.pending.unblocked);
-    caslock_release(&_seq.pending.lock);
 }
 static void
 _add_pending_unblocked(task_id id)
 {
-    caslock_acquire(&_seq.pending.lock);
-    if (!tidset_insert(&_seq.pending.unblocked, id))
+    pending_node_t *n = &_pending_node;
+    if (vatomic32_xchg(&n->queued, 1) != 0)
         ASSERT(0 && "inserting id again");
-    caslock_release(&_seq.pending.lock);
+    n->id = id;
+
+    pending_node_t *head;
+    do {
+        head    = vatomicptr_read_rlx(&_seq.pending.head);
+        n->next = head;
+    } while (vatomicptr_cmpxchg_rel(&_seq.pending.head, head, n) != head);
 }
 
 void __attribute__((noinline)) sequencer_clk_met()
@@ -1,7 +1,9 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include <dice/module.h>
 #include <lotto/base/marshable.h>
+#include <lotto/engine/prng.h>
 #include <lotto/engine/pubsub.h>
 #include <lotto/engine/state.h>
 #include <lotto/engine/statemgr.h>
@@ -15,11 +17,23 @@ struct engine_state {
 
 static struct engine_state _engine_state;
 
+static const char *_prng_gen_map[] = {
+    [PRNG_GEN_NONE]         = "NONE",
+    [PRNG_GEN_XOSHIRO256SS] = "xoshiro256ss",
+    [PRNG_GEN_RAND_R]       = "rand_r",
+};
+
+BIT_FROM(prng_gen, PRNG_GEN)
+BIT_STR(prng_gen, PRNG_GEN)
+BIT_ALL_STR(prng_gen, PRNG_GEN)
+
 static void
 state_prng_print(const marshable_t *m)
 {
     (void)m;
-    logger_infof("seed = %u\n", _engine_state.prng.seed);
+    logger_infof("prng   = %s\n", prng_gen_str(_engine_state.prng.gen));
+    logger_infof("seed   = %lu\n", _engine_state.prng.seed);
+    logger_infof("stream = %lu\n", _engine_state.prng.stream);
 }
 
 static void
@@ -41,6 +55,7 @@ state_sequencer_print(const marshable_t *m)
 STATEMGR_REGISTER(CONFIG, {
     _engine_state.prng.m = MARSHABLE_STATIC_PRINTABLE(
         sizeof(_engine_state.prng), state_prng_print);
+    _engine_state.prng.gen = PRNG_GEN_XOSHIRO256SS;
     statemgr_register(DICE_MODULE_SLOT, &_engine_state.prng.m,
                       STATE_TYPE_CONFIG);
 })
@@ -54,11 +69,16 @@ STATEMGR_REGISTER(CONFIG, {
 
 LOTTO_SUBSCRIBE(EVENT_ENGINE__AFTER_UNMARSHAL_CONFIG, {
     (void)v;
-    logger_debugf("engine loaded seed = %u\n", _engine_state.prng.seed);
+    logger_debugf("engine loaded seed = %lu\n", _engine_state.prng.seed);
+    if (_engine_state.prng.gen == PRNG_GEN_NONE ||
+        _engine_state.prng.gen >= PRNG_GEN_END_) {
+        logger_fatalf("unknown prng generator id %lu in CONFIG\n",
+                      _engine_state.prng.gen);
+    }
     const char *var = getenv("LOTTO_SEED");
     if (var) {
-        _engine_state.prng.seed = atoi(var);
-        logger_debugf("Seed from envvar: %u\n", _engine_state.prng.seed);
+        prng_reset(strtoull(var, NULL, 10));
+        logger_debugf("Seed from envvar: %lu\n", _engine_state.prng.seed);
     }
 })
 
@@ -68,6 +88,20 @@ prng()
     return &_engine_state.prng;
 }
 
+void
+prng_reset(uint64_t seed)
+{
+    _engine_state.prng.seed = seed;
+    memset(_engine_state.prng.s, 0, sizeof(_engine_state.prng.s));
+}
+
+void
+prng_stream(uint64_t seed, uint64_t stream)
+{
+    _engine_state.prng.stream = stream;
+    prng_reset(seed);
+}
+
 sequencer_config_t *
 sequencer_config()
 {
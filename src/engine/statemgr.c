@@ -6,6 +6,7 @@
 #include <lotto/engine/statemgr.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/stdlib.h>
 #include <lotto/sys/string.h>
 
 #define CANARY    0xbadfeed
@@ -30,6 +31,17 @@ typedef struct {
 
 static statemgr_t _groups[STATE_TYPE_END_];
 
+typedef struct {
+    marshable_t *m;
+    void (*init)(marshable_t *);
+} reset_entry_t;
+
+static struct {
+    reset_entry_t entries[MAX_SLOTS];
+    size_t length;
+    void *baseline[STATE_TYPE_END_];
+} _reset;
+
 typedef struct {
     uint64_t canary;
     size_t index;
@@ -128,6 +140,13 @@ _statemgr_size(statemgr_t *mgr)
     return size;
 }
 
+void
+statemgr_register_reset(marshable_t *m, void (*init)(marshable_t *))
+{
+    ASSERT(_reset.length < MAX_SLOTS);
+    _reset.entries[_reset.length++] = (reset_entry_t){.m = m, .init = init};
+}
+
 size_t
 statemgr_size(state_type_t type)
 {
@@ -183,7 +202,12 @@ _statemgr_record_unmarshal(statemgr_t *mgr, const void *buf, size_t size)
         ASSERT((size_t)(end - (const char *)buf) >= sizeof(header_t));
         header_t h = _header_unmarshal(buf);
         if (h.slot != mgr->entries[i].slot) {
-            i++;
+            // optional states, such as the explore pending operations, may
+            // be recorded without being registered here
+            if (++i == mgr->length) {
+                buf = _add_header(buf) + h.size;
+                i   = 0;
+            }
             continue;
         }
 
@@ -331,3 +355,38 @@ statemgr_record_unmarshal(const record_t *r)
             logger_fatalf("unexpected %s record\n", kind_str(r->kind));
     }
 }
+
+/* states restored from the baseline; START is rewritten by every replay */
+static const state_type_t _baseline_types[] = {
+    STATE_TYPE_CONFIG,
+    STATE_TYPE_PERSISTENT,
+    STATE_TYPE_FINAL,
+};
+
+void
+statemgr_checkpoint(void)
+{
+    for (size_t i = 0; i < sizeof(_baseline_types) / sizeof(state_type_t);
+         i++) {
+        state_type_t type = _baseline_types[i];
+        if (_groups[type].length == 0)
+            continue;
+        sys_free(_reset.baseline[type]);
+        _reset.baseline[type] = sys_malloc(statemgr_size(type));
+        ASSERT(_reset.baseline[type]);
+        (void)_statemgr_marshal(&_groups[type], _reset.baseline[type]);
+    }
+}
+
+void
+statemgr_reset(void)
+{
+    for (size_t i = 0; i < sizeof(_baseline_types) / sizeof(state_type_t);
+         i++) {
+        state_type_t type = _baseline_types[i];
+        if (_reset.baseline[type] != NULL)
+            (void)_statemgr_unmarshal(&_groups[type], _reset.baseline[type]);
+    }
+    for (size_t i = 0; i < _reset.length; i++)
+        _reset.entries[i].init(_reset.entries[i].m);
+}
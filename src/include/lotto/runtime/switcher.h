@@ -19,5 +19,6 @@ typedef enum switcher_status {
 switcher_status_t switcher_yield(task_id id, bool (*any_task_filter)(task_id));
 void switcher_wake(task_id id, nanosec_t slack);
 void switcher_abort(void);
+void switcher_reset(void);
 
 #endif
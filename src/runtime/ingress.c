@@ -35,8 +35,9 @@ _intercept_resume(mediator_t *m, capture_point *cp)
             break;
         case MEDIATOR_ABORT:
         case MEDIATOR_SHUTDOWN:
-            lotto_exit(cp, mediator_reason(m));
-            sys_abort();
+            lotto_round_end(cp, mediator_reason(m));
+            break;
+        case MEDIATOR_DORMANT:
             break;
         default:
             logger_fatalf("unexpected mediator resume output");
@@ -48,6 +49,8 @@ PS_SUBSCRIBE(CHAIN_INGRESS_EVENT, ANY_EVENT, {
     capture_point *cp = EVENT_PAYLOAD(cp);
     cp->chain_id      = chain;
     cp->type_id       = type;
+    if (lotto_dormant())
+        return PS_STOP_CHAIN;
     mediator_t *m     = mediator_get(md, true);
 
     if (cp->blocking) {
@@ -66,6 +69,8 @@ PS_SUBSCRIBE(CHAIN_INGRESS_BEFORE, ANY_EVENT, {
     capture_point *cp = EVENT_PAYLOAD(cp);
     cp->chain_id      = chain;
     cp->type_id       = type;
+    if (lotto_dormant())
+        return PS_STOP_CHAIN;
     mediator_t *m     = mediator_get(md, true);
 
     if (!mediator_capture(m, cp)) {
@@ -82,8 +87,15 @@ PS_SUBSCRIBE(CHAIN_INGRESS_AFTER, ANY_EVENT, {
     capture_point *cp = EVENT_PAYLOAD(cp);
     cp->chain_id      = chain;
     cp->type_id       = type;
+    if (lotto_dormant())
+        return PS_STOP_CHAIN;
 
+    /* the call was captured before a rollover, drop its return */
+    bool stale    = cp->blocking && mediator_stale(md);
     mediator_t *m = mediator_get(md, true);
+    if (stale) {
+        return PS_STOP_CHAIN;
+    }
     if (cp->blocking) {
         logger_debugf("[%lu] return from '%s'\n", m->id, cp->func);
         mediator_return(m, cp);
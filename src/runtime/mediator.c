@@ -39,12 +39,14 @@ mediator_get(struct metadata *md, bool bootstrap)
             return NULL;
         m = SELF_TLS(md, &mediator_key_);
     }
-    if (m->id == NO_TASK) {
+    /* mediators of a previous round are restarted as new tasks */
+    if (m->id == NO_TASK || m->round != lotto_round()) {
         *m = (mediator_t){
             .id           = self_id(md),
             .plan.actions = ACTION_RESUME,
             .optimization = MEDIATOR_OPTIMIZATION_NONE,
             .finito       = false,
+            .round        = lotto_round(),
         };
         if (bootstrap) {
             capture_point cp = {
@@ -59,6 +61,15 @@ mediator_get(struct metadata *md, bool bootstrap)
     return m;
 }
 
+bool
+mediator_stale(metadata_t *md)
+{
+    if (md == NULL)
+        md = self_md();
+    const mediator_t *m = self_tls_get(md, (uintptr_t)&mediator_key_);
+    return m != NULL && m->id != NO_TASK && m->round != lotto_round();
+}
+
 static void
 _plan_optimize(struct plan *plan, const capture_point *cp,
                mediator_optimization_t optimization)
@@ -151,7 +162,9 @@ mediator_resume(mediator_t *m, capture_point *cp)
     do {
         switch (plan_next(m->plan)) {
             case ACTION_YIELD:
-                switcher_yield(cp->id, m->plan.any_task_filter);
+                if (switcher_yield(cp->id, m->plan.any_task_filter) ==
+                    SWITCHER_ABORTED)
+                    return MEDIATOR_DORMANT;
                 break;
 
             case ACTION_RESUME:
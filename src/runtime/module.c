@@ -1,4 +1,5 @@
 #include <fcntl.h>
+#include <sched.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,16 +16,20 @@
 #include <lotto/base/trace_file.h>
 #include <lotto/engine/engine.h>
 #include <lotto/engine/pubsub.h>
+#include <lotto/engine/statemgr.h>
 #include <lotto/runtime/capture_point.h>
 #include <lotto/runtime/events.h>
 #include <lotto/runtime/ingress.h>
 #include <lotto/runtime/mediator.h>
 #include <lotto/runtime/runtime.h>
+#include <lotto/runtime/switcher.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
 #include <lotto/sys/memory.h>
 #include <lotto/sys/now.h>
 #include <lotto/sys/real.h>
+#include <lotto/sys/stdlib.h>
 #include <lotto/sys/stream_file.h>
 #include <vsync/atomic/core.h>
 #include <vsync/atomic/dispatch.h>
@@ -41,10 +46,14 @@ PS_ADVERTISE_CHAIN(CHAIN_INGRESS_AFTER)
 typedef struct {
     const capture_point *cp;
     reason_t reason;
+    bool may_rollover;
 } cb_data;
 
 static vatomic64_t _only_once;
 static vatomic64_t _winner_reason;
+static vatomic32_t _dormant;
+static vatomic64_t _round;
+static lotto_rollover_f *_rollover;
 
 bool
 _lotto_loaded(void)
@@ -54,14 +63,9 @@ _lotto_loaded(void)
 }
 
 static void
-runtime_init_(void)
+_open_traces(void)
 {
-    const char *var = getenv("LOTTO_DISABLE");
-    if (var) {
-        return;
-    }
-
-    _start = now();
+    const char *var;
     if ((var = getenv("LOTTO_RECORD")) && var[0]) {
         logger_debugf("record: %s\n", var);
         stream_t *st = stream_file_alloc();
@@ -81,6 +85,30 @@ runtime_init_(void)
     } else {
         _replayer = NULL;
     }
+}
+
+static void
+_drop_trace(trace_t **t)
+{
+    if (*t == NULL) {
+        return;
+    }
+    stream_t *st = trace_stream(*t);
+    trace_destroy(*t);
+    sys_free(st);
+    *t = NULL;
+}
+
+static void
+runtime_init_(void)
+{
+    const char *var = getenv("LOTTO_DISABLE");
+    if (var) {
+        return;
+    }
+
+    _start = now();
+    _open_traces();
 
     sighandler_init();
     vatomic_write(&_winner_reason, REASON_SUCCESS);
@@ -90,7 +118,12 @@ runtime_init_(void)
 static void
 logger_init_(void)
 {
-    const char *var = getenv("LOTTO_LOGGER_LEVEL");
+    const char *var = getenv("LOTTO_LOGGER_BINARY");
+    if (var && var[0]) {
+        (void)logger_bin_open(var);
+    }
+
+    var = getenv("LOTTO_LOGGER_LEVEL");
 
     enum logger_level level = LOGGER_ERROR;
     if (var) {
@@ -139,7 +172,12 @@ fini_cb_(void *arg)
             .md     = md,
             .reason = reason,
         };
-        START_FINALIZATION_PHASE(&ev, md);
+        /* the finalization phase is delayed until the process is known not
+         * to roll over into another round */
+        bool rollover = dat->may_rollover && _rollover != NULL;
+        if (!rollover) {
+            START_FINALIZATION_PHASE(&ev, md);
+        }
 
         mediator_t *m = md ? mediator_get(md, false) : NULL;
         if (m) {
@@ -147,6 +185,7 @@ fini_cb_(void *arg)
         }
 
         int err = engine_fini(dat->cp, reason);
+        logger_bin_flush();
 
         if (_recorder) {
             stream_close(trace_stream(_recorder));
@@ -156,6 +195,19 @@ fini_cb_(void *arg)
             stream_close(trace_stream(_replayer));
         }
 
+        if (rollover) {
+            if (_rollover(reason, err)) {
+                /* keep the process for the next round; tasks waiting in the
+                 * switcher return and continue uncaptured */
+                _drop_trace(&_recorder);
+                _drop_trace(&_replayer);
+                vatomic_write(&_dormant, 1);
+                switcher_abort();
+                return NULL;
+            }
+            START_FINALIZATION_PHASE(&ev, md);
+        }
+
         lotto_intercept_fini();
         sys_memory_fini();
         nanosec_t elapsed = now() - _start;
@@ -165,6 +217,17 @@ fini_cb_(void *arg)
         }
         _exit(err != 0 ? err : 1);
     }
+    if (dat->may_rollover && _rollover != NULL) {
+        /* the winner either rolls over or terminates the process */
+        while (vatomic_read(&_dormant) == 0) {
+            sched_yield();
+        }
+        return NULL;
+    }
+    if (vatomic_read(&_dormant)) {
+        /* the round has already been recorded */
+        _exit(0);
+    }
     if (reason != REASON_SUCCESS) {
         _exit(1);
     }
@@ -175,8 +238,8 @@ fini_cb_(void *arg)
     return NULL;
 }
 
-NORETURN void
-lotto_exit(capture_point *cp, reason_t reason)
+static void
+_finish(capture_point *cp, reason_t reason, bool may_rollover)
 {
     if (reason != REASON_SUCCESS) {
         reason_t previous = (reason_t)vatomic_xchg(&_winner_reason, reason);
@@ -188,14 +251,61 @@ lotto_exit(capture_point *cp, reason_t reason)
     fflush(stderr);
     cp->id      = (cp->id == NO_TASK) ? 1 : cp->id;
     cb_data dat = {
-        .cp     = cp,
-        .reason = reason,
+        .cp           = cp,
+        .reason       = reason,
+        .may_rollover = may_rollover,
     };
     fini_cb_(&dat);
+}
+
+NORETURN void
+lotto_exit(capture_point *cp, reason_t reason)
+{
+    _finish(cp, reason, false);
     logger_fatalf("should never reach here");
     sys_abort();
 }
 
+void
+lotto_round_end(capture_point *cp, reason_t reason)
+{
+    _finish(cp, reason, true);
+    ASSERT(vatomic_read(&_dormant));
+}
+
+void
+lotto_rollover_register(lotto_rollover_f *rollover)
+{
+    _rollover = rollover;
+    statemgr_checkpoint();
+}
+
+void
+lotto_rollover_resume(void)
+{
+    ASSERT(vatomic_read(&_dormant));
+    statemgr_reset();
+    switcher_reset();
+    _open_traces();
+    vatomic_write(&_winner_reason, REASON_SUCCESS);
+    vatomic_write(&_only_once, 0);
+    vatomic_inc(&_round);
+    engine_init(_replayer, _recorder);
+    vatomic_write(&_dormant, 0);
+}
+
+bool
+lotto_dormant(void)
+{
+    return vatomic_read(&_dormant) != 0;
+}
+
+uint64_t
+lotto_round(void)
+{
+    return vatomic_read(&_round);
+}
+
 static void DICE_DTOR
 runtime_fini_(void)
 {
@@ -15,6 +15,7 @@
 #include <lotto/runtime/ingress.h>
 #include <lotto/runtime/runtime.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
 #include <lotto/sys/real.h>
 #include <lotto/sys/string.h>
 #include <lotto/sys/unistd.h>
@@ -85,6 +86,7 @@ _handle(reason_t user_reason, reason_t runtime_reason)
         sys_write(SIGHANLDER_FD, "\n", 1);
     }
     _backtrace_print();
+    logger_bin_flush();
 
     lotto_exit(&cp, reason);
 }
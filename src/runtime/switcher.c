@@ -33,6 +33,7 @@
 #include <lotto/runtime/switcher.h>
 #include <lotto/sys/assert.h>
 #include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
 #include <lotto/sys/real.h>
 #include <lotto/sys/time.h>
 
@@ -61,7 +62,8 @@ switcher_status_t
 switcher_yield(task_id id, bool (*any_task_filter)(task_id))
 {
     task_id prev, next;
-    logger_debugf("YIELD  task %lu\n", id);
+    if (!logger_bin(YIELD, id, 0, 0, 0, 0))
+        logger_debugf("YIELD  task %lu\n", id);
 
     vmutex_acquire(&_switcher.mutex);
     int bucket = (int)(id % LOTTO_SWITCHER_NBUCKETS);
@@ -93,6 +95,8 @@ switcher_yield(task_id id, bool (*any_task_filter)(task_id))
     _switcher.cnd_counter[bucket]--;
 
     if (_switcher.status == SWITCHER_ABORTED) {
+        /* pass the wake-up on to tasks sharing the bucket */
+        vcond_signal(&_switcher.cnd[bucket]);
         vmutex_release(&_switcher.mutex);
         return SWITCHER_ABORTED;
     }
@@ -111,7 +115,8 @@ switcher_yield(task_id id, bool (*any_task_filter)(task_id))
     vmutex_release(&_switcher.mutex);
 
     _lotto_switcher_resuming();
-    logger_debugf("RESUME task %lu\n", id);
+    if (!logger_bin(RESUMED, id, 0, 0, 0, status))
+        logger_debugf("RESUME task %lu\n", id);
 
     return status;
 }
@@ -122,7 +127,8 @@ void
 switcher_wake(task_id id, nanosec_t slack)
 {
     vmutex_acquire(&_switcher.mutex);
-    logger_debugf("WAKE   task %lu\n", id);
+    if (!logger_bin(WAKE, id, 0, 0, 0, slack))
+        logger_debugf("WAKE   task %lu\n", id);
 
     ASSERT(_switcher.next == NO_TASK);
     ASSERT(id != NO_TASK);
@@ -149,5 +155,23 @@ switcher_abort()
     vmutex_acquire(&_switcher.mutex);
     logger_debugf("ABORT called\n");
     _switcher.status = SWITCHER_ABORTED;
+    /* release every waiting task, they return SWITCHER_ABORTED */
+    for (int i = 0; i < LOTTO_SWITCHER_NBUCKETS; i++) {
+        if (_switcher.cnd_counter[i] > 0) {
+            vcond_signal(&_switcher.cnd[i]);
+        }
+    }
+    vmutex_release(&_switcher.mutex);
+}
+
+void
+switcher_reset()
+{
+    vmutex_acquire(&_switcher.mutex);
+    logger_debugf("RESET called\n");
+    _switcher.next   = NO_TASK;
+    _switcher.prev   = NO_TASK;
+    _switcher.slack  = 0;
+    _switcher.status = SWITCHER_CONTINUE;
     vmutex_release(&_switcher.mutex);
 }
@@ -0,0 +1,187 @@
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <lotto/sys/assert.h>
+#include <lotto/sys/fcntl.h>
+#include <lotto/sys/logger.h>
+#include <lotto/sys/logger_bin.h>
+#include <lotto/sys/now.h>
+#include <lotto/sys/stdlib.h>
+#include <lotto/sys/unistd.h>
+#include <vsync/atomic.h>
+
+#define RING_MASK (LOGGER_BIN_RING_SIZE - 1)
+_Static_assert((LOGGER_BIN_RING_SIZE & RING_MASK) == 0,
+               "ring size must be a power of two");
+
+typedef struct ring {
+    struct ring *next;
+    uint64_t id;
+    vatomic64_t head; //< number of events appended by the owner thread
+    uint64_t flushed; //< number of events already written to the file
+    logger_bin_event_t events[LOGGER_BIN_RING_SIZE];
+} ring_t;
+
+bool _logger_bin_enabled;
+
+static int _fd = -1;
+static vatomicptr_t _rings;
+static vatomic64_t _ring_count;
+static vatomicptr_t _flusher; //< _ring slot of the flushing thread
+static __thread ring_t *_ring;
+
+/* Events are copied out of a ring before they are written, so that the ones
+ * the owner overwrote meanwhile can be dropped. Guarded by _flusher. */
+static logger_bin_event_t _copy[LOGGER_BIN_RING_SIZE];
+
+#define GEN_LOGGER_BIN_KIND(kind) [LOGGER_BIN_##kind] = #kind,
+static const char *_kind_map[] = {
+    [LOGGER_BIN_NONE] = "NONE",
+    FOR_EACH_LOGGER_BIN_KIND};
+#undef GEN_LOGGER_BIN_KIND
+
+const char *
+logger_bin_kind_str(enum logger_bin_kind kind)
+{
+    if (kind >= LOGGER_BIN_END_)
+        return "UNKNOWN";
+    return _kind_map[kind];
+}
+
+static void
+_write_all(const void *buf, size_t len)
+{
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = sys_write(_fd, p, len);
+        if (n <= 0)
+            return;
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+int
+logger_bin_open(const char *path)
+{
+    _fd = sys_open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (_fd < 0) {
+        logger_errorf("could not open binary log %s\n", path);
+        return -1;
+    }
+    logger_bin_header_t hdr = {.magic      = LOGGER_BIN_MAGIC,
+                               .version    = LOGGER_BIN_VERSION,
+                               .event_size = sizeof(logger_bin_event_t)};
+    _write_all(&hdr, sizeof(hdr));
+    _logger_bin_enabled = true;
+    return 0;
+}
+
+static ring_t *
+_ring_new(void)
+{
+    ring_t *r = sys_calloc(1, sizeof(ring_t));
+    ASSERT(r);
+    r->id = vatomic64_get_inc(&_ring_count);
+
+    ring_t *head;
+    do {
+        head    = vatomicptr_read(&_rings);
+        r->next = head;
+    } while (vatomicptr_cmpxchg(&_rings, head, r) != head);
+
+    _ring = r;
+    return r;
+}
+
+void
+_logger_bin_log(enum logger_bin_kind kind, uint64_t tid, uint64_t clk,
+                uint32_t type, uint64_t pc, uint64_t arg)
+{
+    ring_t *r = _ring;
+    if (r == NULL)
+        r = _ring_new();
+
+    /* Only the owner thread writes the ring, so a relaxed read of head is
+     * enough. The fence orders the previous head before the overwrite of the
+     * slot, so a flusher that reads the new event also sees its number; the
+     * release store publishes the complete event to the flusher. */
+    uint64_t h = vatomic64_read_rlx(&r->head);
+    vatomic_fence_rel();
+    logger_bin_event_t *e = &r->events[h & RING_MASK];
+    e->ts                 = now();
+    e->tid                = tid;
+    e->clk                = clk;
+    e->pc                 = pc;
+    e->arg                = arg;
+    e->kind               = kind;
+    e->type               = type;
+    vatomic64_write_rel(&r->head, h + 1);
+}
+
+/* Copies events [from, head) of `r` to _copy and returns how many of the
+ * first ones the owner may have overwritten while they were copied. */
+static uint64_t
+_ring_copy(ring_t *r, uint64_t from, uint64_t head)
+{
+    uint64_t count = head - from;
+    uint64_t start = from & RING_MASK;
+    uint64_t first = LOGGER_BIN_RING_SIZE - start;
+    if (first > count)
+        first = count;
+    memcpy(_copy, &r->events[start], first * sizeof(logger_bin_event_t));
+    memcpy(_copy + first, &r->events[0],
+           (count - first) * sizeof(logger_bin_event_t));
+
+    /* the owner is writing event `now` at most, over event
+     * `now - LOGGER_BIN_RING_SIZE` */
+    vatomic_fence_acq();
+    uint64_t now = vatomic64_read_rlx(&r->head);
+    if (now < from + LOGGER_BIN_RING_SIZE)
+        return 0;
+    uint64_t torn = now - LOGGER_BIN_RING_SIZE - from + 1;
+    return torn < count ? torn : count;
+}
+
+void
+logger_bin_flush(void)
+{
+    if (_fd < 0)
+        return;
+
+    /* A crash of the flushing thread reenters here from the signal handler
+     * and must not deadlock, so it gives up; other threads wait, otherwise
+     * the final flush could miss the events of the last round. */
+    void *self = &_ring;
+    void *owner;
+    while ((owner = vatomicptr_cmpxchg(&_flusher, NULL, self)) != NULL) {
+        if (owner == self)
+            return;
+        vatomic_cpu_pause();
+    }
+
+    for (ring_t *r = vatomicptr_read_acq(&_rings); r; r = r->next) {
+        uint64_t head    = vatomic64_read_acq(&r->head);
+        uint64_t from    = r->flushed;
+        uint64_t dropped = 0;
+        if (head - from > LOGGER_BIN_RING_SIZE) {
+            dropped = head - from - LOGGER_BIN_RING_SIZE;
+            from    = head - LOGGER_BIN_RING_SIZE;
+        }
+        if (from == head)
+            continue;
+
+        uint64_t torn = _ring_copy(r, from, head);
+        r->flushed    = head;
+
+        logger_bin_chunk_t chunk = {.ring    = r->id,
+                                    .count   = head - from - torn,
+                                    .dropped = dropped + torn};
+        _write_all(&chunk, sizeof(chunk));
+        _write_all(&_copy[torn], chunk.count * sizeof(logger_bin_event_t));
+    }
+
+    vatomicptr_write_rel(&_flusher, NULL);
+}
@@ -1,3 +1,4 @@
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -52,12 +53,48 @@ static size_t _sizes[NSTACKS] = {32,
                                  (size_t)4 * 1024 * 1024,
                                  (size_t)8 * 1024 * 1024};
 
+/* Per-thread magazines. The owner thread takes the cache lock for every
+ * operation, so it is uncontended unless the pool runs dry and reclaims the
+ * cached entries of all threads. The pool lock and a cache lock are only
+ * nested in that order. The cache of an exited thread is drained and handed
+ * to the next thread needing one. */
+#define CACHE_BUCKETS  10 /* buckets up to LOTTO_MEMPOOL_CACHE_MAX */
+#define MAGAZINE_SIZE  32
+#define MAGAZINE_BYTES ((size_t)64 * 1024)
+#define TLS_CACHES     4
+
+typedef struct magazine {
+    uint32_t count;
+    entry_t *entries[MAGAZINE_SIZE];
+} magazine_t;
+
+struct lotto_mempool_cache {
+    caslock_t lock;
+    int64_t allocated;
+    bool owned;
+    lotto_mempool_cache_t *next;
+    magazine_t mag[CACHE_BUCKETS];
+} __attribute__((aligned(64)));
+
+/* A thread finds its caches by pool id, so a stale slot never dereferences
+ * the cache of a finalized pool. */
+static __thread struct {
+    uint64_t id;
+    lotto_mempool_cache_t *cache;
+} _tls_caches[TLS_CACHES];
+static __thread unsigned _tls_victim;
+static uint64_t _next_id;
+
 unsigned int
 _bucketize(size_t size)
 {
-    unsigned int i = 0;
-    for (; i < NSTACKS && size > _sizes[i]; i++)
-        ;
+    if (size <= _sizes[0])
+        return 0;
+
+    // _sizes[i] == 2^(i + 6) for i > 0
+    unsigned int i = 64 - __builtin_clzll((unsigned long long)size - 1) - 6;
+    if (i == 0)
+        i = 1;
     if (i >= NSTACKS) {
         logger_errorf(
             "Could not allocate size %lu. Max bucket size %lu. i=%u "
@@ -67,6 +104,13 @@ _bucketize(size_t size)
     return i;
 }
 
+static inline uint32_t
+_magazine_cap(unsigned bucket)
+{
+    size_t cap = MAGAZINE_BYTES / _sizes[bucket];
+    return cap > MAGAZINE_SIZE ? MAGAZINE_SIZE : cap < 2 ? 2 : (uint32_t)cap;
+}
+
 lotto_mempool_t *
 lotto_mempool_init(void *(*alloc)(size_t), void (*free)(void *), size_t cap)
 {
@@ -74,6 +118,8 @@ lotto_mempool_init(void *(*alloc)(size_t), void (*free)(void *), size_t cap)
     ASSERT(mp);
     mp->free      = free;
     mp->allocated = 0;
+    mp->caches    = NULL;
+    mp->id        = __atomic_add_fetch(&_next_id, 1, __ATOMIC_RELAXED);
     sys_memset(&mp->stack, 0, sizeof(entry_t *) * NSTACKS);
 
     cap += LOTTO_MEMPOOL_ALIGNMENT - 1;
@@ -86,6 +132,7 @@ lotto_mempool_init(void *(*alloc)(size_t), void (*free)(void *), size_t cap)
     mp->pool.capacity = cap;
     mp->pool.next =
         ((uintptr_t)mp->pool.memory - METADATA_SIZE) % LOTTO_MEMPOOL_ALIGNMENT;
+    mp->pool.limit = cap;
     caslock_init(&mp->lock);
     return mp;
 }
@@ -96,11 +143,24 @@ lotto_mempool_init_static(lotto_mempool_t *lotto_mempool, void *pool,
 {
     ASSERT(lotto_mempool);
     *lotto_mempool = (lotto_mempool_t){
-        .pool = (struct alloc){.memory = pool, .capacity = cap, .next = 0}};
+        .id   = __atomic_add_fetch(&_next_id, 1, __ATOMIC_RELAXED),
+        .pool = (struct alloc){.memory   = pool,
+                               .capacity = cap,
+                               .next     = 0,
+                               .limit    = cap}};
     ASSERT(pool);
     caslock_init(&lotto_mempool->lock);
 }
 
+static size_t
+_allocated(lotto_mempool_t *mp)
+{
+    int64_t allocated = (int64_t)mp->allocated;
+    for (lotto_mempool_cache_t *c = mp->caches; c; c = c->next)
+        allocated += c->allocated;
+    return (size_t)allocated;
+}
+
 void
 lotto_mempool_fini(lotto_mempool_t *mp)
 {
@@ -109,16 +169,241 @@ lotto_mempool_fini(lotto_mempool_t *mp)
         logger_infof(
             "lotto_mempool not provided with free() to deallocate memory: "
             "%lu\n",
-            mp->allocated);
+            _allocated(mp));
         return;
     }
     logger_infof("lotto_mempool allocated memory on fini: %lu\n",
-                 mp->allocated);
+                 _allocated(mp));
     if (mp->pool.memory)
         mp->free(mp->pool.memory);
     mp->free(mp);
 }
 
+/*******************************************************************************
+ * shared stacks, called with the pool lock held
+ ******************************************************************************/
+
+static inline void
+_push(lotto_mempool_t *mp, unsigned bucket, entry_t *e)
+{
+    e->next           = mp->stack[bucket];
+    mp->stack[bucket] = e;
+}
+
+static entry_t *
+_bump(lotto_mempool_t *mp, size_t size)
+{
+    if (mp->pool.next + size > mp->pool.limit)
+        return NULL;
+    entry_t *e = (entry_t *)(mp->pool.memory + mp->pool.next);
+    e->next    = NULL;
+    e->size    = size;
+    mp->pool.next += size;
+    return e;
+}
+
+/* Carves a free entry of a larger bucket into entries of `bucket`. Bucket
+ * sizes divide each other, so the pieces stay aligned. */
+static entry_t *
+_split(lotto_mempool_t *mp, unsigned bucket)
+{
+    size_t size = _sizes[bucket];
+    for (unsigned b = bucket + 1; b < NSTACKS; b++) {
+        entry_t *big = mp->stack[b];
+        if (big == NULL)
+            continue;
+        mp->stack[b] = big->next;
+
+        for (size_t off = size; off < _sizes[b]; off += size) {
+            entry_t *e = (entry_t *)((char *)big + off);
+            e->size    = size;
+            _push(mp, bucket, e);
+        }
+        big->next = NULL;
+        big->size = size;
+        return big;
+    }
+    return NULL;
+}
+
+/* Moves the entries of a thread cache back to the shared stacks, called with
+ * the cache lock held. */
+static void
+_drain(lotto_mempool_t *mp, lotto_mempool_cache_t *c)
+{
+    for (unsigned b = 0; b < CACHE_BUCKETS; b++) {
+        magazine_t *m = &c->mag[b];
+        while (m->count > 0)
+            _push(mp, b, m->entries[--m->count]);
+    }
+}
+
+/* Moves the entries of every thread cache back to the shared stacks. */
+static void
+_reclaim(lotto_mempool_t *mp)
+{
+    for (lotto_mempool_cache_t *c = mp->caches; c; c = c->next) {
+        caslock_acquire(&c->lock);
+        _drain(mp, c);
+        caslock_release(&c->lock);
+    }
+}
+
+static entry_t *
+_get(lotto_mempool_t *mp, unsigned bucket)
+{
+    entry_t *e = mp->stack[bucket];
+    if (e) {
+        mp->stack[bucket] = e->next;
+        e->next           = NULL;
+        return e;
+    }
+    if ((e = _bump(mp, _sizes[bucket])) != NULL)
+        return e;
+    if ((e = _split(mp, bucket)) != NULL)
+        return e;
+
+    _reclaim(mp);
+    if ((e = mp->stack[bucket]) != NULL) {
+        mp->stack[bucket] = e->next;
+        e->next           = NULL;
+        return e;
+    }
+    e = _split(mp, bucket);
+    ASSERT(e && "lotto_mempool overflow");
+    return e;
+}
+
+/*******************************************************************************
+ * thread caches
+ ******************************************************************************/
+
+static lotto_mempool_cache_t *
+_cache(lotto_mempool_t *mp)
+{
+    for (unsigned i = 0; i < TLS_CACHES; i++) {
+        if (_tls_caches[i].id == mp->id)
+            return _tls_caches[i].cache;
+    }
+
+    // take over the cache of an exited thread, or carve a new one from the
+    // top of the pool, below the previous caches
+    caslock_acquire(&mp->lock);
+    lotto_mempool_cache_t *c = mp->caches;
+    while (c != NULL && c->owned)
+        c = c->next;
+    uintptr_t top = (uintptr_t)mp->pool.memory + mp->pool.limit;
+    top           = (top - sizeof(lotto_mempool_cache_t)) & ~(uintptr_t)63;
+    if (c != NULL) {
+        c->owned = true;
+    } else if (top >= (uintptr_t)mp->pool.memory + mp->pool.next) {
+        mp->pool.limit = top - (uintptr_t)mp->pool.memory;
+        c              = (lotto_mempool_cache_t *)top;
+        sys_memset(c, 0, sizeof(*c));
+        caslock_init(&c->lock);
+        c->owned   = true;
+        c->next    = mp->caches;
+        mp->caches = c;
+    }
+    caslock_release(&mp->lock);
+    if (c == NULL)
+        return NULL;
+
+    // a thread rarely uses more pools than slots; an evicted cache stays
+    // linked to its pool and is drained when the pool runs dry
+    unsigned i           = _tls_victim++ % TLS_CACHES;
+    _tls_caches[i].id    = mp->id;
+    _tls_caches[i].cache = c;
+    return c;
+}
+
+static entry_t *
+_cache_get(lotto_mempool_t *mp, lotto_mempool_cache_t *c, unsigned bucket)
+{
+    magazine_t *m = &c->mag[bucket];
+    entry_t *e    = NULL;
+
+    caslock_acquire(&c->lock);
+    if (m->count > 0)
+        e = m->entries[--m->count];
+    c->allocated += _sizes[bucket];
+    caslock_release(&c->lock);
+    if (e)
+        return e;
+
+    // refill half a magazine with a single acquisition of the pool lock
+    entry_t *batch[MAGAZINE_SIZE];
+    uint32_t n    = 0;
+    uint32_t want = _magazine_cap(bucket) / 2;
+    caslock_acquire(&mp->lock);
+    e = _get(mp, bucket);
+    while (n < want && mp->stack[bucket]) {
+        batch[n]          = mp->stack[bucket];
+        mp->stack[bucket] = batch[n]->next;
+        n++;
+    }
+    caslock_release(&mp->lock);
+
+    // only the owner adds entries, so the magazine has room for the batch
+    caslock_acquire(&c->lock);
+    for (uint32_t i = 0; i < n; i++)
+        m->entries[m->count++] = batch[i];
+    caslock_release(&c->lock);
+    return e;
+}
+
+static void
+_cache_put(lotto_mempool_t *mp, lotto_mempool_cache_t *c, unsigned bucket,
+           entry_t *e)
+{
+    magazine_t *m = &c->mag[bucket];
+    uint32_t cap  = _magazine_cap(bucket);
+    entry_t *batch[MAGAZINE_SIZE];
+    uint32_t n = 0;
+
+    caslock_acquire(&c->lock);
+    c->allocated -= _sizes[bucket];
+    if (m->count == cap) {
+        // spill the older half of the magazine
+        n = cap / 2;
+        sys_memcpy(batch, m->entries, n * sizeof(entry_t *));
+        for (uint32_t i = n; i < m->count; i++)
+            m->entries[i - n] = m->entries[i];
+        m->count -= n;
+    }
+    m->entries[m->count++] = e;
+    caslock_release(&c->lock);
+
+    if (n == 0)
+        return;
+    caslock_acquire(&mp->lock);
+    for (uint32_t i = 0; i < n; i++)
+        _push(mp, bucket, batch[i]);
+    caslock_release(&mp->lock);
+}
+
+void
+lotto_mempool_thread_fini(lotto_mempool_t *mp)
+{
+    ASSERT(mp);
+    for (unsigned i = 0; i < TLS_CACHES; i++) {
+        if (_tls_caches[i].id != mp->id)
+            continue;
+        lotto_mempool_cache_t *c = _tls_caches[i].cache;
+        _tls_caches[i].id        = 0;
+        _tls_caches[i].cache     = NULL;
+
+        caslock_acquire(&mp->lock);
+        caslock_acquire(&c->lock);
+        _drain(mp, c);
+        mp->allocated = (size_t)((int64_t)mp->allocated + c->allocated);
+        c->allocated  = 0;
+        c->owned      = false;
+        caslock_release(&c->lock);
+        caslock_release(&mp->lock);
+    }
+}
+
 void *
 lotto_mempool_alloc(lotto_mempool_t *mp, size_t n)
 {
@@ -126,33 +411,22 @@ lotto_mempool_alloc(lotto_mempool_t *mp, size_t n)
     entry_t *e      = NULL;
     size_t size     = n + METADATA_SIZE;
     unsigned bucket = _bucketize(size);
-    size            = _sizes[bucket];
-    entry_t **stack = &mp->stack[bucket];
-    ASSERT(stack);
-
-    // Mempool is used from rogue thread, serialization is necessary
-    caslock_acquire(&mp->lock);
-
-    if (*stack) {
-        e       = *stack;
-        *stack  = e->next;
-        e->next = NULL;
-        mp->allocated += size;
+    if (bucket >= NSTACKS) {
+        return NULL;
     }
+    size = _sizes[bucket];
 
-
-    if (e == NULL) {
-        ASSERT(mp->pool.capacity >= mp->pool.next + size &&
-               "lotto_mempool overflow");
-        e       = (entry_t *)(mp->pool.memory + mp->pool.next);
-        e->next = NULL;
-        e->size = size;
-        mp->pool.next += size;
+    lotto_mempool_cache_t *c = bucket < CACHE_BUCKETS ? _cache(mp) : NULL;
+    if (c) {
+        e = _cache_get(mp, c, bucket);
+    } else {
+        // Mempool is used from rogue thread, serialization is necessary
+        caslock_acquire(&mp->lock);
+        e = _get(mp, bucket);
         mp->allocated += size;
+        caslock_release(&mp->lock);
     }
 
-    caslock_release(&mp->lock);
-
     if (e == NULL) {
         return NULL;
     }
@@ -217,16 +491,18 @@ lotto_mempool_free(lotto_mempool_t *mp, void *p)
     ASSERT(mp);
     ASSERT(IN_POOL(mp, p));
     entry_t *e      = GET_ENTRY_PTR(p);
-    size_t size     = e->size;
-    unsigned bucket = _bucketize(size);
-    size            = _sizes[bucket];
-    entry_t **stack = &mp->stack[bucket];
+    unsigned bucket = _bucketize(e->size);
+    ASSERT(bucket < NSTACKS);
+
+    lotto_mempool_cache_t *c = bucket < CACHE_BUCKETS ? _cache(mp) : NULL;
+    if (c) {
+        _cache_put(mp, c, bucket, e);
+        return;
+    }
 
     // Mempool is used from rogue thread, serialization is necessary
     caslock_acquire(&mp->lock);
-    mp->allocated -= size;
-    ASSERT(stack);
-    e->next = *stack;
-    *stack  = e;
+    mp->allocated -= _sizes[bucket];
+    _push(mp, bucket, e);
     caslock_release(&mp->lock);
 }
@@ -0,0 +1,37 @@
+// clang-format off
+// RUN: %lotto %stress -r 5 -- %b
+// clang-format on
+
+/* Hundreds of tasks return from blocking syscalls at the same time, all
+ * handing their ids to the sequencer concurrently. */
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NTHREADS 256
+#define NROUNDS  4
+
+void *
+run(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < NROUNDS; i++) {
+        struct timespec ts = {.tv_sec = 0, .tv_nsec = 1000000};
+        assert(syscall(SYS_nanosleep, &ts, NULL) == 0);
+    }
+    return NULL;
+}
+
+int
+main()
+{
+    pthread_t t[NTHREADS];
+    for (int i = 0; i < NTHREADS; i++)
+        pthread_create(&t[i], 0, run, 0);
+    for (int i = 0; i < NTHREADS; i++)
+        pthread_join(t[i], 0);
+    return 0;
+}
@@ -0,0 +1,13 @@
+// clang-format off
+// RUN: rm -f %s.replay.trace
+// RUN: %lotto stress -t %T -r 4 --jobs 2 -o %s.replay.trace -- %b | %check %s
+// RUN: test -s %s.replay.trace
+// RUN: test -d %T/job-0 && test -d %T/job-1
+// CHECK: [lotto] round: 1/2
+// clang-format on
+
+int
+main(void)
+{
+    return 0;
+}
@@ -0,0 +1,30 @@
+// clang-format off
+// RUN: %lotto %stress -r 8 --stress-portfolio "-s random;-s pct --pct-d 2" -- %b | %check %s
+// CHECK: [lotto] portfolio arm: -s random
+// CHECK: [lotto] portfolio arm: -s pct --pct-d 2
+// CHECK: [lotto] portfolio: {{[0-9]+}}/{{[1-9][0-9]*}} rounds rewarded: -s random
+// CHECK: [lotto] portfolio: {{[0-9]+}}/{{[1-9][0-9]*}} rounds rewarded: -s pct --pct-d 2
+// clang-format on
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+atomic_int x = 0;
+
+void *
+run(void *arg)
+{
+    (void)arg;
+    atomic_fetch_add(&x, 1);
+    return NULL;
+}
+
+int
+main(void)
+{
+    pthread_t t;
+    pthread_create(&t, 0, run, 0);
+    atomic_fetch_add(&x, 1);
+    pthread_join(t, 0);
+    return 0;
+}
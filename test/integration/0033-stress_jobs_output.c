@@ -0,0 +1,16 @@
+// clang-format off
+// RUN: (! %lotto %stress -r 4 --jobs 2 -- %b 2>&1) | %check %s
+// CHECK: jobs output marker
+// CHECK: [lotto] job {{[01]}} output tail:
+// CHECK: jobs output marker
+// clang-format on
+#include <stdio.h>
+#include <stdlib.h>
+
+int
+main(void)
+{
+    printf("jobs output marker\n");
+    fflush(stdout);
+    abort();
+}
@@ -0,0 +1,37 @@
+// clang-format off
+// RUN: %lotto %stress -r 8 -- %b | %check %s
+// RUN: %lotto %replay | %check %s
+// CHECK: created 32 threads
+// clang-format on
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define NTHREADS 32
+
+atomic_int started;
+
+static void *
+run(void *arg)
+{
+    atomic_fetch_add(&started, 1);
+    return arg;
+}
+
+int
+main(void)
+{
+    // the parent keeps running after each creation, before and after joins
+    pthread_t t[NTHREADS];
+    for (int i = 0; i < NTHREADS; i++) {
+        pthread_create(&t[i], 0, run, 0);
+        if (i % 2 == 1) {
+            pthread_join(t[i - 1], 0);
+        }
+    }
+    for (int i = 1; i < NTHREADS; i += 2) {
+        pthread_join(t[i], 0);
+    }
+    printf("created %d threads\n", atomic_load(&started));
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lotto/base/cpuset.h>
+
+/* 4 cores with 2 SMT threads each, siblings numbered apart (0 and 4, ...) */
+static uint64_t
+_core_apart(int cpu)
+{
+    return (uint64_t)cpu % 4;
+}
+
+/* 4 cores with 2 SMT threads each, siblings numbered together (0 and 1, ...) */
+static uint64_t
+_core_together(int cpu)
+{
+    return (uint64_t)cpu / 2;
+}
+
+static size_t
+_spread(cpu_core_f *core_of, cpu_order_t *order)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 8; cpu++) {
+        CPU_SET(cpu, &set);
+    }
+    return cpuset_spread(&set, core_of, order);
+}
+
+void
+test_spread()
+{
+    cpu_order_t order[CPU_SETSIZE];
+    int apart[]    = {0, 1, 2, 3, 4, 5, 6, 7};
+    int together[] = {0, 2, 4, 6, 1, 3, 5, 7};
+
+    assert(_spread(_core_apart, order) == 8);
+    for (size_t i = 0; i < 8; i++) {
+        assert(order[i].cpu == apart[i]);
+        assert(order[i].core == (uint32_t)(i % 4));
+    }
+
+    assert(_spread(_core_together, order) == 8);
+    for (size_t i = 0; i < 8; i++) {
+        assert(order[i].cpu == together[i]);
+        assert(order[i].core == (uint32_t)(i % 4));
+    }
+}
+
+void
+test_job()
+{
+    cpu_order_t order[CPU_SETSIZE];
+    cpu_set_t mine;
+    size_t n = _spread(_core_together, order);
+
+    /* two jobs get two full cores each */
+    cpuset_job(order, n, 1, 2, &mine);
+    assert(CPU_COUNT(&mine) == 4);
+    for (int cpu = 4; cpu < 8; cpu++) {
+        assert(CPU_ISSET(cpu, &mine));
+    }
+
+    /* the first four of six jobs get a thread of distinct cores */
+    cpuset_job(order, n, 3, 6, &mine);
+    assert(CPU_COUNT(&mine) == 1 && CPU_ISSET(6, &mine));
+    cpuset_job(order, n, 4, 6, &mine);
+    assert(CPU_COUNT(&mine) == 1 && CPU_ISSET(1, &mine));
+}
+
+int
+main()
+{
+    test_spread();
+    test_job();
+    return 0;
+}
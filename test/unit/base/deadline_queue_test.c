@@ -0,0 +1,119 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <lotto/modules/clock.h>
+#include <lotto/modules/timeout/deadline_queue.h>
+
+#define NTASKS 64
+
+static struct timespec deadlines[NTASKS];
+static bool queued[NTASKS];
+
+static struct timespec
+ts(long sec, long nsec)
+{
+    return (struct timespec){.tv_sec = sec, .tv_nsec = nsec};
+}
+
+/* reference: earliest deadline, then lowest id */
+static task_id
+earliest()
+{
+    task_id best = NO_TASK;
+    for (task_id id = 1; id < NTASKS; id++) {
+        if (!queued[id])
+            continue;
+        if (best == NO_TASK ||
+            timespec_compare(&deadlines[id], &deadlines[best]) < 0)
+            best = id;
+    }
+    return best;
+}
+
+void
+test_order()
+{
+    deadline_queue_t q;
+    deadline_queue_init(&q);
+    srand(1);
+
+    for (int round = 0; round < 1000; round++) {
+        task_id best                = earliest();
+        const deadline_entry_t *min = deadline_queue_peek(&q);
+        assert(best == NO_TASK ? min == NULL : min->id == best);
+
+        task_id id = 1 + rand() % (NTASKS - 1);
+        if (queued[id] && rand() % 4 == 0) {
+            assert(deadline_queue_cancel(&q, id));
+            queued[id] = false;
+        } else {
+            deadlines[id] = ts(rand() % 4, rand() % 4);
+            deadline_queue_set(&q, id, &deadlines[id]);
+            queued[id] = true;
+        }
+        assert(deadline_queue_find(&q, id) != NULL || !queued[id]);
+    }
+
+    size_t n = 0;
+    for (task_id id = 1; id < NTASKS; id++)
+        n += queued[id];
+    assert(deadline_queue_size(&q) == n);
+    deadline_queue_fini(&q);
+}
+
+void
+test_pop_expired()
+{
+    deadline_queue_t q;
+    deadline_queue_init(&q);
+    deadline_queue_set(&q, 3, &(struct timespec){2, 0});
+    deadline_queue_set(&q, 2, &(struct timespec){1, 0});
+    deadline_queue_set(&q, 1, &(struct timespec){1, 0});
+    assert(!deadline_queue_cancel(&q, 4));
+
+    deadline_entry_t e;
+    struct timespec now = ts(0, 999999999);
+    assert(!deadline_queue_pop_expired(&q, &now, &e));
+
+    /* ties are popped by ascending id */
+    now = ts(1, 0);
+    assert(deadline_queue_pop_expired(&q, &now, &e) && e.id == 1);
+    assert(deadline_queue_pop_expired(&q, &now, &e) && e.id == 2);
+    assert(!deadline_queue_pop_expired(&q, &now, &e));
+
+    /* rescheduling moves the entry */
+    deadline_queue_set(&q, 3, &now);
+    assert(deadline_queue_pop_expired(&q, &now, &e) && e.id == 3);
+    assert(deadline_queue_size(&q) == 0);
+    assert(deadline_queue_find(&q, 3) == NULL);
+    deadline_queue_fini(&q);
+}
+
+void
+test_marshal()
+{
+    deadline_queue_t q, r;
+    deadline_queue_init(&q);
+    deadline_queue_init(&r);
+    for (task_id id = 1; id < 8; id++)
+        deadline_queue_set(&q, id, &(struct timespec){8 - (long)id, 0});
+
+    marshable_copy(&r.m, &q.m);
+
+    struct timespec now = ts(8, 0);
+    deadline_entry_t e;
+    for (task_id id = 7; id >= 1; id--)
+        assert(deadline_queue_pop_expired(&r, &now, &e) && e.id == id);
+    deadline_queue_fini(&q);
+    deadline_queue_fini(&r);
+}
+
+int
+main()
+{
+    test_order();
+    test_pop_expired();
+    test_marshal();
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <lotto/base/prioheap.h>
+#include <lotto/base/tidset.h>
+
+#define NTASKS 64
+
+static prionode_t nodes[NTASKS];
+
+/* reference: highest priority, then lowest id */
+static prionode_t *
+best_in(const prioheap_t *h, const tidset_t *tset)
+{
+    prionode_t *best = NULL;
+    for (size_t i = 0; i < NTASKS; i++) {
+        prionode_t *n = &nodes[i];
+        if (n->pos == PRIOHEAP_NONE || (tset && !tidset_has(tset, n->id)))
+            continue;
+        if (best == NULL || prioheap_prio(h, n) > prioheap_prio(h, best) ||
+            (prioheap_prio(h, n) == prioheap_prio(h, best) && n->id < best->id))
+            best = n;
+    }
+    return best;
+}
+
+void
+test_order()
+{
+    prioheap_t h;
+    prioheap_init(&h, 1);
+    srand(1);
+    for (size_t i = 0; i < NTASKS; i++)
+        prioheap_insert(&h, &nodes[i], i + 1, rand() % 16);
+    assert(prioheap_size(&h) == NTASKS);
+
+    for (int round = 0; round < 1000; round++) {
+        assert(prioheap_top(&h) == best_in(&h, NULL));
+        prionode_t *n = &nodes[rand() % NTASKS];
+        if (n->pos == PRIOHEAP_NONE)
+            prioheap_insert(&h, n, (n - nodes) + 1, rand() % 16);
+        else if (rand() % 4 == 0)
+            prioheap_remove(&h, n);
+        else
+            prioheap_update(&h, n, rand() % 16);
+    }
+    prioheap_fini(&h);
+}
+
+void
+test_first_in()
+{
+    prioheap_t h;
+    tidset_t tset;
+    prioheap_init(&h, 1);
+    tidset_init(&tset);
+    srand(2);
+    for (size_t i = 0; i < NTASKS; i++)
+        prioheap_insert(&h, &nodes[i], i + 1, rand());
+
+    for (int round = 0; round < 100; round++) {
+        tidset_clear(&tset);
+        for (size_t i = 0; i < NTASKS; i++)
+            if (rand() % 8 == 0)
+                tidset_insert(&tset, i + 1);
+        assert(prioheap_first_in(&h, &tset) == best_in(&h, &tset));
+    }
+
+    tidset_clear(&tset);
+    assert(prioheap_first_in(&h, &tset) == NULL);
+    tidset_fini(&tset);
+    prioheap_fini(&h);
+}
+
+void
+test_decay()
+{
+    prioheap_t h;
+    prioheap_init(&h, 10);
+    prioheap_insert(&h, &nodes[0], 1, 5);
+    prioheap_insert(&h, &nodes[1], 2, 30);
+    assert(prioheap_top(&h)->id == 2);
+
+    /* old priorities become 50 and 300 */
+    prioheap_decay(&h);
+    assert(prioheap_prio(&h, &nodes[0]) == 50);
+    assert(prioheap_prio(&h, &nodes[1]) == 300);
+
+    /* a fresh priority is compared against the scaled ones */
+    prioheap_update(&h, &nodes[0], 301);
+    assert(prioheap_top(&h)->id == 1);
+    prioheap_update(&h, &nodes[0], 299);
+    assert(prioheap_top(&h)->id == 2);
+
+    /* scaled values saturate but still compare above unscaled ones */
+    prioheap_update(&h, &nodes[0], UINT64_MAX);
+    for (int i = 0; i < 30; i++)
+        prioheap_decay(&h);
+    prioheap_update(&h, &nodes[1], UINT64_MAX - 1);
+    assert(prioheap_prio(&h, &nodes[0]) == UINT64_MAX);
+    assert(prioheap_top(&h)->id == 1);
+    prioheap_fini(&h);
+}
+
+int
+main()
+{
+    test_order();
+    test_first_in();
+    test_decay();
+    return 0;
+}
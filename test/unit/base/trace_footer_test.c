@@ -0,0 +1,124 @@
+#define LOTTO_REAL_NEXT
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <lotto/base/trace_file.h>
+#include <lotto/base/trace_flat.h>
+#include <lotto/base/trace_footer.h>
+#include <lotto/sys/stream_file.h>
+
+#define NRECORDS 5000
+
+static void
+write_trace(const char *fn, size_t n)
+{
+    stream_t *st = stream_file_alloc();
+    stream_file_out(st, fn);
+    trace_t *t = trace_file_create(st);
+    for (size_t i = 0; i < n; i++) {
+        record_t *r = record_alloc(i % 7);
+        r->kind     = i + 1 == n ? RECORD_EXIT : RECORD_SCHED;
+        r->clk      = 2 * i;
+        memset(r->data, 'a', r->size);
+        assert(trace_append_safe(t, r) == TRACE_OK);
+        free(r);
+    }
+    trace_destroy(t);
+    stream_close(st);
+    free(st);
+}
+
+static void
+test_last(const char *fn)
+{
+    trace_reader_t *tr = trace_reader_open(fn);
+    assert(tr != NULL);
+
+    const trace_footer_t *f = trace_reader_footer(tr);
+    assert(f->count == NRECORDS);
+    assert(f->clk_min == 0);
+    assert(f->clk_max == 2 * (NRECORDS - 1));
+    assert(f->exit_offset == f->last_offset);
+    assert(f->index_len > 0 && f->index_len <= TRACE_INDEX_CAPACITY);
+
+    record_t *r = trace_reader_last(tr);
+    assert(r != NULL);
+    assert(r->kind == RECORD_EXIT);
+    assert(r->clk == 2 * (NRECORDS - 1));
+    free(r);
+    trace_reader_close(tr);
+}
+
+static void
+test_seek(const char *fn)
+{
+    trace_reader_t *tr = trace_reader_open(fn);
+    assert(tr != NULL);
+
+    clk_t targets[] = {0, 1, 2, 777, 4000, 2 * (NRECORDS - 1)};
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        trace_reader_seek(tr, targets[i]);
+        record_t *r = trace_reader_next(tr);
+        assert(r != NULL);
+        assert(r->clk <= targets[i]);
+        while (r != NULL && r->clk < targets[i]) {
+            free(r);
+            r = trace_reader_next(tr);
+        }
+        assert(r != NULL);
+        assert(r->clk == targets[i] + targets[i] % 2);
+        free(r);
+    }
+    trace_reader_close(tr);
+}
+
+static void
+test_scan_skips_footer(const char *fn)
+{
+    stream_t *st = stream_file_alloc();
+    stream_file_in(st, fn);
+    trace_t *t = trace_flat_create(st);
+    trace_load(t);
+    record_t *r = trace_last(t);
+    assert(r != NULL && r->kind == RECORD_EXIT);
+
+    size_t n = 0;
+    for (; trace_next(t, RECORD_ANY) != NULL; trace_advance(t))
+        n++;
+    assert(n == NRECORDS);
+    trace_destroy(t);
+    stream_close(st);
+    free(st);
+}
+
+static void
+test_unsealed(const char *fn)
+{
+    FILE *fp = fopen(fn, "w");
+    assert(fp != NULL);
+    fputs("not a trace", fp);
+    fclose(fp);
+    assert(trace_reader_open(fn) == NULL);
+}
+
+int
+main()
+{
+    char fn[] = "/tmp/trace_footer_test.XXXXXX";
+    int fd    = mkstemp(fn);
+    assert(fd != -1);
+    close(fd);
+
+    write_trace(fn, NRECORDS);
+    test_last(fn);
+    test_seek(fn);
+    test_scan_skips_footer(fn);
+    test_unsealed(fn);
+
+    unlink(fn);
+    return 0;
+}
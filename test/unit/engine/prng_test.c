@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lotto/engine/prng.h>
+#include <lotto/engine/state.h>
+
+#define NDRAWS 1024
+
+static void
+_use(prng_gen_t gen, uint64_t seed, uint64_t stream)
+{
+    prng()->gen = gen;
+    prng_stream(seed, stream);
+}
+
+static void
+test_deterministic()
+{
+    uint64_t a[NDRAWS];
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 0);
+    for (int i = 0; i < NDRAWS; i++)
+        a[i] = prng_next();
+
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 0);
+    for (int i = 0; i < NDRAWS; i++)
+        assert(a[i] == prng_next());
+}
+
+static void
+test_streams_differ()
+{
+    uint64_t a[NDRAWS];
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 0);
+    for (int i = 0; i < NDRAWS; i++)
+        a[i] = prng_next();
+
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 1);
+    int equal = 0;
+    for (int i = 0; i < NDRAWS; i++)
+        equal += a[i] == prng_next();
+    assert(equal < 2);
+
+    /* stream 1 is stream 0 after one jump */
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 0);
+    prng_jump();
+    uint64_t digest = prng_digest();
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 1);
+    assert(digest == prng_digest());
+}
+
+static void
+test_substreams_differ()
+{
+    uint64_t a[NDRAWS];
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 0);
+    for (int i = 0; i < NDRAWS; i++)
+        a[i] = prng_next();
+
+    prng_sub_t sub[3];
+    prng_sub_init(&sub[0], 42, 0, PRNG_SUB_UAFCHECK);
+    prng_sub_init(&sub[1], 42, 0, PRNG_SUB_COVERAGE);
+    prng_sub_init(&sub[2], 42, 1, PRNG_SUB_UAFCHECK);
+    int equal = 0;
+    for (int i = 0; i < NDRAWS; i++) {
+        uint64_t x = prng_sub_next(&sub[0]);
+        uint64_t y = prng_sub_next(&sub[1]);
+        uint64_t z = prng_sub_next(&sub[2]);
+        equal += (a[i] == x) + (x == y) + (x == z) + (y == z);
+    }
+    assert(equal < 2);
+
+    /* drawing from a substream leaves the engine generator alone */
+    _use(PRNG_GEN_XOSHIRO256SS, 42, 0);
+    prng_sub_init(&sub[0], 42, 0, PRNG_SUB_UAFCHECK);
+    (void)prng_sub_next(&sub[0]);
+    assert(a[0] == prng_next());
+}
+
+static void
+test_range()
+{
+    uint64_t hits[3] = {0};
+    _use(PRNG_GEN_XOSHIRO256SS, 7, 0);
+    for (int i = 0; i < 3 * NDRAWS; i++) {
+        uint64_t v = prng_range(10, 13);
+        assert(v >= 10 && v < 13);
+        hits[v - 10]++;
+    }
+    for (int i = 0; i < 3; i++)
+        assert(hits[i] > NDRAWS / 2);
+
+    _use(PRNG_GEN_XOSHIRO256SS, 7, 0);
+    for (int i = 0; i < NDRAWS; i++) {
+        double r = prng_real();
+        assert(r >= 0.0 && r < 1.0);
+    }
+}
+
+static void
+test_rand_r_compatible()
+{
+    unsigned int seed = 1234;
+    _use(PRNG_GEN_RAND_R, seed, 0);
+    for (int i = 0; i < NDRAWS; i++)
+        assert(prng_next() == (uint64_t)rand_r(&seed));
+}
+
+int
+main()
+{
+    test_deterministic();
+    test_streams_differ();
+    test_substreams_differ();
+    test_range();
+    test_rand_r_compatible();
+    printf("prng_test: ok\n");
+    return 0;
+}
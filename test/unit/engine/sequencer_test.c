@@ -186,6 +186,11 @@ statemgr_register(int slot, marshable_t *m, state_type_t type)
 {
 }
 
+void
+statemgr_register_reset(marshable_t *m, void (*init)(marshable_t *))
+{
+}
+
 void
 initializer_init()
 {
@@ -0,0 +1,48 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <lotto/runtime/capture_point.h>
+#include <lotto/runtime/switcher.h>
+#include <lotto/sys/ensure.h>
+
+#define NTASKS 4
+
+/* the first three share a switcher bucket */
+static const task_id ids[NTASKS] = {2, 130, 258, 3};
+
+int aborted = 0;
+
+void *
+run(void *arg)
+{
+    task_id tid = (task_id)(uintptr_t)arg;
+    if (switcher_yield(tid, NULL) == SWITCHER_ABORTED)
+        __atomic_fetch_add(&aborted, 1, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+int
+main()
+{
+    pthread_t t[NTASKS];
+
+    for (int i = 0; i < NTASKS; i++)
+        pthread_create(&t[i], 0, run, (void *)(uintptr_t)ids[i]);
+
+    /* nobody is woken, abort releases all waiting tasks */
+    switcher_abort();
+    for (int i = 0; i < NTASKS; i++)
+        pthread_join(t[i], 0);
+
+    printf("%d\n", aborted);
+    ENSURE(aborted == NTASKS);
+
+    /* after a reset the switcher schedules again */
+    switcher_reset();
+    pthread_create(&t[0], 0, run, (void *)(uintptr_t)2);
+    switcher_wake(2, 0);
+    pthread_join(t[0], 0);
+    ENSURE(aborted == NTASKS);
+}
@@ -0,0 +1,67 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <lotto/driver/files.h>
+
+static ino_t
+inode_of(const char *dir, const char *name)
+{
+    char path[1024];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    assert(stat(path, &st) == 0);
+    return st.st_ino;
+}
+
+static void
+check_content(const char *dir, const char *name, const char *expected)
+{
+    char path[1024];
+    char buf[64] = {0};
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *fp = fopen(path, "r");
+    assert(fp != NULL);
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    assert(n == strlen(expected) && strcmp(buf, expected) == 0);
+}
+
+int
+main()
+{
+    char dir[] = "/tmp/lotto-files-dump-XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+
+    static const unsigned char hello[] = "hello";
+    static const unsigned char jello[] = "jello";
+
+    assert(driver_try_dump_files(dir, (driver_file_t[]){
+                                          {"blob.so", hello, 5},
+                                          {NULL},
+                                      }));
+    check_content(dir, "blob.so", "hello");
+    ino_t first = inode_of(dir, "blob.so");
+
+    /* unchanged content is not rewritten */
+    assert(driver_try_dump_files(dir, (driver_file_t[]){
+                                          {"blob.so", hello, 5},
+                                          {NULL},
+                                      }));
+    assert(inode_of(dir, "blob.so") == first);
+
+    /* new content of the same length replaces the file */
+    assert(driver_try_dump_files(dir, (driver_file_t[]){
+                                          {"blob.so", jello, 5},
+                                          {NULL},
+                                      }));
+    check_content(dir, "blob.so", "jello");
+    assert(inode_of(dir, "blob.so") != first);
+
+    char cmd[1024];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    assert(system(cmd) == 0);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lotto/sys/mempool.h>
+
+#define POOL_SIZE ((size_t)1024 * 1024)
+
+unsigned int _bucketize(size_t size);
+
+static void
+test_bucketize(void)
+{
+    static const size_t sizes[] = {32, 128, 256, 512, 1024, 2048};
+    for (size_t size = 1; size <= 2048; size++) {
+        unsigned i = 0;
+        while (size > sizes[i])
+            i++;
+        assert(_bucketize(size) == i);
+    }
+    assert(_bucketize((size_t)8 * 1024 * 1024) == NSTACKS - 1);
+}
+
+static void
+test_reuse(void)
+{
+    lotto_mempool_t *mp = lotto_mempool_init(malloc, free, POOL_SIZE);
+    void *p[256];
+
+    // churn far more memory than the pool holds
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < 256; i++) {
+            p[i] = lotto_mempool_alloc(mp, 1 + (size_t)(i * 37 + round) % 900);
+            assert(p[i] != NULL);
+            assert((uintptr_t)p[i] % 8 == 0);
+            memset(p[i], i, 1 + (size_t)(i * 37 + round) % 900);
+        }
+        for (int i = 0; i < 256; i++) {
+            assert(*(unsigned char *)p[i] == (unsigned char)i);
+            lotto_mempool_free(mp, p[i]);
+        }
+    }
+    lotto_mempool_fini(mp);
+}
+
+static void
+test_split(void)
+{
+    lotto_mempool_t *mp = lotto_mempool_init(malloc, free, POOL_SIZE);
+
+    // fill the pool with large entries, then ask for small ones
+    void *big[64];
+    size_t n = 0;
+    while (n < 64 && mp->pool.next + 64 * 1024 <= mp->pool.limit)
+        big[n++] = lotto_mempool_alloc(mp, 60 * 1024);
+    assert(n > 0);
+    for (size_t i = 0; i < n; i++)
+        lotto_mempool_free(mp, big[i]);
+
+    for (size_t i = 0; i < n * 64 * 1024 / 128; i++) {
+        void *q = lotto_mempool_alloc(mp, 64);
+        assert(q != NULL);
+    }
+    lotto_mempool_fini(mp);
+}
+
+static void *
+_churn(void *arg)
+{
+    lotto_mempool_t *mp = arg;
+    void *p             = lotto_mempool_alloc(mp, 100);
+    assert(p != NULL);
+    lotto_mempool_free(mp, p);
+    lotto_mempool_thread_fini(mp);
+    return NULL;
+}
+
+static void
+test_thread_fini(void)
+{
+    lotto_mempool_t *mp = lotto_mempool_init(malloc, free, POOL_SIZE);
+
+    // the freed entry stays cached until the thread releases its cache
+    void *p = lotto_mempool_alloc(mp, 100);
+    lotto_mempool_free(mp, p);
+    assert(mp->stack[2] == NULL);
+    lotto_mempool_thread_fini(mp);
+    assert(mp->stack[2] != NULL);
+    assert(lotto_mempool_alloc(mp, 100) == p);
+    lotto_mempool_free(mp, p);
+    lotto_mempool_thread_fini(mp);
+    size_t limit = mp->pool.limit;
+
+    // exited threads hand their cache over instead of carving new ones
+    for (int i = 0; i < 16; i++) {
+        pthread_t t;
+        assert(pthread_create(&t, NULL, _churn, mp) == 0);
+        assert(pthread_join(t, NULL) == 0);
+    }
+    assert(mp->pool.limit == limit);
+    lotto_mempool_fini(mp);
+}
+
+int
+main()
+{
+    test_bucketize();
+    test_reuse();
+    test_split();
+    test_thread_fini();
+    return 0;
+}